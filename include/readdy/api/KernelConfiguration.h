@@ -61,6 +61,17 @@ struct NeighborList {
      * drastically increase memory requirements.
      */
     std::uint8_t cll_radius{1};
+    /**
+     * Verlet skin. If larger than zero, explicit per-particle neighbor lists are built with a cutoff of the
+     * interaction distance plus skin and only rebuilt once a particle was displaced by more than half the skin.
+     * Particles added or removed by reactions are patched into the lists locally.
+     */
+    scalar skin{0};
+    /**
+     * Whether pair potentials are evaluated once per pair over a half stencil of the neighbor list, applying equal
+     * and opposite forces, instead of once from each of the two particles.
+     */
+    bool halfShell{false};
 };
 
 /**
@@ -77,6 +88,52 @@ void to_json(json &j, const NeighborList &nl);
  */
 void from_json(const json &j, NeighborList &nl);
 
+/**
+ * Space-filling curves along which the particle data can be ordered
+ */
+enum class SpaceFillingCurve {
+    hilbert, morton
+};
+
+NLOHMANN_JSON_SERIALIZE_ENUM(SpaceFillingCurve, {
+    {SpaceFillingCurve::hilbert, "hilbert"},
+    {SpaceFillingCurve::morton, "morton"},
+})
+
+/**
+ * Struct with configuration attributes for the memory layout of the CPU kernel's particle data
+ */
+struct DataLayout {
+    /**
+     * Every reorderInterval-th neighbor list update the particle data is sorted along a space-filling curve through
+     * the neighbor list cells, so that particles which are close in space are close in memory. Zero disables it.
+     */
+    std::size_t reorderInterval{0};
+    /**
+     * The curve along which the particle data is sorted
+     */
+    SpaceFillingCurve spaceFillingCurve{SpaceFillingCurve::hilbert};
+    /**
+     * Whether the bonds, angles and dihedrals of all topologies are packed into flat arrays which are split evenly
+     * among the threads, instead of distributing whole topologies. The arrays are rebuilt when topologies change.
+     */
+    bool flatBondedInteractions{false};
+};
+
+/**
+ * Json serialization of DataLayout config struct
+ * @param j the json object
+ * @param layout the configurational object
+ */
+void to_json(json &j, const DataLayout &layout);
+
+/**
+ * Json deserialization to DataLayout config struct
+ * @param j the json object
+ * @param layout the configurational object
+ */
+void from_json(const json &j, DataLayout &layout);
+
 /**
  * Struct with configuration members that are used to parameterize the threading behavoir of the CPU kernel.
  */
@@ -111,6 +168,60 @@ void to_json(json &j, const ThreadConfig &nl);
  */
 void from_json(const json &j, ThreadConfig &nl);
 
+/**
+ * Struct with configuration attributes for the random numbers drawn by the CPU kernel
+ */
+struct Random {
+    /**
+     * If non-negative, the integrator and the reactions draw counter-based random numbers which are keyed by this
+     * seed, the particle ids and the time step, so that trajectories are reproducible regardless of the number of
+     * threads. If negative, randomly seeded thread-local generators are used.
+     */
+    std::int64_t seed{-1};
+};
+
+/**
+ * Json serialization of Random config struct
+ * @param j the json object
+ * @param random the configurational object
+ */
+void to_json(json &j, const Random &random);
+
+/**
+ * Json deserialization to Random config struct
+ * @param j the json object
+ * @param random the configurational object
+ */
+void from_json(const json &j, Random &random);
+
+/**
+ * Struct with configuration attributes for the reaction handling of the CPU kernel
+ */
+struct Reactions {
+    /**
+     * Whether the Gillespie scheduler divides the box into one slab per thread, each wider than the largest reaction
+     * radius, and handles the events within the slabs concurrently. Events whose educts lie in different slabs are
+     * handled afterwards and are dropped if one of their educts already reacted. They therefore always lose conflicts
+     * with events inside the slabs, which biases against reactions of pairs across the slab faces. The option is
+     * ignored for seeded runs.
+     */
+    bool parallelGillespie{false};
+};
+
+/**
+ * Json serialization of Reactions config struct
+ * @param j the json object
+ * @param reactions the configurational object
+ */
+void to_json(json &j, const Reactions &reactions);
+
+/**
+ * Json deserialization to Reactions config struct
+ * @param j the json object
+ * @param reactions the configurational object
+ */
+void from_json(const json &j, Reactions &reactions);
+
 /**
  * Struct that contains configuration information for the CPU kernel.
  */
@@ -123,6 +234,18 @@ struct Configuration {
      * Configuration of the threading behavior
      */
     ThreadConfig threadConfig{};
+    /**
+     * Configuration of the particle data layout
+     */
+    DataLayout dataLayout{};
+    /**
+     * Configuration of the random numbers
+     */
+    Random random{};
+    /**
+     * Configuration of the reaction handling
+     */
+    Reactions reactions{};
 };
 
 /**
@@ -153,6 +276,11 @@ namespace mpi {
 struct Configuration {
     scalar dx {-1.}, dy {-1.}, dz {-1.}; // widths of MPI boxes, for domain decomposition
     scalar haloThickness {-1.}; // thickness of the region which belongs to another domain
+    std::size_t loadBalanceStride {0}; // move domain boundaries every n neighbor list updates, 0 disables balancing
+    cpu::ThreadConfig threadConfig {1}; // threads per rank, e.g. one rank per socket with one thread per core
+    // each worker writes the particles of positions, particles and forces observables into its own shard file
+    // next to the output file, instead of gathering them on the master rank
+    bool distributedOutput {false};
 };
 /**
  * Json serialization of Configuration
@@ -0,0 +1,153 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+
+/**
+ * Fenwick tree (binary indexed tree) over non-negative weights. Supports changing single weights and sampling an
+ * index with probability proportional to its weight in O(log n), which makes it the backbone of Gillespie-type event
+ * selection where the weights are rates that change after each executed event.
+ *
+ * @file FenwickTree.h
+ * @brief Fenwick tree for weighted sampling
+ * @date 17.10.26
+ * @copyright BSD-3
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace readdy::util {
+
+template<typename Weight>
+class FenwickTree {
+public:
+    using weight_type = Weight;
+    using size_type = std::size_t;
+
+    /**
+     * Builds the tree from a range of weights in O(n)
+     * @param begin begin of the weights
+     * @param end end of the weights
+     */
+    template<typename Iter>
+    FenwickTree(Iter begin, Iter end) : _weights(begin, end), _tree(_weights.size() + 1, 0) {
+        for (size_type i = 1; i < _tree.size(); ++i) {
+            _tree[i] += _weights[i - 1];
+            _total += _weights[i - 1];
+            const auto parent = i + (i & (~i + 1));
+            if (parent < _tree.size()) {
+                _tree[parent] += _tree[i];
+            }
+        }
+    }
+
+    /**
+     * @return the number of weights
+     */
+    [[nodiscard]] size_type size() const {
+        return _weights.size();
+    }
+
+    /**
+     * @return the sum of all weights
+     */
+    [[nodiscard]] weight_type total() const {
+        return _total;
+    }
+
+    /**
+     * @param i index
+     * @return the weight at index i
+     */
+    [[nodiscard]] weight_type weight(size_type i) const {
+        return _weights[i];
+    }
+
+    /**
+     * Sets the weight at index i
+     * @param i index
+     * @param weight the new weight
+     */
+    void set(size_type i, weight_type weight) {
+        const auto delta = weight - _weights[i];
+        _weights[i] = weight;
+        _total += delta;
+        for (++i; i < _tree.size(); i += i & (~i + 1)) {
+            _tree[i] += delta;
+        }
+    }
+
+    /**
+     * @param i index
+     * @return the sum of the weights at indices smaller than i
+     */
+    [[nodiscard]] weight_type prefixSum(size_type i) const {
+        weight_type sum = 0;
+        for (; i > 0; i -= i & (~i + 1)) {
+            sum += _tree[i];
+        }
+        return sum;
+    }
+
+    /**
+     * Yields the smallest index whose prefix sum including its own weight exceeds x, so that for x drawn uniformly
+     * from [0, total()) index i is found with probability weight(i) / total(). Indices with zero weight are never
+     * found. If x is not smaller than the total, size() is returned.
+     * @param x the value
+     * @return the index
+     */
+    [[nodiscard]] size_type find(weight_type x) const {
+        size_type pos = 0;
+        size_type step = 1;
+        while (2 * step < _tree.size()) {
+            step *= 2;
+        }
+        for (; step > 0; step /= 2) {
+            if (pos + step < _tree.size() && _tree[pos + step] <= x) {
+                pos += step;
+                x -= _tree[pos];
+            }
+        }
+        return pos;
+    }
+
+private:
+    std::vector<weight_type> _weights;
+    std::vector<weight_type> _tree;
+    weight_type _total {0};
+};
+
+}
@@ -0,0 +1,129 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+/**
+ * Buffer of values for a window of indices of a larger index space, e.g., per-thread force buffers for a subset of
+ * the particles. Only the window is cleared and reduced, accessing an index outside of it grows the window. Growth
+ * is at least by the current window size, so that a buffer which ends up covering w indices is cleared and copied in
+ * O(w) in total.
+ *
+ * @file IndexWindowBuffer.h
+ * @brief Buffer of values for a window of indices
+ * @date 17.10.26
+ * @copyright BSD-3
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+namespace readdy::util {
+
+template<typename T>
+class IndexWindowBuffer {
+public:
+    /**
+     * Clears the buffer and sets its window to [begin, end). The window never grows beyond limit.
+     * @param begin first index of the window
+     * @param end one past the last index of the window, an empty window is permitted
+     * @param limit size of the whole index space
+     */
+    void reset(std::size_t begin, std::size_t end, std::size_t limit) {
+        _limit = limit;
+        _offset = std::min(begin, end);
+        _values.assign(end - _offset, T{});
+    }
+
+    T &operator[](std::size_t index) {
+        if (index < _offset || index >= end()) {
+            grow(index);
+        }
+        return _values[index - _offset];
+    }
+
+    /**
+     * @return first index of the window
+     */
+    [[nodiscard]] std::size_t begin() const {
+        return _offset;
+    }
+
+    /**
+     * @return one past the last index of the window
+     */
+    [[nodiscard]] std::size_t end() const {
+        return _offset + _values.size();
+    }
+
+    /**
+     * Calls f(index, value) for all indices in the intersection of [begin, end) and the window.
+     */
+    template<typename F>
+    void forEachIn(std::size_t begin, std::size_t end, F &&f) const {
+        const auto from = std::max(begin, _offset);
+        const auto to = std::min(end, this->end());
+        for (auto index = from; index < to; ++index) {
+            f(index, _values[index - _offset]);
+        }
+    }
+
+private:
+    void grow(std::size_t index) {
+        const auto slack = std::max<std::size_t>(_values.size(), minGrowth);
+        auto newBegin = _offset;
+        auto newEnd = end();
+        if (_values.empty()) {
+            newBegin = index;
+            newEnd = index + 1;
+        } else if (index < _offset) {
+            newBegin = std::min(index, _offset > slack ? _offset - slack : 0);
+        } else {
+            newEnd = std::max(index + 1, std::min(_limit, newEnd + slack));
+        }
+        _scratch.assign(newEnd - newBegin, T{});
+        std::copy(_values.begin(), _values.end(), _scratch.begin() + (_offset - newBegin));
+        std::swap(_values, _scratch);
+        _offset = newBegin;
+    }
+
+    static constexpr std::size_t minGrowth = 64;
+
+    std::vector<T> _values;
+    std::vector<T> _scratch;
+    std::size_t _offset{0};
+    std::size_t _limit{0};
+};
+
+}
@@ -0,0 +1,170 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+/**
+ * Lazily built hash index from particle ids to the indices of the entries in a particle data container. Containers
+ * keep it up to date for single insertions and removals. Bulk modifications, which may also rewrite ids of entries in
+ * place, simply invalidate it, so that it is rebuilt with the next lookup. Lookups are validated against the entries,
+ * an index that went stale nevertheless is rebuilt once before a particle is reported missing.
+ *
+ * Lookups may run concurrently, e.g., from the threads of a pool, a rebuild excludes all other lookups for its
+ * duration. Modifications of the index must not run concurrently with lookups, like modifications of the container.
+ *
+ * @file ParticleIdIndex.h
+ * @brief Hash index from particle ids to entry indices
+ * @date 17.10.26
+ * @copyright BSD-3
+ */
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "common.h"
+
+namespace readdy::util {
+
+template<typename Index>
+class ParticleIdIndex {
+public:
+    ParticleIdIndex() = default;
+
+    ParticleIdIndex(const ParticleIdIndex &other) : _map(other._map), _valid(other._valid) {}
+
+    ParticleIdIndex &operator=(const ParticleIdIndex &other) {
+        _map = other._map;
+        _valid = other._valid;
+        return *this;
+    }
+
+    ~ParticleIdIndex() = default;
+
+    /**
+     * Looks up the index of the active entry with the given id, building the index if required.
+     * @param id the particle id
+     * @param entries the entries of the container, need to provide `id` and `deactivated` members
+     * @return the index of the entry or nullopt if there is no active entry with that id
+     */
+    template<typename Entries>
+    std::optional<Index> find(ParticleId id, const Entries &entries) {
+        std::size_t generation;
+        {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
+            if (_valid) {
+                if (auto result = lookup(id, entries)) {
+                    return result;
+                }
+            }
+            generation = _generation;
+        }
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        // only rebuild if no other lookup did so in the meantime
+        if (generation == _generation) {
+            rebuild(entries);
+        }
+        return lookup(id, entries);
+    }
+
+    /**
+     * Records that the entry at index now carries the id, no-op if the index is not built.
+     */
+    void insert(ParticleId id, Index index) {
+        if (_valid) {
+            _map[id] = index;
+        }
+    }
+
+    /**
+     * Records that the entry at index no longer carries the id, no-op if the index is not built.
+     */
+    void erase(ParticleId id, Index index) {
+        if (_valid) {
+            auto it = _map.find(id);
+            if (it != _map.end() && it->second == index) {
+                _map.erase(it);
+            }
+        }
+    }
+
+    /**
+     * Drops the index, it is rebuilt with the next lookup.
+     */
+    void invalidate() {
+        _map.clear();
+        _valid = false;
+    }
+
+    [[nodiscard]] bool valid() const {
+        return _valid;
+    }
+
+private:
+    template<typename Entries>
+    void rebuild(const Entries &entries) {
+        _map.clear();
+        _map.reserve(entries.size());
+        Index index = 0;
+        for (const auto &entry : entries) {
+            if (!entry.deactivated) {
+                _map[entry.id] = index;
+            }
+            ++index;
+        }
+        _valid = true;
+        ++_generation;
+    }
+
+    template<typename Entries>
+    std::optional<Index> lookup(ParticleId id, const Entries &entries) const {
+        auto it = _map.find(id);
+        if (it != _map.end() && it->second < entries.size()) {
+            const auto &entry = entries[it->second];
+            if (!entry.deactivated && entry.id == id) {
+                return it->second;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::unordered_map<ParticleId, Index> _map;
+    bool _valid{false};
+    // number of rebuilds, tells concurrent lookups whether the index was rebuilt while they waited
+    std::size_t _generation{0};
+    std::shared_mutex _mutex;
+};
+
+}
@@ -45,8 +45,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <utility>
 #include <tuple>
+#include <vector>
 
 #include <spdlog/fmt/ostr.h>
 
@@ -122,6 +124,94 @@ using particle_type_quadruple_hasher = ForwardBackwardTupleHasher<particle_type_
 using particle_type_quadruple_equal_to = ForwardBackwardTupleEquality<particle_type_quadruple>;
 template<typename T> using particle_type_quadruple_unordered_map = std::unordered_map<particle_type_quadruple, T, particle_type_quadruple_hasher, particle_type_quadruple_equal_to>;
 
+/**
+ * Dense, symmetric lookup table from particle type pairs to contiguous ranges of values. It is built from a
+ * particle_type_pair_unordered_map and replaces hashing by two array accesses, which pays off in pair loops.
+ * @tparam T the value type, e.g., a pointer to a potential or reaction
+ */
+template<typename T>
+class ParticleTypePairTable {
+public:
+    /**
+     * A contiguous, non-owning range of values belonging to one type pair.
+     */
+    class Range {
+    public:
+        Range(const T *begin, const T *end) : _begin(begin), _end(end) {}
+
+        const T *begin() const { return _begin; }
+
+        const T *end() const { return _end; }
+
+        [[nodiscard]] bool empty() const { return _begin == _end; }
+
+        [[nodiscard]] std::size_t size() const { return static_cast<std::size_t>(_end - _begin); }
+
+        const T &operator[](std::size_t i) const { return _begin[i]; }
+
+    private:
+        const T *_begin;
+        const T *_end;
+    };
+
+    /**
+     * Rebuilds the table. Values of a key (t1, t2) are stored for (t1, t2) and (t2, t1) in the order of the map.
+     * @param map the map to build from
+     * @param nTypes lower bound for the number of particle types, the table grows to fit all keys of the map
+     */
+    template<typename Map>
+    void rebuild(const Map &map, std::size_t nTypes) {
+        for (const auto &entry : map) {
+            nTypes = std::max(nTypes, 1 + static_cast<std::size_t>(std::get<0>(entry.first)));
+            nTypes = std::max(nTypes, 1 + static_cast<std::size_t>(std::get<1>(entry.first)));
+        }
+        _nTypes = nTypes;
+        _offsets.assign(_nTypes * _nTypes + 1, 0);
+        for (const auto &entry : map) {
+            auto [t1, t2] = entry.first;
+            _offsets[1 + t1 * _nTypes + t2] += entry.second.size();
+            if (t1 != t2) {
+                _offsets[1 + t2 * _nTypes + t1] += entry.second.size();
+            }
+        }
+        for (std::size_t i = 1; i < _offsets.size(); ++i) {
+            _offsets[i] += _offsets[i - 1];
+        }
+        _values.resize(_offsets.back());
+        for (const auto &entry : map) {
+            auto [t1, t2] = entry.first;
+            std::copy(entry.second.begin(), entry.second.end(), _values.begin() + _offsets[t1 * _nTypes + t2]);
+            if (t1 != t2) {
+                std::copy(entry.second.begin(), entry.second.end(), _values.begin() + _offsets[t2 * _nTypes + t1]);
+            }
+        }
+    }
+
+    /**
+     * Yields the values for a type pair, an empty range if there are none.
+     * @param t1 the first type
+     * @param t2 the second type
+     * @return the range of values
+     */
+    Range operator()(ParticleTypeId t1, ParticleTypeId t2) const {
+        if (t1 < _nTypes && t2 < _nTypes) {
+            const auto ix = t1 * _nTypes + t2;
+            return {_values.data() + _offsets[ix], _values.data() + _offsets[ix + 1]};
+        }
+        return {nullptr, nullptr};
+    }
+
+    [[nodiscard]] std::size_t nTypes() const {
+        return _nTypes;
+    }
+
+private:
+    std::size_t _nTypes{0};
+    // (nTypes * nTypes + 1) offsets into the values
+    std::vector<std::size_t> _offsets{0};
+    std::vector<T> _values{};
+};
+
 inline particle_type_triple sortTypeTriple(ParticleTypeId t1, ParticleTypeId t2, ParticleTypeId t3) {
     if (t1 > t2) {
         std::swap(t1, t2);
@@ -46,9 +46,12 @@
 #pragma once
 
 #include <vector>
+#include <numeric>
 #include <algorithm>
+#include <type_traits>
 
 #include "common.h"
+#include "FenwickTree.h"
 #include "../model/RandomProvider.h"
 
 namespace readdy {
@@ -57,80 +60,125 @@ namespace algo {
 namespace detail {
 template<typename Events>
 void noPostPerform(const typename Events::value_type &, std::size_t) {}
+
+struct DrawUniform {
+    scalar operator()(scalar cumulativeRate) const {
+        return readdy::model::rnd::uniform_real(0., cumulativeRate);
+    }
+};
+
+struct NoDependencyKeys {};
 }
 
+/**
+ * Performs events in the order of a Gillespie scheme until all events were either evaluated or were depending on an
+ * evaluated event. The next event is sampled from a Fenwick tree over the rates, so selecting it and deactivating
+ * an event are logarithmic in the number of events. Deactivated events are moved to the end of the events container,
+ * the number of deactivated events is handed to postPerform.
+ * @param events the events, each having a member `rate`
+ * @param shouldEvaluate decides whether a selected event is evaluated or discarded
+ * @param depending depending(e, evaluated) yields whether e is no longer valid after evaluated was evaluated
+ * @param evaluate evaluates an event
+ * @param postPerform invoked with the evaluated event and the number of deactivated events
+ * @param draw draws the uniform number in [0, cumulative rate) selecting the next event, defaults to the thread-local
+ *        generator
+ * @param dependencyKeys if given, dependencyKeys(e, f) invokes f with each key (e.g., particle index) the event e
+ *        involves. Events can then only depend on one another if they share a key, so that the dependent events of an
+ *        evaluated event are looked up in an index instead of testing all remaining events.
+ */
 template<typename Events, typename ShouldEvaluate, typename Depending, typename Evaluate,
-        typename PostPerform = std::function<void(typename Events::value_type, std::size_t)>>
+        typename PostPerform = std::function<void(typename Events::value_type, std::size_t)>,
+        typename Draw = detail::DrawUniform, typename DependencyKeys = detail::NoDependencyKeys>
 inline void performEvents(Events &events, const ShouldEvaluate &shouldEvaluate, const Depending &depending,
-                   const Evaluate &evaluate, const PostPerform &postPerform = detail::noPostPerform<Events>) {
-    if(!events.empty()) {
-        std::size_t nDeactivated = 0;
-        const std::size_t nEvents = events.size();
-
-        {
-            // update cumulative rates
-            scalar cumulativeRate = 0.;
-            for(auto &event : events) {
-                event.cumulativeRate = event.rate + cumulativeRate;
-                cumulativeRate = event.cumulativeRate;
-            }
-        }
-
-        while(nDeactivated < nEvents) {
-            const auto cumulativeRate = (std::end(events) - nDeactivated - 1)->cumulativeRate;
-            const auto x = readdy::model::rnd::uniform_real(0., cumulativeRate);
-            const auto eventIt = std::lower_bound(
-                    std::begin(events), std::end(events) - nDeactivated, x, [](const auto &elem1, const auto elem2) {
-                        return elem1.cumulativeRate < elem2;
-                    }
-            );
-
-            if (eventIt != events.end()) {
-
-                if(shouldEvaluate(*eventIt)) {
-                    evaluate(*eventIt);
-
-                    auto evaluatedEvent = *eventIt;
-
-                    // shift all events to the end that depend on this particular one
-                    auto _it = std::begin(events);
-                    scalar cumsum = 0.0;
-                    while (_it < std::end(events) - nDeactivated) {
-                        if (depending(*_it, evaluatedEvent)) {
-                            ++nDeactivated;
-                            std::iter_swap(_it, events.end() - nDeactivated);
-                        } else {
-                            cumsum += _it->rate;
-                            _it->cumulativeRate = cumsum;
-                            ++_it;
-                        }
-                    }
+                   const Evaluate &evaluate, const PostPerform &postPerform = detail::noPostPerform<Events>,
+                   Draw &&draw = Draw{}, const DependencyKeys &dependencyKeys = DependencyKeys{}) {
+    constexpr bool indexed = !std::is_same_v<DependencyKeys, detail::NoDependencyKeys>;
+    if(events.empty()) {
+        return;
+    }
+    const std::size_t nEvents = events.size();
+    std::size_t nActive = nEvents;
 
-                    postPerform(evaluatedEvent, nDeactivated);
-                } else {
-                    // remove event from the list (ie shift it to the end)
-                    ++nDeactivated;
+    std::vector<scalar> initialRates;
+    initialRates.reserve(nEvents);
+    for (const auto &event : events) {
+        initialRates.push_back(event.rate);
+    }
+    util::FenwickTree<scalar> rates(initialRates.begin(), initialRates.end());
+
+    // the events are identified by their initial position, these are tracked while deactivated events are moved
+    std::vector<std::size_t> eventAt(nEvents);
+    std::iota(eventAt.begin(), eventAt.end(), 0);
+    std::vector<std::size_t> slotOf(eventAt);
+
+    // (key, event) pairs sorted by key
+    std::vector<std::pair<std::size_t, std::size_t>> keyIndex;
+    if constexpr (indexed) {
+        for (std::size_t i = 0; i < nEvents; ++i) {
+            dependencyKeys(events[i], [&keyIndex, i](std::size_t key) { keyIndex.emplace_back(key, i); });
+        }
+        std::sort(keyIndex.begin(), keyIndex.end());
+    }
 
-                    // swap with last element that is not yet deactivated
-                    std::iter_swap(eventIt, events.end() - nDeactivated);
+    auto deactivate = [&](std::size_t slot) {
+        --nActive;
+        if (slot != nActive) {
+            std::iter_swap(std::begin(events) + slot, std::begin(events) + nActive);
+            std::swap(eventAt[slot], eventAt[nActive]);
+            slotOf[eventAt[slot]] = slot;
+            slotOf[eventAt[nActive]] = nActive;
+            rates.set(slot, rates.weight(nActive));
+        }
+        rates.set(nActive, 0);
+    };
+
+    std::vector<std::size_t> dependent;
+    while (nActive > 0) {
+        std::size_t slot = 0;
+        const auto cumulativeRate = rates.total();
+        if (cumulativeRate > 0) {
+            // guard against round-off in the tree, which could point past the active events
+            slot = std::min(rates.find(draw(cumulativeRate)), nActive - 1);
+        }
 
-                    // this element's cumulative rate gets initialized with its own rate
-                    eventIt->cumulativeRate = eventIt->rate;
-                    if (eventIt > std::begin(events)) {
-                        // and then increased by the cumulative rate of its predecessor
-                        eventIt->cumulativeRate += (eventIt - 1)->cumulativeRate;
+        if (shouldEvaluate(events[slot])) {
+            evaluate(events[slot]);
+
+            auto evaluatedEvent = events[slot];
+            const auto evaluatedId = eventAt[slot];
+
+            // shift all events to the end that depend on this particular one
+            dependent.clear();
+            dependent.push_back(evaluatedId);
+            if constexpr (indexed) {
+                dependencyKeys(evaluatedEvent, [&](std::size_t key) {
+                    auto range = std::equal_range(keyIndex.begin(), keyIndex.end(), std::make_pair(key, 0_z),
+                                                  [](const auto &p1, const auto &p2) { return p1.first < p2.first; });
+                    for (auto it = range.first; it != range.second; ++it) {
+                        const auto candidateSlot = slotOf[it->second];
+                        if (candidateSlot < nActive && depending(events[candidateSlot], evaluatedEvent)) {
+                            dependent.push_back(it->second);
+                        }
                     }
-                    // now update the cumulative rates of all following elements...
-                    auto cumsum = (*eventIt).cumulativeRate;
-                    for (auto _it = eventIt + 1; _it < std::end(events) - nDeactivated; ++_it) {
-                        cumsum += (*_it).rate;
-                        (*_it).cumulativeRate = cumsum;
+                });
+            } else {
+                for (std::size_t candidateSlot = 0; candidateSlot < nActive; ++candidateSlot) {
+                    if (depending(events[candidateSlot], evaluatedEvent)) {
+                        dependent.push_back(eventAt[candidateSlot]);
                     }
                 }
-
-            } else {
-                throw std::logic_error("internal error: performEvents - no event could be selected");
             }
+            for (const auto id : dependent) {
+                // events can be found more than once
+                if (slotOf[id] < nActive) {
+                    deactivate(slotOf[id]);
+                }
+            }
+
+            postPerform(evaluatedEvent, nEvents - nActive);
+        } else {
+            // remove event from the list (ie shift it to the end)
+            deactivate(slot);
         }
     }
 }
@@ -0,0 +1,124 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+/**
+ * Indices along space-filling curves through a cubic grid. Sorting objects by these indices places objects which are
+ * close in space close to each other in the resulting order.
+ *
+ * @file space_filling_curves.h
+ * @brief Morton and Hilbert indices of three-dimensional grid coordinates
+ * @date 17.10.26
+ * @copyright BSD-3
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace readdy::util::sfc {
+
+using coordinate_type = std::uint32_t;
+using index_type = std::uint64_t;
+using coordinates_type = std::array<coordinate_type, 3>;
+
+/**
+ * Number of bits per dimension, coordinates are expected to be smaller than 2^bitsPerDimension.
+ */
+constexpr unsigned int bitsPerDimension = 21;
+
+namespace detail {
+/**
+ * Interleaves the bits of the three coordinates, most significant bits first and x before y before z.
+ */
+inline index_type interleave(const coordinates_type &coordinates) {
+    index_type result{0};
+    for (auto bit = bitsPerDimension; bit-- > 0;) {
+        for (auto coordinate : coordinates) {
+            result = (result << 1u) | ((coordinate >> bit) & 1u);
+        }
+    }
+    return result;
+}
+}
+
+/**
+ * Position along the Morton (Z-order) curve.
+ * @param coordinates grid coordinates
+ * @return the index
+ */
+inline index_type mortonIndex(const coordinates_type &coordinates) {
+    return detail::interleave(coordinates);
+}
+
+/**
+ * Position along the Hilbert curve, computed with Skilling's transposition algorithm ("Programming the Hilbert
+ * curve", AIP Conf. Proc. 707, 2004). Unlike the Morton curve, consecutive cells along the Hilbert curve are always
+ * adjacent.
+ * @param coordinates grid coordinates
+ * @return the index
+ */
+inline index_type hilbertIndex(coordinates_type coordinates) {
+    constexpr auto n = std::tuple_size<coordinates_type>::value;
+    constexpr coordinate_type highestBit = coordinate_type{1} << (bitsPerDimension - 1);
+    // inverse undo excess work
+    for (auto q = highestBit; q > 1; q >>= 1u) {
+        const auto p = q - 1;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (coordinates[i] & q) {
+                coordinates[0] ^= p;
+            } else {
+                const auto t = (coordinates[0] ^ coordinates[i]) & p;
+                coordinates[0] ^= t;
+                coordinates[i] ^= t;
+            }
+        }
+    }
+    // gray encode
+    for (std::size_t i = 1; i < n; ++i) {
+        coordinates[i] ^= coordinates[i - 1];
+    }
+    coordinate_type t{0};
+    for (auto q = highestBit; q > 1; q >>= 1u) {
+        if (coordinates[n - 1] & q) {
+            t ^= q - 1;
+        }
+    }
+    for (auto &coordinate : coordinates) {
+        coordinate ^= t;
+    }
+    return detail::interleave(coordinates);
+}
+
+}
@@ -0,0 +1,90 @@
+/********************************************************************
+ * Copyright © 2019 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+/**
+ * Splitting of index ranges among the threads of a thread pool, shared by the CPU and MPI kernels.
+ *
+ * @file parallel_for.h
+ * @brief Definition of readdy::util::thread::parallelFor
+ * @date 17.10.26
+ * @copyright BSD-3
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "ctpl.h"
+#include "joining_future.h"
+
+namespace readdy::util::thread {
+
+/**
+ * The number of contiguous ranges in which parallelFor splits n indices
+ * @param pool the thread pool
+ * @param n the number of indices
+ * @return the number of ranges, at least one
+ */
+inline std::size_t nRanges(const ctpl::thread_pool &pool, std::size_t n) {
+    return std::max<std::size_t>(1, std::min<std::size_t>(pool.size(), n));
+}
+
+/**
+ * Splits [0, n) into nRanges(pool, n) contiguous ranges and evaluates f(rangeIndex, begin, end) for each of them.
+ * Returns after all ranges have been processed. If there is only one range it is evaluated on the calling thread.
+ * @param pool the thread pool
+ * @param n the number of indices
+ * @param f the function, called once per range
+ */
+template<typename Function>
+void parallelFor(ctpl::thread_pool &pool, std::size_t n, const Function &f) {
+    const auto nTasks = nRanges(pool, n);
+    if (nTasks == 1) {
+        f(0, 0, n);
+        return;
+    }
+    const auto grainSize = n / nTasks;
+    std::vector<joining_future<void>> futures;
+    futures.reserve(nTasks);
+    for (std::size_t task = 0; task < nTasks; ++task) {
+        const auto begin = task * grainSize;
+        const auto end = task == nTasks - 1 ? n : begin + grainSize;
+        futures.emplace_back(pool.push([&f, task, begin, end](std::size_t) {
+            f(task, begin, end);
+        }));
+    }
+}
+
+}
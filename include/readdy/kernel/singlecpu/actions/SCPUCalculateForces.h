@@ -128,15 +128,15 @@ private:
         auto taf = kernel->getTopologyActionFactory();
         auto topologyEval = [&](auto &topology){
             for (const auto &bondedPot : topology->getBondedPotentials()) {
-                auto energy = bondedPot->createForceAndEnergyAction(taf)->perform(topology.get());
+                auto energy = bondedPot->forceAndEnergyAction(taf)->perform(topology.get());
                 stateModel.energy() += energy;
             }
             for (const auto &anglePot : topology->getAnglePotentials()) {
-                auto energy = anglePot->createForceAndEnergyAction(taf)->perform(topology.get());
+                auto energy = anglePot->forceAndEnergyAction(taf)->perform(topology.get());
                 stateModel.energy() += energy;
             }
             for (const auto &torsionPot : topology->getTorsionPotentials()) {
-                auto energy = torsionPot->createForceAndEnergyAction(taf)->perform(topology.get());
+                auto energy = torsionPot->forceAndEnergyAction(taf)->perform(topology.get());
                 stateModel.energy() += energy;
             }
         };
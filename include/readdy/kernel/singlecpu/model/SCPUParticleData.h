@@ -45,6 +45,7 @@
 #include <memory>
 #include <vector>
 #include <readdy/model/Particle.h>
+#include <readdy/common/ParticleIdIndex.h>
 
 namespace readdy::kernel::scpu::model {
 
@@ -129,8 +130,10 @@ public:
                 const auto idx = _blanks.back();
                 _blanks.pop_back();
                 entries.at(idx) = Entry{p};
+                indexEntry(idx);
             } else {
                 entries.emplace_back(p);
+                indexEntry(entries.size() - 1);
             }
         }
     }
@@ -148,19 +151,15 @@ public:
                 indices.push_back(entries.size());
                 entries.emplace_back(p);
             }
+            indexEntry(indices.back());
         }
         return indices;
     };
 
     void removeParticle(const Particle &particle) {
-        auto it_entries = begin();
-        std::size_t idx = 0;
-        for(; it_entries != end(); ++it_entries, ++idx) {
-            if(!it_entries->is_deactivated() && it_entries->id == particle.id()) {
-                _blanks.push_back(idx);
-                it_entries->deactivated = true;
-                return;
-            }
+        if (auto idx = _idIndex.find(particle.id(), entries)) {
+            removeParticle(*idx);
+            return;
         }
         log::error("Tried to remove particle ({}) which did not exist or was already deactivated!", particle);
     };
@@ -170,6 +169,7 @@ public:
         if(!p.deactivated) {
             _blanks.push_back(index);
             p.deactivated = true;
+            _idIndex.erase(p.id, index);
             // neighbors.at(index).clear();
         } else {
             log::error("Tried to remove particle (index={}), that was already removed!", index);
@@ -219,6 +219,7 @@ public:
     void clear() {
         entries.clear();
         _blanks.clear();
+        _idIndex.invalidate();
     }
 
     const Entry &entry_at(EntryIndex idx) const {
@@ -234,9 +235,11 @@ public:
             const auto idx = _blanks.back();
             _blanks.pop_back();
             entries.at(idx) = entry;
+            indexEntry(idx);
             return idx;
         }
         entries.push_back(entry);
+        indexEntry(entries.size()-1);
         return entries.size()-1;
     }
 
@@ -245,10 +248,14 @@ public:
         if(!entry.is_deactivated()) {
             entry.deactivated = true;
             _blanks.push_back(idx);
+            _idIndex.erase(entry.id, idx);
         }
     };
 
     std::vector<EntryIndex> update(EntriesUpdate&& update_data) {
+        // reactions change ids of the entries in place before handing over the update, so the id index is rebuilt
+        // lazily rather than patched
+        _idIndex.invalidate();
         std::vector<EntryIndex> result;
 
         auto &&newEntries = std::move(std::get<0>(update_data));
@@ -279,8 +286,14 @@ public:
 
 protected:
 
+    void indexEntry(EntryIndex idx) {
+        _idIndex.insert(entries[idx].id, idx);
+    }
+
     Entries entries;
     std::vector<EntryIndex> _blanks;
+    // ids -> indices for removal by id
+    util::ParticleIdIndex<EntryIndex> _idIndex;
 
 };
 
@@ -44,6 +44,11 @@
  */
 
 #pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <random>
 #include <ctime>
@@ -96,6 +101,17 @@ Vec3 normal3(const scalar mean = 0.0, const scalar variance = 1.0) {
             normal<scalar, Generator>(mean, variance)};
 }
 
+/**
+ * Fills a range with normally distributed numbers. Other than repeated calls of normal(), this uses one distribution
+ * object for the whole range, so that both numbers of every pair produced by the underlying transform are used.
+ */
+template<typename RealType=scalar, typename Iter, typename Generator = std::mt19937>
+void fillNormal(Iter begin, Iter end, const RealType mean = 0.0, const RealType variance = 1.0) {
+    static thread_local auto generator = randomlySeededGenerator<Generator>();
+    std::normal_distribution<RealType> distribution(mean, variance);
+    std::generate(begin, end, [&distribution]() { return distribution(generator); });
+}
+
 template<typename Iter, typename Gen = std::mt19937>
 Iter random_element(Iter start, const Iter end) {
     using IntType = typename std::iterator_traits<Iter>::difference_type;
@@ -103,4 +119,149 @@ Iter random_element(Iter start, const Iter end) {
     return start;
 }
 
+/**
+ * The counter-based random number generator Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+ * 1, 2, 3", SC11). It is a bijection of a 128 bit counter parameterized by a 64 bit key and therefore carries no
+ * state: the numbers belonging to some counter can be evaluated on any thread in any order.
+ */
+class Philox4x32 {
+public:
+    using value_type = std::uint32_t;
+    using counter_type = std::array<value_type, 4>;
+    using key_type = std::array<value_type, 2>;
+
+    /**
+     * Applies ten rounds of the Philox bijection
+     * @param counter the counter
+     * @param key the key
+     * @return four random 32 bit words
+     */
+    static counter_type apply(counter_type counter, key_type key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += W0;
+                key[1] += W1;
+            }
+            const auto p0 = static_cast<std::uint64_t>(M0) * counter[0];
+            const auto p1 = static_cast<std::uint64_t>(M1) * counter[2];
+            counter = {static_cast<value_type>(p1 >> 32u) ^ counter[1] ^ key[0], static_cast<value_type>(p1),
+                       static_cast<value_type>(p0 >> 32u) ^ counter[3] ^ key[1], static_cast<value_type>(p0)};
+        }
+        return counter;
+    }
+
+private:
+    static constexpr value_type M0 = 0xD2511F53;
+    static constexpr value_type M1 = 0xCD9E8D57;
+    static constexpr value_type W0 = 0x9E3779B9;
+    static constexpr value_type W1 = 0xBB67AE85;
+};
+
+/**
+ * Combines two subjects of random streams, e.g., the ids of two reacting particles, into one. The combination is
+ * based on the splitmix64 finalizer and not symmetric in its arguments.
+ * @param a the first subject
+ * @param b the second subject
+ * @return the combined subject
+ */
+inline std::uint64_t combineSubjects(std::uint64_t a, std::uint64_t b) {
+    auto z = a + 0x9E3779B97F4A7C15ULL * (b + 1);
+    z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27u)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31u);
+}
+
+/**
+ * A stream of random numbers that is fully determined by a seed, a subject (typically a particle id), a time step and
+ * a stream index distinguishing the consumers within one time step. The key of the Philox generator is given by the
+ * seed, the counter by the remaining three and a block index, so that the same numbers are drawn for a particle no
+ * matter which thread handles it. Words are generated four at a time, normal variates pairwise by the Box-Muller
+ * transform. A stream holds 2^24 blocks of four words.
+ *
+ * Satisfies the UniformRandomBitGenerator requirements and can therefore also be used with std::shuffle and
+ * std::*_distribution.
+ */
+class CounterBasedRandom {
+public:
+    using result_type = Philox4x32::value_type;
+    using seed_type = std::uint64_t;
+    using subject_type = std::uint64_t;
+    using step_type = std::uint32_t;
+    using stream_type = std::uint8_t;
+
+    CounterBasedRandom(seed_type seed, subject_type subject, step_type step, stream_type stream)
+            : _key{static_cast<result_type>(seed), static_cast<result_type>(seed >> 32u)},
+              _counter{static_cast<result_type>(subject), static_cast<result_type>(subject >> 32u), step,
+                       static_cast<result_type>(stream) << 24u} {}
+
+    static constexpr result_type min() {
+        return std::numeric_limits<result_type>::min();
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        if (_nUsed == _block.size()) {
+            _block = Philox4x32::apply(_counter, _key);
+            ++_counter[3];
+            _nUsed = 0;
+        }
+        return _block[_nUsed++];
+    }
+
+    /**
+     * Draws a uniformly distributed number from the open interval (a, b), using 53 random bits for double and 24
+     * random bits for single precision.
+     */
+    template<typename RealType=scalar>
+    RealType uniform_real(const RealType a = 0.0, const RealType b = 1.0) {
+        RealType u;
+        if constexpr (std::numeric_limits<RealType>::digits > 32) {
+            const auto upper = static_cast<std::uint64_t>((*this)());
+            const auto lower = static_cast<std::uint64_t>((*this)());
+            u = (static_cast<RealType>(((upper << 32u) | lower) >> 11u) + .5) * static_cast<RealType>(0x1p-53);
+        } else {
+            u = (static_cast<RealType>((*this)() >> 8u) + .5f) * static_cast<RealType>(0x1p-24);
+        }
+        return a + (b - a) * u;
+    }
+
+    /**
+     * Draws a normally distributed number. As with readdy::model::rnd::normal, the second argument is the standard
+     * deviation.
+     */
+    template<typename RealType=scalar>
+    RealType normal(const RealType mean = 0.0, const RealType variance = 1.0) {
+        if (_hasNormal) {
+            _hasNormal = false;
+            return mean + variance * static_cast<RealType>(_normal);
+        }
+        const auto u1 = uniform_real<double>();
+        const auto u2 = uniform_real<double>();
+        const auto radius = std::sqrt(-2. * std::log(u1));
+        const auto angle = 6.283185307179586476925286766559 * u2;
+        _normal = radius * std::sin(angle);
+        _hasNormal = true;
+        return mean + variance * static_cast<RealType>(radius * std::cos(angle));
+    }
+
+    template<typename RealType=scalar>
+    Vec3 normal3(const RealType mean = 0.0, const RealType variance = 1.0) {
+        const auto x = normal<RealType>(mean, variance);
+        const auto y = normal<RealType>(mean, variance);
+        const auto z = normal<RealType>(mean, variance);
+        return {x, y, z};
+    }
+
+private:
+    Philox4x32::key_type _key;
+    Philox4x32::counter_type _counter;
+    Philox4x32::counter_type _block{};
+    std::size_t _nUsed{std::tuple_size<Philox4x32::counter_type>::value};
+    double _normal{0};
+    bool _hasNormal{false};
+};
+
 }
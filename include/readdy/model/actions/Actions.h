@@ -68,6 +68,7 @@
 #include <readdy/model/Context.h>
 #include <readdy/model/actions/DetailedBalance.h>
 #include <readdy/common/index_persistent_vector.h>
+#include <readdy/common/boundary_condition_operations.h>
 #include "Utils.h"
 #include <readdy/model/topologies/GraphTopology.h>
 #include <readdy/api/ObservableHandle.h>
@@ -288,56 +289,44 @@ protected:
         }
     }
 
+    /**
+     * Evaluates the energy of the bonds configured for the edge, directly from the potential expressions. Only the
+     * energy is needed here, so no evaluation actions are created and no forces are applied.
+     */
     template <typename Kernel>
     scalar
     evaluateEdgeEnergy(model::top::Graph::Edge edge, const readdy::model::top::GraphTopology &t, Kernel *kernel) const {
+        using harmonic_bond = readdy::model::top::TopologyActionFactory::harmonic_bond;
         auto [i1, i2] = edge;
         const auto& v1 = t.graph().vertices().at(i1);
         const auto& v2 = t.graph().vertices().at(i2);
 
-        auto type1 = t.particleForVertex(v1).type();
-        auto type2 = t.particleForVertex(v2).type();
-
-        // find bond configurations for given edge
-        std::unordered_map<api::BondType, std::vector<readdy::model::top::pot::BondConfiguration>, readdy::util::hash::EnumClassHash> bondConfigs;
-        {
-            const auto &potentialConfiguration = kernel->context().topologyRegistry().potentialConfiguration();
-            auto it = potentialConfiguration.pairPotentials.find(std::tie(type1, type2));
-            if (it != potentialConfiguration.pairPotentials.end()) {
-                for (const auto &cfg : it->second) {
-                    bondConfigs[cfg.type].emplace_back(v1->particleIndex, v2->particleIndex,
-                            cfg.forceConstant, cfg.length);
-                }
-            } else {
-                std::ostringstream ss;
-                auto p1 = t.particleForVertex(i1);
-                auto p2 = t.particleForVertex(i2);
+        const auto p1 = t.particleForVertex(v1);
+        const auto p2 = t.particleForVertex(v2);
 
-                throw std::invalid_argument(fmt::format("The edge {} ({}) == {} ({}) has no bond configured!",
-                        v1->particleIndex, kernel->context().particleTypes().nameOf(p1.type()), v2->particleIndex,
-                        kernel->context().particleTypes().nameOf(p2.type())));
-            }
+        const auto &context = kernel->context();
+        const auto &potentialConfiguration = context.topologyRegistry().potentialConfiguration();
+        auto it = potentialConfiguration.pairPotentials.find(std::make_tuple(p1.type(), p2.type()));
+        if (it == potentialConfiguration.pairPotentials.end()) {
+            throw std::invalid_argument(fmt::format("The edge {} ({}) == {} ({}) has no bond configured!",
+                    v1->particleIndex, context.particleTypes().nameOf(p1.type()), v2->particleIndex,
+                    context.particleTypes().nameOf(p2.type())));
         }
 
-        // transform configurations to potential instances
-        std::vector<std::unique_ptr<readdy::model::top::Topology::BondedPotential>> bondedPotentials;
-        for (const auto &bond : bondConfigs) {
-            switch (bond.first) {
+        const auto x_ij = bcs::shortestDifference(p1.pos(), p2.pos(), context.boxSize(),
+                                                  context.periodicBoundaryConditions());
+        const harmonic_bond harmonicBond {harmonic_bond::bond_configurations{}};
+        scalar totalEnergyForEdge{0.};
+        for (const auto &cfg : it->second) {
+            switch (cfg.type) {
                 case api::BondType::HARMONIC: {
-                    bondedPotentials.push_back(
-                            std::make_unique<readdy::model::top::TopologyActionFactory::harmonic_bond>(bond.second));
+                    const readdy::model::top::pot::BondConfiguration bond {v1->particleIndex, v2->particleIndex,
+                                                                           cfg.forceConstant, cfg.length};
+                    totalEnergyForEdge += harmonicBond.calculateEnergy(x_ij, bond);
                     break;
                 }
             }
         }
-
-        // create actions, perform and accumulate energies on edge
-        auto taf = kernel->getTopologyActionFactory();
-        scalar totalEnergyForEdge{0.};
-        for (const auto &bondedPot : bondedPotentials) {
-            totalEnergyForEdge += bondedPot->createForceAndEnergyAction(taf)->perform(&t);
-        }
-
         return totalEnergyForEdge;
     }
 };
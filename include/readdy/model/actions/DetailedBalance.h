@@ -130,7 +130,13 @@ struct ReversibleReactionConfig {
     std::string describe() const;
 
     scalar drawFissionDistance() const {
-        auto u = readdy::model::rnd::uniform_real();
+        return drawFissionDistance(readdy::model::rnd::uniform_real());
+    }
+
+    /**
+     * Draws a fission distance by inverting the cumulative distribution at the given uniform random number in (0, 1).
+     */
+    scalar drawFissionDistance(scalar u) const {
         auto it = std::lower_bound(cumulativeFissionProb.begin(), cumulativeFissionProb.end(), u);
         auto index = std::distance(cumulativeFissionProb.begin(), it);
         return fissionRadii[index];
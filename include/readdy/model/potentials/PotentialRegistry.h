@@ -68,6 +68,37 @@ public:
     using PotentialsO1Map = std::unordered_map<ParticleTypeId, PotentialsO1Collection>;
     using PotentialsO2Map = util::particle_type_pair_unordered_map<PotentialsO2Collection>;
     using AltPotentialsO2Map = std::unordered_map<ParticleTypeId, std::unordered_map<ParticleTypeId, PotentialsO2Collection>>;
+    using PotentialsO2Table = util::ParticleTypePairTable<PotentialOrder2 *>;
+
+    /**
+     * Second order potentials by type pair, split up by the concrete classes of the built-in potentials. Since these
+     * classes are final, pair loops can iterate the ranges with inlined force and energy evaluations and only have to
+     * go through virtual calls for the remaining, e.g., user-defined, potentials.
+     */
+    struct PotentialsO2ByClass {
+        util::ParticleTypePairTable<const HarmonicRepulsion *> harmonicRepulsion;
+        util::ParticleTypePairTable<const WeakInteractionPiecewiseHarmonic *> weakInteractionPiecewiseHarmonic;
+        util::ParticleTypePairTable<const LennardJones *> lennardJones;
+        util::ParticleTypePairTable<const ScreenedElectrostatics *> screenedElectrostatics;
+        util::ParticleTypePairTable<const Tabulated *> tabulated;
+        util::ParticleTypePairTable<const PotentialOrder2 *> other;
+
+        /**
+         * Invokes the function once per class with the range of potentials for the type pair.
+         * @param t1 the first type
+         * @param t2 the second type
+         * @param function generic callback taking a range of pointers to potentials
+         */
+        template<typename Function>
+        void forEachClass(ParticleTypeId t1, ParticleTypeId t2, Function &&function) const {
+            function(harmonicRepulsion(t1, t2));
+            function(weakInteractionPiecewiseHarmonic(t1, t2));
+            function(lennardJones(t1, t2));
+            function(screenedElectrostatics(t1, t2));
+            function(tabulated(t1, t2));
+            function(other(t1, t2));
+        }
+    };
 
 
     /**
@@ -234,6 +265,55 @@ public:
         _registerO2(pots.back().get());
     }
 
+    /**
+     * Register a pair potential that is given by energies at a set of distances. The values are interpolated by a
+     * natural cubic spline in the distance, which is then tabulated over the squared distance, see Tabulated.
+     *
+     * @param type1 first particle type
+     * @param type2 second particle type
+     * @param distances strictly increasing, positive distances, the last one is the cutoff
+     * @param energies the energies at the distances
+     * @param tolerance accuracy of the tabulation w.r.t. the interpolant
+     */
+    void addTabulated(const std::string &type1, const std::string &type2, const std::vector<scalar> &distances,
+                      const std::vector<scalar> &energies, scalar tolerance) {
+        addTabulated(_types->idOf(type1), _types->idOf(type2), distances, energies, tolerance);
+    }
+
+    void addTabulated(ParticleTypeId type1, ParticleTypeId type2, const std::vector<scalar> &distances,
+                      const std::vector<scalar> &energies, scalar tolerance) {
+        auto &pots = _ownPotentialsP2[std::tie(type1, type2)];
+        pots.emplace_back(std::make_shared<Tabulated>(type1, type2, distances, energies, tolerance));
+        _registerO2(pots.back().get());
+    }
+
+    /**
+     * Same as addTabulated() but reads the values from a text file with two whitespace separated columns, distance
+     * and energy. Empty lines and everything after a '#' are ignored.
+     *
+     * @param type1 first particle type
+     * @param type2 second particle type
+     * @param filename path to the file
+     * @param tolerance accuracy of the tabulation w.r.t. the interpolant
+     */
+    void addTabulatedFromFile(const std::string &type1, const std::string &type2, const std::string &filename,
+                              scalar tolerance) {
+        addTabulatedFromFile(_types->idOf(type1), _types->idOf(type2), filename, tolerance);
+    }
+
+    void addTabulatedFromFile(ParticleTypeId type1, ParticleTypeId type2, const std::string &filename,
+                              scalar tolerance);
+
+    /**
+     * Replaces all registered pair potentials, which are not tabulated already, by their tabulated approximations.
+     * This trades the evaluation of square roots and transcendental functions per pair for a table lookup and should
+     * be called after all pair potentials have been registered.
+     *
+     * @param tolerance the accuracy of the tabulation, see Tabulated
+     * @param minDistance the smallest distance to tabulate, below it the values at minDistance are used
+     */
+    void tabulate(scalar tolerance, scalar minDistance);
+
     /**
      * Register a sphere potential, which is used to confine particles inside or outside a spherical volume.
      * The energy function increases quadratically with respect to the distance from the sphere edge,
@@ -338,6 +418,22 @@ public:
         return _potentialsO2;
     }
 
+    /**
+     * Dense variant of potentialsOrder2() for pair loops, it is kept up to date on every registration.
+     * @return the table of second order potentials by type pair
+     */
+    const PotentialsO2Table &potentialsOrder2Table() const {
+        return _potentialsO2Table;
+    }
+
+    /**
+     * Second order potentials grouped by type pair and concrete class, kept up to date on every registration.
+     * @return the grouped potentials
+     */
+    const PotentialsO2ByClass &potentialsOrder2ByClass() const {
+        return _potentialsO2ByClass;
+    }
+
     const PotentialsO1Collection &potentialsOf(const std::string &type) const {
         return potentialsOf(_types->idOf(type));
     }
@@ -359,6 +455,8 @@ private:
     AltPotentialsO2Map _alternativeO2Registry{};
     PotentialsO1Map _potentialsO1{};
     PotentialsO2Map _potentialsO2{};
+    PotentialsO2Table _potentialsO2Table{};
+    PotentialsO2ByClass _potentialsO2ByClass{};
 
     OwnPotentialsO1Map _ownPotentialsO1{};
     OwnPotentialsO2Map _ownPotentialsP2{};
@@ -377,8 +475,11 @@ private:
         if (type1Id != type2Id) {
             _alternativeO2Registry[type2Id][type1Id].push_back(potential);
         }
+        _rebuildO2Tables();
     }
 
+    void _rebuildO2Tables();
+
     friend readdy::model::Context;
 };
 
@@ -37,6 +37,9 @@
  * This header contains the declarations of order 2 potentials. Currently:
  *   - Harmonic repulsion
  *   - Weak interaction piecewise harmonic
+ *   - Lennard-Jones
+ *   - Screened electrostatics
+ *   - Tabulated
  *
  * @file PotentialsOrder2.h
  * @brief Contains the declaration of order 2 potentials.
@@ -47,11 +50,15 @@
 #pragma once
 
 #include <ostream>
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <vector>
 #include "PotentialOrder2.h"
 
 namespace readdy::model::potentials {
 
-class HarmonicRepulsion : public PotentialOrder2 {
+class HarmonicRepulsion final : public PotentialOrder2 {
     using super = PotentialOrder2;
 public:
     HarmonicRepulsion(ParticleTypeId type1, ParticleTypeId type2,
@@ -90,6 +97,21 @@ public:
         }
     }
 
+    /**
+     * Same as calculateEnergy and calculateForce, with the distance evaluated only once.
+     */
+    void calculateForceAndEnergy(Vec3 &force, scalar &energy, const Vec3 &x_ij) const {
+        const auto squared = x_ij * x_ij;
+        if (squared < _interactionDistanceSquared) {
+            const auto distance = std::sqrt(squared);
+            const auto deviation = distance - _interactionDistance;
+            energy += static_cast<scalar>(0.5) * deviation * deviation * getForceConstant();
+            if (squared > 0) {
+                force += (getForceConstant() * deviation) / distance * x_ij;
+            }
+        }
+    }
+
     scalar getCutoffRadiusSquared() const override {
         return _interactionDistanceSquared;
     }
@@ -102,7 +124,7 @@ protected:
     scalar _forceConstant;
 };
 
-class WeakInteractionPiecewiseHarmonic : public PotentialOrder2 {
+class WeakInteractionPiecewiseHarmonic final : public PotentialOrder2 {
     using super = PotentialOrder2;
 public:
     std::string describe() const override;
@@ -182,6 +204,31 @@ public:
         }
     }
 
+    /**
+     * Same as calculateEnergy and calculateForce, with the distance evaluated only once.
+     */
+    void calculateForceAndEnergy(Vec3 &force, scalar &energy, const Vec3 &x_ij) const {
+        const auto dist = std::sqrt(x_ij * x_ij);
+        const auto len_part2 = conf.noInteractionDistance - conf.desiredParticleDistance;
+        const auto curvature = conf.depthAtDesiredDistance * (1. / (.5 * len_part2)) * (1. / (.5 * len_part2));
+        scalar factor = 0;
+        if (dist < conf.desiredParticleDistance) {
+            energy += static_cast<scalar>(.5) * forceConstant * (dist - conf.desiredParticleDistance) *
+                      (dist - conf.desiredParticleDistance) - conf.depthAtDesiredDistance;
+            factor = -1 * forceConstant * (conf.desiredParticleDistance - dist);
+        } else if (dist < conf.desiredParticleDistance + .5 * len_part2) {
+            energy += .5 * curvature * (dist - conf.desiredParticleDistance) * (dist - conf.desiredParticleDistance)
+                      - conf.depthAtDesiredDistance;
+            factor = -1. * curvature * (conf.desiredParticleDistance - dist);
+        } else if (dist < conf.noInteractionDistance) {
+            energy += -.5 * curvature * (dist - conf.noInteractionDistance) * (dist - conf.noInteractionDistance);
+            factor = curvature * (conf.noInteractionDistance - dist);
+        }
+        if (dist > 0 && factor != 0) {
+            force += factor * x_ij / dist;
+        }
+    }
+
     scalar getCutoffRadiusSquared() const override {
         return conf.noInteractionDistanceSquared;
     }
@@ -196,7 +243,7 @@ protected:
 /**
  * Lennard-Jones potential class
  */
-class LennardJones : public PotentialOrder2 {
+class LennardJones final : public PotentialOrder2 {
     using super = PotentialOrder2;
 public:
     /**
@@ -252,6 +299,20 @@ public:
         }
     }
 
+    /**
+     * Same as calculateEnergy and calculateForce, with the powers of sigma / r evaluated only once.
+     */
+    void calculateForceAndEnergy(Vec3 &force, scalar &energy, const Vec3 &x_ij) const {
+        const auto norm = x_ij.norm();
+        if (norm <= cutoffDistance) {
+            const auto ratio = sigma / norm;
+            const auto powM = std::pow(ratio, m);
+            const auto powN = std::pow(ratio, n);
+            energy += k * (powM - powN) - energyShift;
+            force += -1. * k * (1 / (sigma * sigma)) * (ratio * ratio) * (m * powM - n * powN) * x_ij;
+        }
+    }
+
     scalar getCutoffRadiusSquared() const override {
         return cutoffDistanceSquared;
     }
@@ -269,9 +330,11 @@ protected:
     scalar epsilon; // depth
     scalar sigma;
     scalar k;
+    // energy at the cutoff if the potential is shifted, otherwise zero
+    scalar energyShift;
 };
 
-class ScreenedElectrostatics : public PotentialOrder2 {
+class ScreenedElectrostatics final : public PotentialOrder2 {
     using super = PotentialOrder2;
 public:
     ScreenedElectrostatics(ParticleTypeId type1, ParticleTypeId type2, scalar electrostaticStrength,
@@ -304,6 +367,19 @@ public:
         force += forceFactor * (-1. * x_ij / distance);
     }
 
+    /**
+     * Same as calculateEnergy and calculateForce, with the exponential and the power evaluated only once.
+     */
+    void calculateForceAndEnergy(Vec3 &force, scalar &energy, const Vec3 &x_ij) const {
+        const auto distance = x_ij.norm();
+        const auto screening = electrostaticStrength * std::exp(-inverseScreeningDepth * distance);
+        const auto repulsion = repulsionStrength * std::pow(repulsionDistance / distance, exponent);
+        energy += screening / distance + repulsion;
+        auto forceFactor = screening * (inverseScreeningDepth / distance + 1. / (distance * distance));
+        forceFactor += exponent / repulsionDistance * repulsion * (repulsionDistance / distance);
+        force += forceFactor * (-1. * x_ij / distance);
+    }
+
     std::string describe() const override;
 
     scalar getCutoffRadiusSquared() const override {
@@ -322,6 +398,103 @@ protected:
     scalar cutoffSquared;
 };
 
+/**
+ * Cubic spline approximation of a pair potential on a uniform grid over the squared distance r^2, so that neither a
+ * square root nor any transcendental function has to be evaluated per pair. Below the minimal tabulated distance the
+ * energy and its derivative at the minimal distance are used. Beyond the cutoff the potential vanishes.
+ */
+class Tabulated final : public PotentialOrder2 {
+    using super = PotentialOrder2;
+public:
+    /**
+     * Tabulates another pair potential between its cutoff and a minimal distance. The number of grid points is
+     * doubled until energy and derivative deviate from the analytic form by at most the tolerance, measured as
+     * absolute error for values smaller than one and as relative error otherwise.
+     * @param potential the potential to tabulate
+     * @param tolerance the accuracy target
+     * @param minDistance the smallest distance to tabulate, must be positive
+     */
+    Tabulated(const PotentialOrder2 &potential, scalar tolerance, scalar minDistance);
+
+    /**
+     * Interpolates given energies at given distances, e.g., read from a file, with a natural cubic spline and
+     * tabulates the interpolant. The last distance is the cutoff.
+     * @param type1 first particle type
+     * @param type2 second particle type
+     * @param distances strictly increasing, positive distances
+     * @param energies energies at the distances
+     * @param tolerance the accuracy target w.r.t. the interpolant
+     */
+    Tabulated(ParticleTypeId type1, ParticleTypeId type2, const std::vector<scalar> &distances,
+              const std::vector<scalar> &energies, scalar tolerance);
+
+    scalar calculateEnergy(const Vec3 &x_ij) const override {
+        const auto distanceSquared = x_ij * x_ij;
+        if (distanceSquared < _cutoffSquared) {
+            const auto [interval, t] = locate(distanceSquared);
+            const auto *c = &_coefficients[4 * interval];
+            return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+        }
+        return 0;
+    }
+
+    void calculateForce(Vec3 &force, const Vec3 &x_ij) const override {
+        const auto distanceSquared = x_ij * x_ij;
+        if (distanceSquared < _cutoffSquared) {
+            const auto [interval, t] = locate(distanceSquared);
+            const auto *c = &_coefficients[4 * interval];
+            // dV/d(r^2), the force on particle i is 2 dV/d(r^2) x_ij
+            const auto derivative = (c[1] + t * (2 * c[2] + t * 3 * c[3])) * _inverseWidth;
+            force += (2 * derivative) * x_ij;
+        }
+    }
+
+    /**
+     * Same as calculateEnergy and calculateForce, with the spline segment located only once.
+     */
+    void calculateForceAndEnergy(Vec3 &force, scalar &energy, const Vec3 &x_ij) const {
+        const auto distanceSquared = x_ij * x_ij;
+        if (distanceSquared < _cutoffSquared) {
+            const auto [interval, t] = locate(distanceSquared);
+            const auto *c = &_coefficients[4 * interval];
+            energy += c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+            const auto derivative = (c[1] + t * (2 * c[2] + t * 3 * c[3])) * _inverseWidth;
+            force += (2 * derivative) * x_ij;
+        }
+    }
+
+    scalar getCutoffRadiusSquared() const override {
+        return _cutoffSquared;
+    }
+
+    std::size_t nIntervals() const {
+        return _nIntervals;
+    }
+
+    std::string describe() const override;
+
+    std::string type() const override;
+
+private:
+    using sampler = std::function<std::tuple<scalar, scalar>(scalar)>;
+
+    void tabulate(const sampler &energyAndDerivative, scalar tolerance);
+
+    std::tuple<std::size_t, scalar> locate(scalar distanceSquared) const {
+        const auto u = (std::max(distanceSquared, _minDistanceSquared) - _minDistanceSquared) * _inverseWidth;
+        const auto interval = std::min(static_cast<std::size_t>(u), _nIntervals - 1);
+        return std::make_tuple(interval, u - static_cast<scalar>(interval));
+    }
+
+    std::string _origin;
+    scalar _minDistanceSquared;
+    scalar _cutoffSquared;
+    scalar _inverseWidth{0};
+    std::size_t _nIntervals{0};
+    // four polynomial coefficients per interval in the local coordinate t in [0, 1]
+    std::vector<scalar> _coefficients;
+};
+
 template<typename T>
 const std::string getPotentialName(typename std::enable_if<std::is_base_of<HarmonicRepulsion, T>::value>::type * = 0) {
     return "HarmonicRepulsion";
@@ -345,4 +518,10 @@ getPotentialName(typename std::enable_if<std::is_base_of<ScreenedElectrostatics,
     return "ScreenedElectrostatics";
 }
 
+template<typename T>
+const std::string
+getPotentialName(typename std::enable_if<std::is_base_of<Tabulated, T>::value>::type * = 0) {
+    return "Tabulated";
+}
+
 }
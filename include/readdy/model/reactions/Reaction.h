@@ -82,6 +82,8 @@ inline std::ostream &operator<<(std::ostream &os, const ReactionType &reactionTy
     return os;
 }
 
+class ReactionRegistry;
+
 class Reaction {
 public:
     Reaction(std::string name, scalar rate, scalar eductDistance, scalar productDistance, std::uint8_t nEducts,
@@ -110,6 +112,15 @@ public:
         return _rate;
     }
 
+    /**
+     * The probability of this reaction to occur within one time step, as cached by
+     * ReactionRegistry::cacheProbabilities.
+     * @return the probability
+     */
+    const scalar probability() const {
+        return _probability;
+    }
+
     std::uint8_t nEducts() const {
         return _nEducts;
     }
@@ -174,10 +185,13 @@ protected:
     std::string _name;
     ReactionId _id;
     scalar _rate;
+    scalar _probability{0};
     scalar _eductDistance, _eductDistanceSquared;
     scalar _productDistance;
 
     scalar _weight1 = .5, _weight2 = .5;
+
+    friend ReactionRegistry;
 };
 
 }
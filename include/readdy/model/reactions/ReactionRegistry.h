@@ -66,6 +66,7 @@ public:
     using ReactionsCollection = std::vector<Reaction *>;
     using ReactionsO1Map = std::unordered_map<ParticleTypeId, ReactionsCollection>;
     using ReactionsO2Map = util::particle_type_pair_unordered_map<ReactionsCollection>;
+    using ReactionsO2Table = util::ParticleTypePairTable<Reaction *>;
 
     const std::size_t &nOrder1() const {
         return _n_order1;
@@ -148,6 +149,14 @@ public:
         return it != _o2Reactions.end() ? it->second : DEFAULT_REACTIONS;
     }
 
+    /**
+     * Dense variant of order2ByType for pair loops, the ranges hold the reactions in the same order.
+     * @return the table of second order reactions by type pair
+     */
+    const ReactionsO2Table &order2Table() const {
+        return _o2ReactionsTable;
+    }
+
     const ReactionsCollection &order1ByType(const std::string &type) const {
         return order1ByType(_types->idOf(type));
     }
@@ -267,6 +276,35 @@ public:
         return emplaceReaction(std::make_shared<Decay>(name, type, rate));
     }
 
+    /**
+     * Caches the probability of each reaction to occur within a time step, which is 1 - exp(-rate * timeStep) or,
+     * approximated, rate * timeStep. Per particle type, it also caches the total rate of its first order reactions and
+     * the probability of any of them to occur. Reaction handlers call this before evaluating a time step, so that
+     * the exponentials are not evaluated per candidate.
+     * @param timeStep the time step
+     * @param approximated whether the probabilities are approximated linearly in the time step
+     */
+    void cacheProbabilities(scalar timeStep, bool approximated);
+
+    /**
+     * The total rate of the first order reactions of a particle type, as cached by cacheProbabilities.
+     * @param type the particle type
+     * @return the total rate
+     */
+    scalar order1TotalRate(ParticleTypeId type) const {
+        return type < _o1TotalRates.size() ? _o1TotalRates[type] : 0;
+    }
+
+    /**
+     * The probability of any first order reaction of a particle type to occur within a time step, as cached by
+     * cacheProbabilities.
+     * @param type the particle type
+     * @return the probability
+     */
+    scalar order1Probability(ParticleTypeId type) const {
+        return type < _o1Probabilities.size() ? _o1Probabilities[type] : 0;
+    }
+
     std::string describe() const;
 
 private:
@@ -285,6 +323,10 @@ private:
 
     ReactionsO1Map _o1Reactions{};
     ReactionsO2Map _o2Reactions{};
+    ReactionsO2Table _o2ReactionsTable{};
+
+    std::vector<scalar> _o1TotalRates{};
+    std::vector<scalar> _o1Probabilities{};
 
     OwnReactionsO1Map _ownO1Reactions{};
     OwnReactionsO2Map _ownO2Reactions{};
@@ -45,6 +45,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include <graphs/graphs.h>
 
 #include "common.h"
@@ -82,6 +84,9 @@ public:
 
     void setGraph(Graph graph) {
         _graph = std::move(graph);
+        _knownConnected = false;
+        _removedEdges.clear();
+        rebuildVertexIndex();
     }
 
     [[nodiscard]] const Graph &graph() const {
@@ -109,15 +114,17 @@ public:
     }
 
     void removeEdge(Graph::iterator it1, Graph::iterator it2) {
-        _graph.removeEdge(it1, it2);
+        removeEdge(_graph.vertices().persistentIndex(it1), _graph.vertices().persistentIndex(it2));
     }
 
     void removeEdge(Graph::Edge edge) {
         _graph.removeEdge(edge);
+        edgeRemoved(edge);
     }
 
     void removeEdge(Graph::PersistentVertexIndex ix1, Graph::PersistentVertexIndex ix2) {
         _graph.removeEdge(ix1, ix2);
+        edgeRemoved(std::make_tuple(ix1, ix2));
     }
 
     void configure();
@@ -147,7 +154,7 @@ public:
     }
 
     void validate() {
-        if (!graph().isConnected()) {
+        if (!isConnected()) {
             throw std::invalid_argument(fmt::format("The graph is not connected! (GEXF representation: {})", _graph.gexf()));
         }
         for(const auto [i1, i2] : graph().edges()) {
@@ -165,6 +172,19 @@ public:
         }
     }
 
+    /**
+     * Checks whether the graph is connected. If it was known to be connected before, only the edges that were removed
+     * since then are checked by a bidirectional search from their end points, otherwise the whole graph is traversed.
+     * @return true if the graph is connected
+     */
+    bool isConnected();
+
+    /**
+     * Splits the graph into its connected components. If the graph was known to be connected before removing edges,
+     * only the smaller sides of the removed edges are walked and copied into new graphs, the largest component keeps
+     * the vertices of this topology. This topology's graph is left empty.
+     * @return the connected components
+     */
     std::vector<GraphTopology> connectedComponents();
 
     [[nodiscard]] bool isDeactivated() const {
@@ -186,11 +206,11 @@ public:
     [[nodiscard]] typename Graph::VertexList::const_persistent_iterator vertexIteratorForParticle(VertexData::ParticleIndex index) const;
 
     [[nodiscard]] Graph::PersistentVertexIndex vertexIndexForParticle(VertexData::ParticleIndex index) const {
-        auto it = vertexIteratorForParticle(index);
-        if(it == _graph.vertices().end_persistent()) {
+        auto it = _vertexIndex.find(index);
+        if(it == _vertexIndex.end()) {
             throw std::invalid_argument(fmt::format("Particle {} not contained in graph", index));
         }
-        return {static_cast<std::size_t>(std::distance(_graph.vertices().begin_persistent(), it))};
+        return it->second;
     }
 
     typename Graph::PersistentVertexIndex appendParticle(VertexData::ParticleIndex newParticle,
@@ -204,6 +224,13 @@ public:
 
     [[nodiscard]] std::vector<VertexData::ParticleIndex> particleIndices() const;
 
+    /**
+     * Updates the particle indices of the vertices and of the configured topology potentials after the particle data
+     * was permuted. The potentials are not reconfigured, only their revision changes.
+     * @param newIndices the new index of each old particle index
+     */
+    void remapParticleIndices(const std::vector<VertexData::ParticleIndex> &newIndices);
+
     [[nodiscard]] TopologyTypeId type() const {
         return _topology_type;
     }
@@ -241,6 +268,32 @@ public:
     }
 
 protected:
+    void edgeRemoved(const Graph::Edge &edge) {
+        if (_knownConnected) {
+            _removedEdges.push_back(edge);
+        }
+    }
+
+    /**
+     * Searches from both end points of a removed edge in alternating fashion until either the searches meet or one of
+     * them runs out of vertices, the cost is therefore bounded by the size of the smaller side.
+     * @param edge the removed edge or any other pair of vertices
+     * @return the vertices of the side that was cut off or an empty vector if the end points are still connected
+     */
+    [[nodiscard]] std::vector<Graph::PersistentVertexIndex> cutOffSide(const Graph::Edge &edge) const;
+
+    /**
+     * The distinct end points of the removed edges that are still part of the graph. If the graph fell apart, each of
+     * its components contains at least one of them.
+     */
+    [[nodiscard]] std::vector<Graph::PersistentVertexIndex> removedEdgeEndpoints() const;
+
+    /**
+     * Rebuilds the mapping from particle indices to the vertices of the graph, needed whenever the graph was replaced
+     * or the particle indices were changed as a whole.
+     */
+    void rebuildVertexIndex();
+
     Graph _graph;
     std::reference_wrapper<const model::Context> _context;
     const model::StateModel *_stateModel;
@@ -249,6 +302,9 @@ protected:
     ReactionRates _spatial_reaction_rates;
     TopologyTypeId _topology_type;
     bool deactivated{false};
+    bool _knownConnected{false};
+    std::vector<Graph::Edge> _removedEdges;
+    std::unordered_map<VertexData::ParticleIndex, Graph::PersistentVertexIndex> _vertexIndex;
 };
 
 }
@@ -45,6 +45,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -99,34 +100,58 @@ public:
     template<typename T, typename... Args>
     typename std::enable_if<std::is_base_of<BondedPotential, T>::value>::type addBondedPotential(Args &&...args) {
         bondedPotentials.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        potentialsChanged();
     }
 
     void addBondedPotential(std::unique_ptr<BondedPotential> &&pot) {
         bondedPotentials.push_back(std::move(pot));
+        potentialsChanged();
     }
 
     template<typename T, typename... Args>
     typename std::enable_if<std::is_base_of<AnglePotential, T>::value>::type addAnglePotential(Args &&...args) {
         anglePotentials.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        potentialsChanged();
     }
 
     void addAnglePotential(std::unique_ptr<AnglePotential> &&pot) {
         anglePotentials.push_back(std::move(pot));
+        potentialsChanged();
     }
 
     template<typename T, typename... Args>
     typename std::enable_if<std::is_base_of<TorsionPotential, T>::value>::type addTorsionPotential(Args &&...args) {
         torsionPotentials.push_back(std::make_unique<T>(std::forward<Args>(args)...));
+        potentialsChanged();
     }
 
     void addTorsionPotential(std::unique_ptr<TorsionPotential> &&pot) {
         torsionPotentials.push_back(std::move(pot));
+        potentialsChanged();
+    }
+
+    /**
+     * Identifies the current potentials of this topology. It changes whenever potentials are added or the topology
+     * is reconfigured and is unique among all topologies, so that kernels can tell when derived data is outdated.
+     * @return the revision
+     */
+    [[nodiscard]] std::size_t potentialsRevision() const {
+        return _potentialsRevision;
     }
 
 protected:
+    void potentialsChanged() {
+        _potentialsRevision = ++potentialsRevisionCounter;
+    }
+
+
     std::vector<std::unique_ptr<BondedPotential>> bondedPotentials;
     std::vector<std::unique_ptr<AnglePotential>> anglePotentials;
     std::vector<std::unique_ptr<TorsionPotential>> torsionPotentials;
+
+private:
+    static std::atomic<std::size_t> potentialsRevisionCounter;
+    std::size_t _potentialsRevision{++potentialsRevisionCounter};
 };
 
 }
@@ -224,6 +224,14 @@ public:
 
     std::string describe() const;
 
+    /**
+     * Caches the probability of each spatial topology reaction with a constant rate to occur within a time step,
+     * which is 1 - exp(-rate * timeStep) or, approximated, rate * timeStep.
+     * @param timeStep the time step
+     * @param approximated whether the probabilities are approximated linearly in the time step
+     */
+    void cacheProbabilities(scalar timeStep, bool approximated);
+
     void addSpatialReaction(reactions::SpatialTopologyReaction &&reaction);
 
     void addSpatialReaction(const std::string &name, const std::string &typeFrom1,
@@ -66,7 +66,7 @@ struct AngleConfiguration {
     AngleConfiguration(size_t idx1, size_t idx2, size_t idx3, scalar forceConstant, scalar theta_0)
             : idx1(idx1), idx2(idx2), idx3(idx3), equilibriumAngle(theta_0), forceConstant(forceConstant) {}
 
-    const std::size_t idx1, idx2, idx3;
+    std::size_t idx1, idx2, idx3;
     const scalar equilibriumAngle, forceConstant;
 };
 
@@ -95,6 +95,14 @@ public:
         return angles;
     }
 
+    void remapParticleIndices(const std::vector<std::size_t> &newIndices) override {
+        for (auto &angle : angles) {
+            angle.idx1 = newIndices.at(angle.idx1);
+            angle.idx2 = newIndices.at(angle.idx2);
+            angle.idx3 = newIndices.at(angle.idx3);
+        }
+    }
+
     scalar calculateEnergy(const Vec3 &x_ji, const Vec3 &x_jk, const angle &angle) const;
 
     void
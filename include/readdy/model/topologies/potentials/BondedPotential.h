@@ -82,6 +82,13 @@ public:
         return bonds;
     }
 
+    void remapParticleIndices(const std::vector<std::size_t> &newIndices) override {
+        for (auto &bond : bonds) {
+            bond.idx1 = newIndices.at(bond.idx1);
+            bond.idx2 = newIndices.at(bond.idx2);
+        }
+    }
+
 protected:
     bond_configurations bonds;
 };
@@ -45,6 +45,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "TopologyPotentialAction.h"
 
 namespace readdy::model::top {
@@ -57,17 +59,44 @@ class TopologyPotential {
 public:
     TopologyPotential() = default;
 
-    TopologyPotential(const TopologyPotential &) = default;
+    // the cached action refers to the potential it was created for, so copies and moves start without one
+    TopologyPotential(const TopologyPotential &) : TopologyPotential() {}
 
     TopologyPotential &operator=(const TopologyPotential &) = delete;
 
-    TopologyPotential(TopologyPotential &&) = default;
+    TopologyPotential(TopologyPotential &&) noexcept : TopologyPotential() {}
 
     TopologyPotential &operator=(TopologyPotential &&) = delete;
 
     virtual ~TopologyPotential() = default;
 
     virtual std::unique_ptr<EvaluatePotentialAction> createForceAndEnergyAction(const TopologyActionFactory *) = 0;
+
+    /**
+     * Replaces the particle indices this potential refers to, e.g., after the particle data was permuted. The cached
+     * action reads the indices on evaluation and stays valid.
+     * @param newIndices the new index of each old particle index
+     */
+    virtual void remapParticleIndices(const std::vector<std::size_t> &newIndices) = 0;
+
+    /**
+     * Yields the action evaluating this potential, it is created by the factory on first use and then kept. Topologies
+     * recreate their potentials whenever they are configured, i.e., when their graph changes, which also discards the
+     * action.
+     * @param factory the topology action factory of the kernel
+     * @return the action
+     */
+    EvaluatePotentialAction *forceAndEnergyAction(const TopologyActionFactory *factory) {
+        if (!_forceAndEnergyAction || _actionFactory != factory) {
+            _forceAndEnergyAction = createForceAndEnergyAction(factory);
+            _actionFactory = factory;
+        }
+        return _forceAndEnergyAction.get();
+    }
+
+private:
+    std::unique_ptr<EvaluatePotentialAction> _forceAndEnergyAction{nullptr};
+    const TopologyActionFactory *_actionFactory{nullptr};
 };
 
 }
@@ -83,6 +83,15 @@ public:
         return dihedrals;
     }
 
+    void remapParticleIndices(const std::vector<std::size_t> &newIndices) override {
+        for (auto &dihedral : dihedrals) {
+            dihedral.idx1 = newIndices.at(dihedral.idx1);
+            dihedral.idx2 = newIndices.at(dihedral.idx2);
+            dihedral.idx3 = newIndices.at(dihedral.idx3);
+            dihedral.idx4 = newIndices.at(dihedral.idx4);
+        }
+    }
+
     scalar calculateEnergy(const Vec3 &x_ji, const Vec3 &x_kj, const Vec3 &x_kl, const dihedral_configuration &) const;
 
     void
@@ -197,6 +197,22 @@ public:
         return _rate;
     }
 
+    /**
+     * The probability of this reaction to occur within one time step, as cached by
+     * TopologyRegistry::cacheProbabilities. Only reactions with a constant rate have one.
+     * @return the probability
+     */
+    [[nodiscard]] scalar probability() const {
+        if (!_rate_is_const) {
+            throw std::runtime_error("rate is not static, there is no probability cached for it");
+        }
+        return _probability;
+    }
+
+    [[nodiscard]] bool rateIsConstant() const {
+        return _rate_is_const;
+    }
+
     const scalar radius() const {
         return _radius;
     }
@@ -223,6 +239,7 @@ private:
     ReactionId _id {counter++};
 
     friend class STRParser;
+    friend class readdy::model::top::TopologyRegistry;
 
     SpatialTopologyReaction() = default;
 
@@ -232,6 +249,7 @@ private:
     topology_type_pair _top_types;
     topology_type_pair _top_types_to;
     scalar _rate{0};
+    scalar _probability{0};
     scalar _radius{0};
     STRMode _mode{STRMode::TP_ENZYMATIC};
     unsigned _min_graph_distance{0};
@@ -46,11 +46,14 @@
 
 #pragma once
 
+#include <optional>
+
 #include <readdy/model/StateModel.h>
 
 
 #include <readdy/model/StateModel.h>
 #include <readdy/model/Context.h>
+#include <readdy/model/RandomProvider.h>
 #include <readdy/common/thread/Config.h>
 #include <readdy/model/reactions/ReactionRecord.h>
 #include <readdy/model/observables/ReactionCounts.h>
@@ -74,6 +77,14 @@ public:
     using topologies_vec = readdy::util::index_persistent_vector<topology_ref>;
     using neighbor_list = nl::CompactCellLinkedList;
 
+    /**
+     * Consumers of counter-based random numbers within one time step
+     */
+    enum class RandomStream : readdy::model::rnd::CounterBasedRandom::stream_type {
+        integrator, reactionsOrder1, reactionsOrder2, fission, eventSelection, topologyReactions,
+        topologyEventSelection, detailedBalance
+    };
+
     CPUStateModel(data_type &data, const readdy::model::Context &context, thread_pool &pool,
                   readdy::model::top::TopologyActionFactory const* taf);
 
@@ -87,6 +98,32 @@ public:
     void configure(const readdy::conf::cpu::Configuration &configuration) {
         const auto& nl = configuration.neighborList;
         _neighborListCellRadius = nl.cll_radius;
+        _neighborListSkin = nl.skin;
+        _reorderInterval = configuration.dataLayout.reorderInterval;
+        _spaceFillingCurve = configuration.dataLayout.spaceFillingCurve;
+        if (configuration.random.seed >= 0) {
+            _seed = static_cast<readdy::model::rnd::CounterBasedRandom::seed_type>(configuration.random.seed);
+        } else {
+            _seed = std::nullopt;
+        }
+    }
+
+    /**
+     * @return whether the kernel was configured with a seed and draws counter-based random numbers
+     */
+    bool seeded() const {
+        return _seed.has_value();
+    }
+
+    /**
+     * Yields the counter-based random numbers of some subject in the current time step. Requires a seed.
+     * @param subject the subject, typically a particle id
+     * @param stream the consumer
+     * @return the random stream
+     */
+    readdy::model::rnd::CounterBasedRandom randomStream(std::uint64_t subject, RandomStream stream) const {
+        return {_seed.value(), subject, _randomStep,
+                static_cast<readdy::model::rnd::CounterBasedRandom::stream_type>(stream)};
     }
 
     std::vector<Vec3> getParticlePositions() const override;
@@ -94,6 +131,8 @@ public:
     std::vector<particle_type> getParticles() const override;
 
     void initializeNeighborList(scalar interactionDistance) override {
+        _neighborList->setSkin(_neighborListSkin);
+        _neighborList->setReorderInterval(_reorderInterval, _spaceFillingCurve);
         _neighborList->setUp(interactionDistance, _neighborListCellRadius);
         _neighborList->update();
     };
@@ -148,6 +187,8 @@ public:
 
     void setTime(scalar t) override {
         _observableData.time = t;
+        // the time is advanced once per time step, which gives fresh counter-based random numbers
+        ++_randomStep;
     };
 
     data_type const *const getParticleData() const {
@@ -248,12 +289,23 @@ public:
     void clear() override;
 
 private:
+    /**
+     * Keeps the particle indices of the topologies valid when the particle data is sorted.
+     */
+    void connectReorderSignal();
+
     data::ObservableData _observableData;
     std::reference_wrapper<thread_pool> _pool;
     std::reference_wrapper<const readdy::model::Context> _context;
     std::reference_wrapper<data_type> _data;
     std::unique_ptr<neighbor_list> _neighborList;
     neighbor_list::cell_radius_type _neighborListCellRadius {1};
+    scalar _neighborListSkin {0};
+    std::size_t _reorderInterval {0};
+    conf::cpu::SpaceFillingCurve _spaceFillingCurve {conf::cpu::SpaceFillingCurve::hilbert};
+    std::optional<readdy::signals::scoped_connection> _reorderConnection;
+    std::optional<readdy::model::rnd::CounterBasedRandom::seed_type> _seed;
+    readdy::model::rnd::CounterBasedRandom::step_type _randomStep {0};
     std::reference_wrapper<const readdy::model::top::TopologyActionFactory> _topologyActionFactory;
     topologies_vec _topologies{};
 };
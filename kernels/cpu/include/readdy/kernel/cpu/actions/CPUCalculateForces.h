@@ -44,7 +44,9 @@
 
 #include <readdy/model/actions/Actions.h>
 #include <readdy/kernel/cpu/CPUKernel.h>
+#include <readdy/kernel/cpu/data/BondedInteractions.h>
 #include <readdy/common/thread/barrier.h>
+#include <readdy/common/IndexWindowBuffer.h>
 
 namespace readdy {
 namespace kernel {
@@ -67,9 +69,27 @@ protected:
     static void calculateOrder2(std::size_t, nl_bounds nlBounds, CPUStateModel::data_type *data,
                                 const CPUStateModel::neighbor_list &nl, std::promise<scalar> &energyPromise,
                                 std::promise<Matrix33> &virialPromise,
-                                model::potentials::PotentialRegistry::PotentialsO2Map pot2,
+                                const model::potentials::PotentialRegistry &pot2,
                                 model::Context::BoxSize box, model::Context::PeriodicBoundaryConditions pbc);
 
+    /**
+     * Evaluates each pair in the cells of nlBounds once. Forces on both particles of a pair are accumulated into
+     * forceBuffer, which is private to the task and reduced into the particle data after all tasks have finished.
+     * The buffer only covers the particle indices the task touches.
+     */
+    template<bool COMPUTE_VIRIAL>
+    static void calculateOrder2HalfShell(std::size_t, nl_bounds nlBounds, CPUStateModel::data_type *data,
+                                         const CPUStateModel::neighbor_list &nl,
+                                         util::IndexWindowBuffer<Vec3> &forceBuffer,
+                                         std::size_t nParticles, std::promise<scalar> &energyPromise,
+                                         std::promise<Matrix33> &virialPromise,
+                                         const model::potentials::PotentialRegistry &pot2,
+                                         model::Context::BoxSize box, model::Context::PeriodicBoundaryConditions pbc);
+
+    static void reduceForceBuffers(std::size_t, std::size_t begin, std::size_t end, CPUStateModel::data_type *data,
+                                   const std::vector<util::IndexWindowBuffer<Vec3>> &forceBuffers,
+                                   std::size_t nBuffers);
+
     static void calculateTopologies(std::size_t /*tid*/, top_bounds topBounds, model::top::TopologyActionFactory *taf,
                                     std::promise<scalar> &energyPromise);
 
@@ -79,6 +99,10 @@ protected:
                                 model::potentials::PotentialRegistry::PotentialsO1Map pot1);
 
     CPUKernel *const kernel;
+    // one force buffer per order 2 task in half shell mode, kept around to avoid reallocation
+    std::vector<util::IndexWindowBuffer<Vec3>> _forceBuffers;
+    // bonded interactions of all topologies in flat form, rebuilt when the topologies change
+    data::BondedInteractions _bondedInteractions;
 };
 }
 }
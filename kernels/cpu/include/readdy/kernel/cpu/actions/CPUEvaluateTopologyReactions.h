@@ -56,6 +56,8 @@ class CPUEvaluateTopologyReactions : public readdy::model::actions::top::Evaluat
 public:
     CPUEvaluateTopologyReactions(CPUKernel* kernel, readdy::scalar timeStep);
 
+    ~CPUEvaluateTopologyReactions() override;
+
     void perform() override;
 
 private:
@@ -67,7 +69,24 @@ private:
 
     CPUKernel *const kernel;
 
-    topology_reaction_events gatherEvents();
+    // buffers which persist across time steps
+    topology_reaction_events _events;
+    std::vector<topology_reaction_events> _threadEvents;
+    // flags whether a particle type takes part in spatial topology reactions
+    std::vector<std::uint8_t> _spatialTypes;
+
+    /**
+     * Gathers the structural and spatial events of the time step, the topologies and the neighbor list cells are
+     * split among the threads, which fill their own buffers. These are appended to the events in the order of the
+     * threads.
+     * @param events the events, they are replaced
+     */
+    void gatherEvents(topology_reaction_events &events);
+
+    void gatherStructuralEvents(std::size_t topologiesBegin, std::size_t topologiesEnd,
+                                topology_reaction_events &events) const;
+
+    void gatherSpatialEvents(std::size_t cellsBegin, std::size_t cellsEnd, topology_reaction_events &events) const;
 
     bool topologyDeactivated(std::ptrdiff_t index) const;
 
@@ -0,0 +1,110 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+
+/**
+ * Detailed balance reaction handler of the CPU kernel. Reversible reactions are performed as Monte Carlo moves which
+ * are accepted with the ratio of Boltzmann weights of the states before and after, all other reactions are performed
+ * as in the Gillespie handler.
+ *
+ * @file CPUDetailedBalance.h
+ * @brief CPU kernel declaration of the detailed balance reaction handler
+ * @date 17.10.26
+ */
+
+#pragma once
+
+#include <readdy/kernel/cpu/CPUKernel.h>
+#include "ReactionUtils.h"
+
+namespace readdy {
+namespace kernel {
+namespace cpu {
+namespace actions {
+namespace reactions {
+
+class CPUDetailedBalance : public readdy::model::actions::reactions::DetailedBalance {
+    using super = readdy::model::actions::reactions::DetailedBalance;
+    using reversible_reaction = readdy::model::actions::reactions::ReversibleReactionConfig;
+    using reaction_t = readdy::model::reactions::Reaction;
+
+public:
+
+    CPUDetailedBalance(CPUKernel *kernel, readdy::scalar timeStep);
+
+    void perform() override;
+
+protected:
+    /**
+     * Gathers the events of all particles into the event buffer, each thread covers a range of particles and
+     * neighbor list cells.
+     */
+    void findEvents();
+
+    /**
+     * Calculates the energy of first-order and non-bonded second-order interactions in parallel.
+     */
+    scalar calculateEnergies();
+
+    /**
+     * Appends the update performing a reversible reaction event to the given buffers.
+     * @return the interaction energy of the educts (fusion) or products (fission) which is not contained in the energy
+     *         of the state, as the pair is not present in either of the states
+     */
+    scalar performReversibleReactionEvent(const event_t &event, const reversible_reaction *reversibleReaction,
+                                          const reaction_t *reaction, data_t::EntriesUpdate &newEntries,
+                                          std::vector<data_t::size_type> &removedEntries, record_t *record) const;
+
+    /**
+     * Appends copies of the entries which a forward update removes to the new entries of the backward update. The
+     * indices of the entries to remove in the backward update are the ones at which the forward update inserted.
+     * @param removedEntries the indices of the entries removed by the forward update
+     * @param backwardNew the new entries of the backward update
+     */
+    void generateBackwardUpdate(const std::vector<data_t::size_type> &removedEntries,
+                                data_t::EntriesUpdate &backwardNew) const;
+
+    std::pair<const reversible_reaction *, const reaction_t *> findReversibleReaction(const event_t &event) const;
+
+    CPUKernel *const kernel;
+
+    ReactionBuffers _buffers;
+    std::vector<scalar> _threadEnergies;
+};
+
+}
+}
+}
+}
+}
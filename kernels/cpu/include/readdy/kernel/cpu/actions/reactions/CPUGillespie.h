@@ -65,7 +65,24 @@ public:
     void perform() override;
 
 protected:
+    /**
+     * Divides the box into slabs along the given axis and handles the events within each slab concurrently, the
+     * events with educts in different slabs are handled afterwards.
+     * @param nDomains the number of slabs
+     * @param axis the axis
+     */
+    void performInDomains(std::size_t nDomains, std::size_t axis);
+
     CPUKernel *const kernel;
+
+    ReactionBuffers _buffers;
+    // the events gathered by each thread sorted into the domains, and the events of each domain
+    std::vector<std::vector<std::vector<event_t>>> _threadBuckets;
+    std::vector<std::vector<event_t>> _domainEvents;
+    // per-domain reaction records and counts, and the flags of educts that reacted
+    std::vector<std::vector<record_t>> _domainRecords;
+    std::vector<reaction_counts_map> _domainCounts;
+    std::vector<std::uint8_t> _touched;
 };
 }
 }
@@ -42,6 +42,7 @@
 
 #pragma once
 #include <readdy/kernel/cpu/CPUKernel.h>
+#include "ReactionUtils.h"
 
 namespace readdy {
 namespace kernel {
@@ -58,6 +59,7 @@ public:
 
 protected:
     CPUKernel *const kernel;
+    ReactionBuffers _buffers;
 };
 }
 }
@@ -43,7 +43,11 @@
  */
 
 #pragma once
+#include <atomic>
 #include <cmath>
+#include <tuple>
+#include <algorithm>
+#include <optional>
 #include <readdy/model/RandomProvider.h>
 #include <readdy/kernel/cpu/CPUKernel.h>
 #include <readdy/common/logging.h>
@@ -75,17 +79,141 @@ inline bool shouldPerformEvent(const readdy::scalar rate, const readdy::scalar t
     return approximated ? performReactionEvent<true>(rate, timestep) : performReactionEvent<false>(rate, timestep);
 }
 
-data_t::DataUpdate handleEventsGillespie(
-        CPUKernel* kernel, readdy::scalar timeStep,
-        bool filterEventsInAdvance, bool approximateRate,
-        std::vector<event_t> &&events, std::vector<record_t> *maybeRecords, reaction_counts_map *maybeCounts);
+/**
+ * Decides upon an event with a given uniform random number in (0, 1)
+ */
+inline bool shouldPerformEvent(const readdy::scalar rate, const readdy::scalar timestep, bool approximated,
+                               const readdy::scalar uniform) {
+    return uniform < (approximated ? rate * timestep : 1 - std::exp(-rate * timestep));
+}
+
+/**
+ * Decides with a single uniform random number in (0, 1) whether any of the order one reactions of a particle type
+ * occurs within the time step and which one, based on the probabilities cached in the reaction registry. The
+ * particle reacts if the number is below the probability of any of its reactions to occur, the number rescaled by
+ * that probability is then again uniform and selects a reaction proportionally to its rate.
+ * @return the index of the reaction in order1ByType or nothing if none occurs
+ */
+inline std::optional<event_t::reaction_index_type> drawOrder1Reaction(
+        const readdy::model::reactions::ReactionRegistry &registry, ParticleTypeId type, readdy::scalar uniform) {
+    const auto probability = registry.order1Probability(type);
+    if (uniform >= probability) {
+        return std::nullopt;
+    }
+    // an approximated probability may exceed one, then the particle reacts in any case
+    auto threshold = (probability < 1 ? uniform / probability : uniform) * registry.order1TotalRate(type);
+    const auto &reactions = registry.order1ByType(type);
+    std::optional<event_t::reaction_index_type> selected;
+    for (auto it = reactions.begin(); it != reactions.end(); ++it) {
+        if ((*it)->rate() > 0) {
+            selected = static_cast<event_t::reaction_index_type>(it - reactions.begin());
+            threshold -= (*it)->rate();
+            if (threshold < 0) {
+                break;
+            }
+        }
+    }
+    return selected;
+}
+
+/**
+ * Subject of the counter-based random numbers deciding upon an order one reaction event
+ */
+inline std::uint64_t eventSubject(ParticleId id, event_t::reaction_index_type reactionIndex) {
+    return readdy::model::rnd::combineSubjects(id, reactionIndex);
+}
+
+/**
+ * Subject of the counter-based random numbers deciding upon an order two reaction event, symmetric in the particles
+ */
+inline std::uint64_t eventSubject(ParticleId id1, ParticleId id2, event_t::reaction_index_type reactionIndex) {
+    const auto pair = readdy::model::rnd::combineSubjects(std::min(id1, id2), std::max(id1, id2));
+    return readdy::model::rnd::combineSubjects(pair, reactionIndex);
+}
+
+/**
+ * Draws a uniform random number in (0, 1). If the kernel is seeded, it is taken from the counter-based stream of the
+ * subject, otherwise from the thread-local generator.
+ */
+inline readdy::scalar drawUniform(const CPUStateModel &stateModel, std::uint64_t subject,
+                                  CPUStateModel::RandomStream stream) {
+    if (stateModel.seeded()) {
+        return stateModel.randomStream(subject, stream).uniform_real<readdy::scalar>();
+    }
+    return readdy::model::rnd::uniform_real<readdy::scalar>();
+}
 
+/**
+ * Brings events into an order that only depends on the particle data, so that seeded runs do not depend on the
+ * order in which the threads gathered them.
+ */
+inline void sortEvents(std::vector<event_t> &events) {
+    std::sort(events.begin(), events.end(), [](const event_t &e1, const event_t &e2) {
+        return std::tie(e1.idx1, e1.idx2, e1.nEducts, e1.reactionIndex)
+               < std::tie(e2.idx1, e2.idx2, e2.nEducts, e2.reactionIndex);
+    });
+}
+
+/**
+ * Buffers of a reaction handler which persist across time steps and are only cleared, such that time steps with few
+ * reactions do not go through the allocator.
+ */
+struct ReactionBuffers {
+    // the events gathered by each of the threads
+    std::vector<std::vector<event_t>> threadEvents;
+    // the events of the time step
+    std::vector<event_t> events;
+    // entries to insert into the particle data and indices of entries to remove from it, one pair per update
+    std::vector<data_t::EntriesUpdate> newEntries;
+    std::vector<std::vector<data_t::size_type>> removedEntries;
+    // conflict resolution of the uncontrolled approximation: claims on and flags of the particles, which only ever
+    // grow and of which only the entries touched by events are reset, and the status of each event
+    std::vector<std::atomic<std::size_t>> claims;
+    std::vector<std::uint8_t> taken;
+    std::vector<std::uint8_t> eventStatus;
+    std::vector<std::size_t> undecidedEvents;
+
+    /**
+     * Clears the buffers, keeping their capacity.
+     * @param nThreads the number of per-thread event buffers
+     * @param nUpdates the number of update buffers
+     */
+    void clear(std::size_t nThreads, std::size_t nUpdates = 1);
+
+    /**
+     * Appends the per-thread events to the events of the time step, in the order of the threads.
+     */
+    void collectThreadEvents();
+};
+
+/**
+ * Performs the events in a Gillespie fashion. Whether an event occurs is decided with the probability of its reaction
+ * as cached by ReactionRegistry::cacheProbabilities, which the calling handler has to invoke beforehand.
+ * @param events the events, they are reordered
+ * @param newEntries the particles to add are appended to it
+ * @param removedEntries the indices of the particles to remove are appended to it
+ * @param selectionSubject subject of the counter-based random stream selecting the events, handlers of disjoint
+ *        event sets which run in the same time step need different subjects
+ * @param maybeTouched if not null, the flags of the educts of performed events are set
+ */
+void handleEventsGillespie(
+        CPUKernel* kernel, bool filterEventsInAdvance, std::vector<event_t> &events, data_t::EntriesUpdate &newEntries,
+        std::vector<data_t::size_type> &removedEntries, std::vector<record_t> *maybeRecords,
+        reaction_counts_map *maybeCounts, std::uint64_t selectionSubject = 0,
+        std::vector<std::uint8_t> *maybeTouched = nullptr);
+
+/**
+ * Gathers the order one events of the given particles and the order two events of the particles in the neighbor list
+ * cells [cellsBegin, cellsEnd).
+ */
 template<typename ParticleIndexCollection>
-void gatherEvents(CPUKernel *const kernel, const ParticleIndexCollection &particles, const neighbor_list* nl,
-                  const data_t *data, readdy::scalar &alpha, std::vector<event_t> &events) {
+void gatherEvents(CPUKernel *const kernel, const ParticleIndexCollection &particles, std::size_t cellsBegin,
+                  std::size_t cellsEnd, const neighbor_list* nl, const data_t *data, readdy::scalar &alpha,
+                  std::vector<event_t> &events) {
     const auto &box = kernel->context().boxSize();
     const auto &pbc = kernel->context().periodicBoundaryConditions();
     const auto& reaction_registry = kernel->context().reactions();
+    const auto &reactionsO2 = reaction_registry.order2Table();
     for (const auto index : particles) {
         const auto &entry = data->entry_at(index);
         // this being false should really not happen, though
@@ -108,7 +236,7 @@ void gatherEvents(CPUKernel *const kernel, const ParticleIndexCollection &partic
     }
 
     // order 2
-    for(std::size_t cell = 0; cell < nl->nCells(); ++cell) {
+    for(std::size_t cell = cellsBegin; cell < cellsEnd; ++cell) {
         for(auto particleIt = nl->particlesBegin(cell); particleIt != nl->particlesEnd(cell); ++particleIt) {
             const auto &idx1 = *particleIt;
             const auto &entry = data->entry_at(idx1);
@@ -120,7 +248,7 @@ void gatherEvents(CPUKernel *const kernel, const ParticleIndexCollection &partic
                 if(idx1 > idx2) return;
                 const auto &neighbor = data->entry_at(idx2);
                 if(!neighbor.deactivated) {
-                    const auto &reactions = kernel->context().reactions().order2ByType(entry.type, neighbor.type);
+                    const auto reactions = reactionsO2(entry.type, neighbor.type);
                     if (!reactions.empty()) {
                         const auto distSquared = bcs::distSquared(neighbor.pos, entry.pos, box, pbc);
                         for (auto itReactions = reactions.begin(); itReactions < reactions.end(); ++itReactions) {
@@ -143,10 +271,16 @@ void gatherEvents(CPUKernel *const kernel, const ParticleIndexCollection &partic
     }
 }
 
+template<typename ParticleIndexCollection>
+void gatherEvents(CPUKernel *const kernel, const ParticleIndexCollection &particles, const neighbor_list* nl,
+                  const data_t *data, readdy::scalar &alpha, std::vector<event_t> &events) {
+    gatherEvents(kernel, particles, 0, nl->nCells(), nl, data, alpha, events);
+}
+
 template<typename Reaction>
 void performReaction(data_t* data, const readdy::model::Context& context, data_t::size_type idx1, data_t::size_type idx2,
                      data_t::EntriesUpdate& newEntries, std::vector<data_t::size_type>& decayedEntries,
-                     Reaction* reaction, record_t* record) {
+                     Reaction* reaction, record_t* record, const CPUStateModel &stateModel) {
 
     const auto &pbc = context.periodicBoundaryConditions().data();
     const auto &box = context.boxSize().data();
@@ -189,7 +323,13 @@ void performReaction(data_t* data, const readdy::model::Context& context, data_t
             break;
         }
         case reaction_type::Fission: {
-            auto n3 = readdy::model::rnd::normal3<readdy::scalar>(0, 1);
+            Vec3 n3;
+            if (stateModel.seeded()) {
+                auto random = stateModel.randomStream(entry1.id, CPUStateModel::RandomStream::fission);
+                n3 = random.normal3<readdy::scalar>(0, 1);
+            } else {
+                n3 = readdy::model::rnd::normal3<readdy::scalar>(0, 1);
+            }
             n3 /= std::sqrt(n3 * n3);
 
             //readdy::model::Particle p (, reaction->products()[1]);
@@ -0,0 +1,374 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+
+/**
+ * << detailed description >>
+ *
+ * @file BondedInteractions.h
+ * @brief Flat arrays of the bonds, angles and dihedrals of all topologies
+ * @date 17.10.26
+ * @copyright BSD-3
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include <readdy/common/boundary_condition_operations.h>
+#include <readdy/model/topologies/TopologyActionFactory.h>
+#include "DataContainer.h"
+
+namespace readdy::kernel::cpu::data {
+
+/**
+ * The bonds, angles and dihedrals of all topologies, packed into flat structure-of-arrays form. Each kind of
+ * interaction is sorted by the smallest particle index it involves and split into parts of equal interaction count,
+ * so that the bonded forces can be evaluated evenly across threads regardless of the sizes of the topologies. Each part
+ * accumulates its forces into a buffer with one slot per distinct particle it touches, so that the buffer is bounded
+ * by the number of interactions of the part and not by the range of particle indices they span. The buffers are added
+ * to the particle forces afterwards.
+ *
+ * The arrays are rebuilt only when the potentials of a topology changed, which is told by their revisions.
+ */
+class BondedInteractions {
+public:
+    using harmonic_bond = readdy::model::top::TopologyActionFactory::harmonic_bond;
+    using harmonic_angle = readdy::model::top::TopologyActionFactory::harmonic_angle;
+    using cos_dihedral = readdy::model::top::TopologyActionFactory::cos_dihedral;
+
+    /**
+     * Rebuilds the arrays if the potentials of any topology changed and splits them into parts.
+     * @param topologies the topologies
+     * @param nParts the number of parts
+     * @return false if a topology holds a potential which can not be packed, the arrays are unusable then
+     */
+    template<typename Topologies>
+    bool update(const Topologies &topologies, std::size_t nParts) {
+        if (outdated(topologies)) {
+            _supported = rebuild(topologies);
+            _nParts = 0;
+        }
+        if (_supported && _nParts != nParts) {
+            partition(nParts);
+        }
+        return _supported;
+    }
+
+    [[nodiscard]] std::size_t nParts() const {
+        return _nParts;
+    }
+
+    [[nodiscard]] std::size_t nBonds() const {
+        return _bondIndices.size();
+    }
+
+    [[nodiscard]] std::size_t nAngles() const {
+        return _angleIndices.size();
+    }
+
+    [[nodiscard]] std::size_t nDihedrals() const {
+        return _dihedralIndices.size();
+    }
+
+    /**
+     * Evaluates the interactions of a part, accumulating the forces into the part's buffer.
+     * @return the energy of the part's interactions
+     */
+    template<typename Container, typename PBC>
+    scalar evaluate(std::size_t part, const EntryDataContainer &data, const Container &box, const PBC &pbc) {
+        auto &buffer = _forceBuffers.at(part);
+        buffer.assign(_partParticles.at(part).size(), Vec3{0, 0, 0});
+        auto force = [&buffer](std::size_t slot) -> Vec3 & {
+            return buffer[slot];
+        };
+        auto pos = [&](std::size_t particle) -> const Vec3 & {
+            return data.entry_at(particle).pos;
+        };
+
+        scalar energy = 0;
+        for (auto i = _bondBounds[part]; i < _bondBounds[part + 1]; ++i) {
+            // like the per-topology evaluation, bonds without force constant are skipped, they do not contribute
+            // and would yield NaN forces for coinciding particles
+            if (_bondForceConstants[i] == 0) continue;
+            const auto [i1, i2] = _bondIndices[i];
+            const auto [s1, s2] = _bondSlots[i];
+            const readdy::model::top::pot::BondConfiguration bond{i1, i2, _bondForceConstants[i], _bondLengths[i]};
+            const auto x_ij = bcs::shortestDifference(pos(i1), pos(i2), box, pbc);
+            Vec3 forceUpdate{0, 0, 0};
+            _bondPotential.calculateForce(forceUpdate, x_ij, bond);
+            force(s1) += forceUpdate;
+            force(s2) -= forceUpdate;
+            energy += _bondPotential.calculateEnergy(x_ij, bond);
+        }
+        for (auto i = _angleBounds[part]; i < _angleBounds[part + 1]; ++i) {
+            const auto [i1, i2, i3] = _angleIndices[i];
+            const auto [s1, s2, s3] = _angleSlots[i];
+            const readdy::model::top::pot::AngleConfiguration angle{i1, i2, i3, _angleForceConstants[i],
+                                                                    _angleEquilibria[i]};
+            const auto x_ji = bcs::shortestDifference(pos(i2), pos(i1), box, pbc);
+            const auto x_jk = bcs::shortestDifference(pos(i2), pos(i3), box, pbc);
+            energy += _anglePotential.calculateEnergy(x_ji, x_jk, angle);
+            _anglePotential.calculateForce(force(s1), force(s2), force(s3), x_ji, x_jk, angle);
+        }
+        for (auto i = _dihedralBounds[part]; i < _dihedralBounds[part + 1]; ++i) {
+            const auto [i1, i2, i3, i4] = _dihedralIndices[i];
+            const auto [s1, s2, s3, s4] = _dihedralSlots[i];
+            const readdy::model::top::pot::DihedralConfiguration dihedral{
+                    i1, i2, i3, i4, _dihedralForceConstants[i], _dihedralMultiplicities[i], _dihedralPhases[i]};
+            const auto x_ji = bcs::shortestDifference(pos(i2), pos(i1), box, pbc);
+            const auto x_kj = bcs::shortestDifference(pos(i3), pos(i2), box, pbc);
+            const auto x_kl = bcs::shortestDifference(pos(i3), pos(i4), box, pbc);
+            energy += _dihedralPotential.calculateEnergy(x_ji, x_kj, x_kl, dihedral);
+            _dihedralPotential.calculateForce(force(s1), force(s2), force(s3), force(s4), x_ji, x_kj, x_kl,
+                                              dihedral);
+        }
+        return energy;
+    }
+
+    /**
+     * Adds the buffered forces of all parts to the particles in [begin, end). Ranges of particles can be reduced
+     * concurrently after all parts were evaluated.
+     */
+    void reduce(std::size_t begin, std::size_t end, EntryDataContainer &data) const {
+        for (std::size_t part = 0; part < _nParts; ++part) {
+            const auto &particles = _partParticles[part];
+            auto slot = static_cast<std::size_t>(
+                    std::lower_bound(particles.begin(), particles.end(), begin) - particles.begin());
+            for (; slot < particles.size() && particles[slot] < end; ++slot) {
+                data.entry_at(particles[slot]).force += _forceBuffers[part][slot];
+            }
+        }
+    }
+
+private:
+    template<typename Topologies>
+    bool outdated(const Topologies &topologies) const {
+        if (_revisions.size() != topologies.size()) {
+            return true;
+        }
+        auto it = _revisions.begin();
+        for (const auto &top : topologies) {
+            if (*it != revisionOf(*top)) {
+                return true;
+            }
+            ++it;
+        }
+        return false;
+    }
+
+    template<typename Topology>
+    static std::size_t revisionOf(const Topology &topology) {
+        // revisions start at one, so zero can stand for deactivated topologies
+        return topology.isDeactivated() ? 0 : topology.potentialsRevision();
+    }
+
+    template<typename Topologies>
+    bool rebuild(const Topologies &topologies) {
+        _revisions.clear();
+        _revisions.reserve(topologies.size());
+        _bondIndices.clear();
+        _bondForceConstants.clear();
+        _bondLengths.clear();
+        _angleIndices.clear();
+        _angleForceConstants.clear();
+        _angleEquilibria.clear();
+        _dihedralIndices.clear();
+        _dihedralForceConstants.clear();
+        _dihedralMultiplicities.clear();
+        _dihedralPhases.clear();
+
+        bool supported = true;
+        for (const auto &top : topologies) {
+            _revisions.push_back(revisionOf(*top));
+            if (top->isDeactivated()) continue;
+            for (const auto &potential : top->getBondedPotentials()) {
+                const auto *harmonic = dynamic_cast<const harmonic_bond *>(potential.get());
+                if (!harmonic) {
+                    supported = false;
+                    continue;
+                }
+                for (const auto &bond : harmonic->getBonds()) {
+                    _bondIndices.push_back({{bond.idx1, bond.idx2}});
+                    _bondForceConstants.push_back(bond.forceConstant);
+                    _bondLengths.push_back(bond.length);
+                }
+            }
+            for (const auto &potential : top->getAnglePotentials()) {
+                const auto *harmonic = dynamic_cast<const harmonic_angle *>(potential.get());
+                if (!harmonic) {
+                    supported = false;
+                    continue;
+                }
+                for (const auto &angle : harmonic->getAngles()) {
+                    _angleIndices.push_back({{angle.idx1, angle.idx2, angle.idx3}});
+                    _angleForceConstants.push_back(angle.forceConstant);
+                    _angleEquilibria.push_back(angle.equilibriumAngle);
+                }
+            }
+            for (const auto &potential : top->getTorsionPotentials()) {
+                const auto *cosine = dynamic_cast<const cos_dihedral *>(potential.get());
+                if (!cosine) {
+                    supported = false;
+                    continue;
+                }
+                for (const auto &dihedral : cosine->getDihedrals()) {
+                    _dihedralIndices.push_back({{dihedral.idx1, dihedral.idx2, dihedral.idx3, dihedral.idx4}});
+                    _dihedralForceConstants.push_back(dihedral.forceConstant);
+                    _dihedralMultiplicities.push_back(dihedral.multiplicity);
+                    _dihedralPhases.push_back(dihedral.phi_0);
+                }
+            }
+        }
+
+        sortByParticles(_bondIndices, _bondForceConstants, _bondLengths);
+        sortByParticles(_angleIndices, _angleForceConstants, _angleEquilibria);
+        sortByParticles(_dihedralIndices, _dihedralForceConstants, _dihedralMultiplicities, _dihedralPhases);
+        return supported;
+    }
+
+    /**
+     * Sorts the interactions of one kind by the smallest particle index they involve.
+     */
+    template<std::size_t N, typename... Parameters>
+    void sortByParticles(std::vector<std::array<std::size_t, N>> &indices, Parameters &... parameters) {
+        _permutation.resize(indices.size());
+        std::iota(_permutation.begin(), _permutation.end(), 0);
+        std::stable_sort(_permutation.begin(), _permutation.end(), [&indices](std::size_t i, std::size_t j) {
+            return *std::min_element(indices[i].begin(), indices[i].end())
+                   < *std::min_element(indices[j].begin(), indices[j].end());
+        });
+        auto permute = [this](auto &values) {
+            std::remove_reference_t<decltype(values)> permuted;
+            permuted.reserve(values.size());
+            for (auto i : _permutation) {
+                permuted.push_back(values[i]);
+            }
+            values = std::move(permuted);
+        };
+        permute(indices);
+        (permute(parameters), ...);
+    }
+
+    /**
+     * Splits each kind of interaction into nParts ranges of equal size, determines the distinct particles each part
+     * touches and assigns the interactions' particles to their slots in the part's buffer.
+     */
+    void partition(std::size_t nParts) {
+        auto bounds = [nParts](std::size_t n, std::vector<std::size_t> &result) {
+            result.resize(nParts + 1);
+            for (std::size_t part = 0; part <= nParts; ++part) {
+                result[part] = part * n / nParts;
+            }
+        };
+        bounds(nBonds(), _bondBounds);
+        bounds(nAngles(), _angleBounds);
+        bounds(nDihedrals(), _dihedralBounds);
+
+        _bondSlots.resize(nBonds());
+        _angleSlots.resize(nAngles());
+        _dihedralSlots.resize(nDihedrals());
+        _partParticles.resize(nParts);
+        _forceBuffers.resize(nParts);
+        for (std::size_t part = 0; part < nParts; ++part) {
+            auto &particles = _partParticles[part];
+            particles.clear();
+            auto collect = [&](const auto &indices, const std::vector<std::size_t> &partBounds) {
+                for (auto i = partBounds[part]; i < partBounds[part + 1]; ++i) {
+                    particles.insert(particles.end(), indices[i].begin(), indices[i].end());
+                }
+            };
+            collect(_bondIndices, _bondBounds);
+            collect(_angleIndices, _angleBounds);
+            collect(_dihedralIndices, _dihedralBounds);
+            std::sort(particles.begin(), particles.end());
+            particles.erase(std::unique(particles.begin(), particles.end()), particles.end());
+
+            auto assignSlots = [&](const auto &indices, auto &slots, const std::vector<std::size_t> &partBounds) {
+                for (auto i = partBounds[part]; i < partBounds[part + 1]; ++i) {
+                    for (std::size_t corner = 0; corner < indices[i].size(); ++corner) {
+                        slots[i][corner] = static_cast<std::size_t>(
+                                std::lower_bound(particles.begin(), particles.end(), indices[i][corner])
+                                - particles.begin());
+                    }
+                }
+            };
+            assignSlots(_bondIndices, _bondSlots, _bondBounds);
+            assignSlots(_angleIndices, _angleSlots, _angleBounds);
+            assignSlots(_dihedralIndices, _dihedralSlots, _dihedralBounds);
+        }
+        _nParts = nParts;
+    }
+
+    // revisions of the topologies' potentials the arrays were built from
+    std::vector<std::size_t> _revisions;
+    bool _supported{true};
+
+    std::vector<std::array<std::size_t, 2>> _bondIndices;
+    std::vector<scalar> _bondForceConstants;
+    std::vector<scalar> _bondLengths;
+
+    std::vector<std::array<std::size_t, 3>> _angleIndices;
+    std::vector<scalar> _angleForceConstants;
+    std::vector<scalar> _angleEquilibria;
+
+    std::vector<std::array<std::size_t, 4>> _dihedralIndices;
+    std::vector<scalar> _dihedralForceConstants;
+    std::vector<scalar> _dihedralMultiplicities;
+    std::vector<scalar> _dihedralPhases;
+
+    std::size_t _nParts{0};
+    std::vector<std::size_t> _bondBounds;
+    std::vector<std::size_t> _angleBounds;
+    std::vector<std::size_t> _dihedralBounds;
+    // slots of the interactions' particles in the force buffer of their part
+    std::vector<std::array<std::size_t, 2>> _bondSlots;
+    std::vector<std::array<std::size_t, 3>> _angleSlots;
+    std::vector<std::array<std::size_t, 4>> _dihedralSlots;
+    // sorted distinct particles touched by each part and the force buffers with one slot per particle
+    std::vector<std::vector<std::size_t>> _partParticles;
+    std::vector<std::vector<Vec3>> _forceBuffers;
+
+    std::vector<std::size_t> _permutation;
+
+    // the potentials only provide the expressions, the configurations are taken from the arrays
+    const harmonic_bond _bondPotential{harmonic_bond::bond_configurations{}};
+    const harmonic_angle _anglePotential{harmonic_angle::angle_configurations{}};
+    const cos_dihedral _dihedralPotential{cos_dihedral::dihedral_configurations{}};
+};
+
+}
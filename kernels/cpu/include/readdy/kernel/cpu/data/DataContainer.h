@@ -45,10 +45,13 @@
 #pragma once
 
 #include <functional>
+#include <limits>
 #include <readdy/model/Context.h>
 #include <readdy/common/thread/Config.h>
 #include <readdy/common/signals.h>
 #include <readdy/common/Utils.h>
+#include <readdy/common/ParticleIdIndex.h>
+#include <readdy/common/span.h>
 
 namespace readdy::kernel::cpu::data {
 
@@ -63,6 +66,10 @@ public:
     using DataUpdate = std::tuple<Entries, std::vector<std::size_t>>;
     using topology_index_t = std::ptrdiff_t;
     using size_type = typename Entries::size_type;
+    // receives the new index of each old index after the entries were reordered, noIndex for dropped entries
+    using reorder_signal_type = readdy::signals::signal<void(const std::vector<size_type> &)>;
+
+    static constexpr size_type noIndex = std::numeric_limits<size_type>::max();
 
     using iterator = typename Entries::iterator;
     using const_iterator = typename Entries::const_iterator;
@@ -85,6 +92,8 @@ public:
     void clear() {
         _entries.clear();
         _blanks.clear();
+        _modifiedIndices.clear();
+        _idIndex.invalidate();
     };
 
     void addParticle(const Particle &particle) {
@@ -124,14 +133,9 @@ public:
     };
 
     void removeParticle(const Particle &particle) {
-        auto it_entries = begin();
-        std::size_t idx = 0;
-        for(; it_entries != end(); ++it_entries, ++idx) {
-            if(!it_entries->deactivated && it_entries->id == particle.id()) {
-                _blanks.push_back(idx);
-                it_entries->deactivated = true;
-                return;
-            }
+        if (auto index = _idIndex.find(particle.id(), _entries)) {
+            removeParticle(*index);
+            return;
         }
         log::error("Tried to remove particle ({}) which did not exist or was already deactivated!", particle);
     };
@@ -141,6 +145,8 @@ public:
         if(!p.deactivated) {
             _blanks.push_back(index);
             p.deactivated = true;
+            _idIndex.erase(p.id, index);
+            markModified(index);
         } else {
             log::error("Tried to remove particle (index={}), that was already removed!", index);
         }
@@ -151,17 +157,16 @@ public:
         if(!entry.deactivated) {
             entry.deactivated = true;
             _blanks.push_back(index);
+            _idIndex.erase(entry.id, index);
+            markModified(index);
         } else {
             log::critical("Tried removing particle {} which was already deactivated!", index);
         }
     };
 
     size_type getIndexForId(ParticleId id) const {
-        auto find_it = std::find_if(_entries.begin(), _entries.end(), [id](const T& e) {
-            return !e.deactivated && e.id == id;
-        });
-        if(find_it != _entries.end()) {
-            return static_cast<size_type>(std::distance(_entries.begin(), find_it));
+        if (auto index = _idIndex.find(id, _entries)) {
+            return *index;
         }
         throw std::out_of_range("requested id was not to be found in particle data");
     };
@@ -210,7 +215,25 @@ public:
         return _blanks.size();
     }
 
-    virtual std::vector<size_type> update(DataUpdate &&) = 0;
+    /**
+     * Inserts the new entries, preferably into the slots of the removed ones, and removes the remaining ones.
+     * @param newEntries the entries to insert, they are moved from
+     * @param removedEntries the indices of the entries to remove
+     * @param newIndices if not null, the indices of the inserted entries are appended to it
+     */
+    virtual void update(util::span<T> newEntries, util::span<const size_type> removedEntries,
+                        std::vector<size_type> *newIndices) = 0;
+
+    /**
+     * Inserts the new entries, preferably into the slots of the removed ones, and removes the remaining ones.
+     * @return the indices of the new entries
+     */
+    std::vector<size_type> update(DataUpdate &&update) {
+        std::vector<size_type> newIndices;
+        auto &[newEntries, removedEntries] = update;
+        this->update(util::span<T>(newEntries), util::span<const size_type>(removedEntries), &newIndices);
+        return newIndices;
+    }
 
     virtual void displace(size_type entry, const Particle::Position &delta) = 0;
 
@@ -230,12 +253,66 @@ public:
         return _blanks;
     }
 
+    /**
+     * Enables or disables recording of the indices of entries which were added, replaced or removed. Neighbor lists
+     * that patch their state locally instead of rebuilding it use this to learn about reaction products.
+     * @param track whether to track modifications
+     */
+    void trackModifications(bool track) {
+        _trackModifications = track;
+        _modifiedIndices.clear();
+    }
+
+    /**
+     * The indices of entries that were modified since the last call to clearModifiedIndices(), may contain
+     * duplicates. Always empty if tracking is disabled.
+     * @return the modified indices
+     */
+    const std::vector<size_type> &modifiedIndices() const {
+        return _modifiedIndices;
+    }
+
+    void clearModifiedIndices() {
+        _modifiedIndices.clear();
+    }
+
+    /**
+     * Signal that is fired whenever the entries were permuted, e.g., by a spatial sort. Everything that keeps entry
+     * indices beyond the current time step, such as topology vertices, has to connect to it and remap its indices.
+     * @return the signal
+     */
+    reorder_signal_type &reorderSignal() {
+        return _reorderSignal;
+    }
+
 protected:
+    void markModified(size_type index) {
+        if (_trackModifications) {
+            _modifiedIndices.push_back(index);
+        }
+    }
+
+    /**
+     * Records the id of the (active) entry at index in the id index.
+     */
+    void indexEntry(size_type index) {
+        _idIndex.insert(_entries[index].id, index);
+    }
+
+
     std::reference_wrapper<const readdy::model::Context> _context;
     std::reference_wrapper<thread_pool> _pool;
 
     std::vector<size_type> _blanks {};
     Entries _entries {};
+
+    bool _trackModifications {false};
+    std::vector<size_type> _modifiedIndices {};
+
+    reorder_signal_type _reorderSignal {};
+
+    // ids -> indices for removal and lookup by id, reactions rewrite ids in place and invalidate it via update()
+    mutable util::ParticleIdIndex<size_type> _idIndex {};
 };
 
 struct Entry {
@@ -255,7 +332,7 @@ struct Entry {
 
     Entry &operator=(Entry &&) noexcept = default;
 
-    virtual ~Entry() = default;
+    ~Entry() = default;
 
     Vec3 force;
     Vec3 pos;
@@ -45,9 +45,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+
 #include <readdy/model/Particle.h>
 #include <readdy/kernel/cpu/pool.h>
 #include <readdy/common/boundary_condition_operations.h>
+#include <readdy/common/space_filling_curves.h>
+#include <readdy/common/thread/joining_future.h>
+#include <readdy/api/KernelConfiguration.h>
 #include "DataContainer.h"
 
 namespace readdy {
@@ -81,10 +87,14 @@ public:
             const auto idx = _blanks.back();
             _blanks.pop_back();
             _entries.at(idx) = std::move(entry);
+            indexEntry(idx);
+            markModified(idx);
             return idx;
         }
 
         _entries.push_back(std::move(entry));
+        indexEntry(_entries.size()-1);
+        markModified(_entries.size()-1);
         return _entries.size()-1;
     }
 
@@ -94,8 +104,12 @@ public:
                 const auto idx = _blanks.back();
                 _blanks.pop_back();
                 _entries.at(idx) = Entry(p);
+                indexEntry(idx);
+                markModified(idx);
             } else {
                 _entries.emplace_back(p);
+                indexEntry(_entries.size()-1);
+                markModified(_entries.size()-1);
             }
         }
     }
@@ -114,28 +128,39 @@ public:
                 _entries.emplace_back(p);
                 indices.push_back(_entries.size()-1);
             }
+            indexEntry(indices.back());
+            markModified(indices.back());
         }
         return indices;
     }
 
-    std::vector<size_type> update(DataUpdate &&update) override {
-        auto &&newEntries = std::move(std::get<0>(update));
-        auto &&removedEntries = std::move(std::get<1>(update));
+    using super::update;
+
+    void update(util::span<Entry> newEntries, util::span<const size_type> removedEntries,
+                std::vector<size_type> *newIndices) override {
+        // reactions change ids of the entries in place before handing over the update, so the id index is rebuilt
+        // lazily rather than patched
+        _idIndex.invalidate();
 
         auto it_del = removedEntries.begin();
-        for(auto&& newEntry : newEntries) {
+        for(auto& newEntry : newEntries) {
+            size_type index;
             if(it_del != removedEntries.end()) {
-                _entries.at(*it_del) = std::move(newEntry);
+                index = *it_del;
+                _entries.at(index) = std::move(newEntry);
+                markModified(index);
                 ++it_del;
             } else {
-                addEntry(std::move(newEntry));
+                index = addEntry(std::move(newEntry));
+            }
+            if (newIndices) {
+                newIndices->push_back(index);
             }
         }
         while(it_del != removedEntries.end()) {
             removeEntry(*it_del);
             ++it_del;
         }
-        return {};
     }
 
     void displace(size_type index, const Particle::Position &delta) override {
@@ -145,58 +170,72 @@ public:
                          _context.get().periodicBoundaryConditions().data());
     };
 
-    /*void hilbertSort(scalar gridWidth) {
-        if(!empty()) {
-            using indices_it = std::vector<std::size_t>::iterator;
-            std::vector<std::size_t> hilbert_indices;
-            std::vector<std::size_t> indices(size());
-
-            const auto grainSize = size() / _pool.get().size();
-            std::iota(indices.begin(), indices.end(), 0);
-            hilbert_indices.resize(size());
-
-            auto worker = [&](std::size_t, const_iterator begin, const_iterator end, indices_it hilbert_begin) {
-                {
-                    auto it = begin;
-                    auto hilbert_it = hilbert_begin;
-                    for (; it != end; ++it, ++hilbert_it) {
-                        if (!it->deactivated) {
-                            const auto integer_coordinates = project(it->pos, gridWidth);
-                            *hilbert_it = 1 + static_cast<std::size_t>(hilbert_c2i(3, CHAR_BIT, integer_coordinates.data()));
-                        } else {
-                            *hilbert_it = 0;
-                        }
+    /**
+     * Sorts the entries along a space-filling curve through a grid of the given width, so that particles which are
+     * close in space are also close in memory. Deactivated entries are dropped. Afterwards the reorder signal is fired
+     * with the new index of each old index.
+     * @param gridWidth the width of the grid cells, particles within the same cell are kept in their relative order
+     * @param curve the space-filling curve
+     */
+    void spatialSort(scalar gridWidth, conf::cpu::SpaceFillingCurve curve) {
+        const auto n = size();
+        const auto &boxSize = _context.get().boxSize();
+        constexpr auto maxCoordinate = (util::sfc::coordinate_type{1} << util::sfc::bitsPerDimension) - 1;
+        auto project = [&boxSize, gridWidth](const Vec3 &pos) {
+            util::sfc::coordinates_type coordinates{};
+            for (int d = 0; d < 3; ++d) {
+                // particles outside of non-periodic boxes are clamped to the outermost cells
+                const auto cell = std::floor((pos[d] + .5 * boxSize[d]) / gridWidth);
+                coordinates[d] = static_cast<util::sfc::coordinate_type>(
+                        std::clamp(cell, static_cast<scalar>(0), static_cast<scalar>(maxCoordinate)));
+            }
+            return coordinates;
+        };
+
+        // deactivated entries get the largest key and end up at the back
+        std::vector<util::sfc::index_type> keys(n);
+        {
+            auto &pool = _pool.get();
+            const auto grainSize = std::max<std::size_t>(1, n / std::max<std::size_t>(1, pool.size()));
+            auto worker = [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (auto i = begin; i < end; ++i) {
+                    const auto &entry = _entries[i];
+                    if (entry.deactivated) {
+                        keys[i] = std::numeric_limits<util::sfc::index_type>::max();
+                    } else if (curve == conf::cpu::SpaceFillingCurve::hilbert) {
+                        keys[i] = util::sfc::hilbertIndex(project(entry.pos));
+                    } else {
+                        keys[i] = util::sfc::mortonIndex(project(entry.pos));
                     }
                 }
             };
-            {
-                std::vector<util::thread::joining_future<void>> futures;
-                futures.reserve(_pool.get().size());
-                auto data_it = begin();
-                auto hilberts_it = hilbert_indices.begin();
-                for (std::size_t i = 0; i < _pool.get().size() - 1; ++i) {
-                    futures.emplace_back(_pool.get().push(worker, data_it, data_it + grainSize, hilberts_it));
-                    data_it += grainSize;
-                    hilberts_it += grainSize;
-                }
-                futures.emplace_back(_pool.get().push(worker, data_it, end(), hilberts_it));
-            }
-            {
-                std::sort(indices.begin(), indices.end(),
-                          [&hilbert_indices](std::size_t i, std::size_t j) -> bool {
-                              return hilbert_indices[i] < hilbert_indices[j];
-                          });
+            std::vector<util::thread::joining_future<void>> futures;
+            for (std::size_t begin = 0; begin < n; begin += grainSize) {
+                futures.emplace_back(pool.push(worker, begin, std::min(n, begin + grainSize)));
             }
+        }
 
-            blanks_moved_to_front();
-            std::vector<std::size_t> inverseIndices(indices.size());
-            for(std::size_t i = 0; i < indices.size(); ++i) {
-                inverseIndices[indices[i]] = i;
-            }
-            reorderSignal->fire_signal(inverseIndices);
-            readdy::util::collections::reorder_destructive(inverseIndices.begin(), inverseIndices.end(), begin());
+        std::vector<size_type> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&keys](size_type i, size_type j) {
+            return std::tie(keys[i], i) < std::tie(keys[j], j);
+        });
+
+        const auto nActive = n - _blanks.size();
+        std::vector<size_type> newIndices(n, noIndex);
+        Entries sorted;
+        sorted.reserve(nActive);
+        for (std::size_t i = 0; i < nActive; ++i) {
+            newIndices[order[i]] = i;
+            sorted.push_back(std::move(_entries[order[i]]));
         }
-    };*/
+        _entries = std::move(sorted);
+        _blanks.clear();
+        _modifiedIndices.clear();
+        _idIndex.invalidate();
+
+        _reorderSignal.fire_signal(newIndices);
+    }
 
 };
 
@@ -44,6 +44,7 @@
 #pragma once
 
 #include <cstddef>
+#include <limits>
 #include <readdy/common/Index.h>
 #include <readdy/model/Context.h>
 #include <readdy/common/thread/atomic.h>
@@ -64,6 +65,30 @@ public:
 
     void setUp(scalar cutoff, cell_radius_type radius);
 
+    /**
+     * Sets the Verlet skin. With a positive skin the cells are sized for cutoff + skin and the particle data starts
+     * recording modified indices, so that implementations can keep explicit neighbor lists across time steps.
+     * Takes effect with the next call to setUp().
+     * @param skin the skin, zero disables Verlet lists
+     */
+    void setSkin(scalar skin);
+
+    scalar skin() const {
+        return _skin;
+    };
+
+    /**
+     * Makes every interval-th call to update() sort the particle data along a space-filling curve through the cells
+     * and rebuild the list from scratch, which keeps neighbor traversal cache friendly over long simulations.
+     * @param interval the number of updates between two sorts, zero disables sorting
+     * @param curve the space-filling curve
+     */
+    void setReorderInterval(std::size_t interval, conf::cpu::SpaceFillingCurve curve) {
+        _reorderInterval = interval;
+        _reorderCurve = curve;
+        _updatesSinceReorder = 0;
+    };
+
     virtual void update() = 0;
 
     virtual void clear() = 0;
@@ -137,8 +162,13 @@ protected:
     bool _isSetUp{false};
 
     scalar _cutoff{0};
+    scalar _skin{0};
     std::uint8_t _radius;
 
+    std::size_t _reorderInterval{0};
+    conf::cpu::SpaceFillingCurve _reorderCurve{conf::cpu::SpaceFillingCurve::hilbert};
+    std::size_t _updatesSinceReorder{0};
+
     Vec3 _cellSize{0, 0, 0};
 
     util::Index3D _cellIndex;
@@ -166,13 +196,19 @@ public:
 
     CompactCellLinkedList(data_type &data, const readdy::model::Context &context, thread_pool &pool);
 
-    void update() override {
-        setUpBins();
-    };
+    void update() override;
+
+    /**
+     * Like update() but never sorts the particle data, so that indices into it stay valid. For handlers which modify
+     * the particles and update the list while holding on to particle indices.
+     */
+    void updateInPlace();
 
     void clear() override {
         _head.resize(0);
         _list.resize(0);
+        _verletLists.resize(0);
+        _verletListsValid = false;
         _isSetUp = false;
     };
 
@@ -202,27 +238,69 @@ public:
 
     template<typename Function>
     void forEachNeighbor(std::size_t particle, const Function &function) const {
-        forEachNeighbor(particle, cellOfParticle(particle), function);
+        if (_verletListsValid) {
+            std::for_each(_verletLists[particle].begin(), _verletLists[particle].end(), function);
+        } else {
+            forEachNeighbor(particle, cellOfParticle(particle), function);
+        }
     }
 
     template<typename Function>
     void forEachNeighbor(std::size_t particle, std::size_t cell, const Function &function) const;
 
+    /**
+     * Like forEachNeighbor but yields each pair only from one of its particles: in the own cell and in Verlet lists
+     * only neighbors with a larger index are visited and of the adjacent cells only the ones with a larger index.
+     * @param particle the particle
+     * @param cell the cell the particle is binned in
+     * @param function the callback, taking the neighbor index
+     */
+    template<typename Function>
+    void forEachNeighborHalf(std::size_t particle, std::size_t cell, const Function &function) const;
+
     bool cellEmpty(std::size_t index) const {
         return (*_head.at(index)).load() == 0;
     };
+
+    /**
+     * Whether explicit per-particle neighbor lists are in use, in which case forEachNeighbor yields all particles
+     * that were within cutoff + skin at the time the lists were built or patched.
+     */
+    bool verlet() const {
+        return _verletListsValid;
+    };
 protected:
+    static constexpr std::size_t noCell = std::numeric_limits<std::size_t>::max();
+
     void setUpBins() override;
 
     template<bool serial>
     void fillBins();
 
+    std::size_t cellOfPosition(const Vec3 &pos) const;
+
+    void buildVerletLists();
+
+    std::vector<std::size_t> modifiedParticles() const;
+
+    void patchVerletLists(const std::vector<std::size_t> &modified);
+
+    bool verletRebuildRequired(const std::vector<std::size_t> &modified) const;
+
     HEAD _head;
     // particles, 1-indexed
     LIST _list;
 
     bool _serial{false};
 
+    // per-particle neighbors within cutoff + skin, symmetric
+    std::vector<std::vector<std::size_t>> _verletLists;
+    // positions at the time the particle was last put into the lists
+    std::vector<Vec3> _verletPositions;
+    // the cell each particle is binned in, noCell if it is not binned
+    std::vector<std::size_t> _verletCells;
+    bool _verletListsValid{false};
+
 };
 
 class BoxIterator {
@@ -304,6 +382,10 @@ inline BoxIterator CompactCellLinkedList::particlesEnd(std::size_t /*cellIndex*/
 template<typename Function>
 inline void CompactCellLinkedList::forEachNeighbor(std::size_t particle, std::size_t cell,
                                                    const Function &function) const {
+    if (_verletListsValid) {
+        std::for_each(_verletLists[particle].begin(), _verletLists[particle].end(), function);
+        return;
+    }
     std::for_each(particlesBegin(cell), particlesEnd(cell), [&function, particle](auto x) {
         if (x != particle) function(x);
     });
@@ -312,6 +394,24 @@ inline void CompactCellLinkedList::forEachNeighbor(std::size_t particle, std::si
     }
 }
 
+template<typename Function>
+inline void CompactCellLinkedList::forEachNeighborHalf(std::size_t particle, std::size_t cell,
+                                                       const Function &function) const {
+    auto upper = [&function, particle](auto x) {
+        if (x > particle) function(x);
+    };
+    if (_verletListsValid) {
+        std::for_each(_verletLists[particle].begin(), _verletLists[particle].end(), upper);
+        return;
+    }
+    std::for_each(particlesBegin(cell), particlesEnd(cell), upper);
+    for (auto itNeighCell = neighborsBegin(cell); itNeighCell != neighborsEnd(cell); ++itNeighCell) {
+        if (*itNeighCell > cell) {
+            std::for_each(particlesBegin(*itNeighCell), particlesEnd(*itNeighCell), function);
+        }
+    }
+}
+
 }
 }
 }
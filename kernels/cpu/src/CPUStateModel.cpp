@@ -81,6 +81,19 @@ CPUStateModel::CPUStateModel(data_type &data, const readdy::model::Context &cont
                              readdy::model::top::TopologyActionFactory const *const taf)
         : _pool(pool), _context(context), _topologyActionFactory(*taf), _data(data) {
     _neighborList = std::make_unique<neighbor_list>(_data.get(), _context.get(), _pool.get());
+    connectReorderSignal();
+}
+
+void CPUStateModel::connectReorderSignal() {
+    _reorderConnection.reset();
+    auto remapTopologies = [this](const std::vector<std::size_t> &newIndices) {
+        for (auto &top : _topologies) {
+            if (!top->isDeactivated()) {
+                top->remapParticleIndices(newIndices);
+            }
+        }
+    };
+    _reorderConnection.emplace(_data.get().reorderSignal().connect(remapTopologies));
 }
 
 readdy::model::top::GraphTopology *const
@@ -43,6 +43,22 @@
 
 namespace readdy::kernel::cpu::actions {
 
+namespace {
+/**
+ * Adds forces and energies of a range of pair potentials that are within their cutoff. For ranges of the final
+ * built-in potential classes the calls are resolved at compile time and can be inlined.
+ */
+template<typename PotentialsRange>
+void evaluatePotentials(const PotentialsRange &potentials, const Vec3 &x_ij, scalar distSquared, Vec3 &force,
+                        scalar &energy) {
+    for (const auto *potential : potentials) {
+        if (distSquared < potential->getCutoffRadiusSquared()) {
+            potential->calculateForceAndEnergy(force, energy, x_ij);
+        }
+    }
+}
+}
+
 void CPUCalculateForces::perform() {
 
     const auto &ctx = kernel->context();
@@ -111,7 +127,35 @@ void CPUCalculateForces::perform() {
                                        });
                     }
                 }
-                if (!topologies.empty()) {
+                if (!topologies.empty() && ctx.kernelConfiguration().cpu.dataLayout.flatBondedInteractions
+                    && _bondedInteractions.update(topologies, nThreads)) {
+                    // equal shares of the interactions are evaluated into buffers, which are then added to the
+                    // forces of disjoint particle ranges
+                    {
+                        std::vector<util::thread::joining_future<void>> joiningFutures;
+                        joiningFutures.reserve(nThreads);
+                        for (auto part = 0_z; part < nThreads; ++part) {
+                            promises.emplace_back();
+                            joiningFutures.emplace_back(pool.push(
+                                    [&, part, &energyPromise = promises.back()](std::size_t) {
+                                        energyPromise.set_value(_bondedInteractions.evaluate(
+                                                part, *data, ctx.boxSize(), ctx.periodicBoundaryConditions()));
+                                    }));
+                        }
+                    }
+                    {
+                        std::vector<util::thread::joining_future<void>> joiningFutures;
+                        joiningFutures.reserve(nThreads);
+                        const auto grainSize = data->size() / nThreads;
+                        for (auto i = 0_z; i < nThreads; ++i) {
+                            const auto begin = i * grainSize;
+                            const auto end = i == nThreads - 1 ? data->size() : begin + grainSize;
+                            joiningFutures.emplace_back(pool.push([this, data, begin, end](std::size_t) {
+                                _bondedInteractions.reduce(begin, end, *data);
+                            }));
+                        }
+                    }
+                } else if (!topologies.empty()) {
                     std::vector<std::function<void(std::size_t)>> tasks;
                     tasks.reserve(nThreads);
                     const std::size_t grainSize = topologies.size() / nThreads;
@@ -143,49 +187,58 @@ void CPUCalculateForces::perform() {
                 if (!potOrder2.empty()) {
                     std::vector<std::function<void(std::size_t)>> tasks;
                     tasks.reserve(nThreads);
-                    auto granularity = nThreads;
-                    const std::size_t grainSize = nCells / granularity;
-                    auto it = 0_z;
-                    for (auto i = 0_z; i < granularity - 1; ++i) {
-                        auto itNext = std::min(it + grainSize, nCells);
-                        if (it != itNext) {
-                            promises.emplace_back();
-                            virialPromises.emplace_back();
-                            if(ctx.recordVirial()) {
+                    const bool halfShell = ctx.kernelConfiguration().cpu.neighborList.halfShell;
+                    const auto nParticles = data->size();
+                    if (halfShell) {
+                        _forceBuffers.resize(nThreads);
+                    }
+                    auto packOrder2 = [&](std::size_t begin, std::size_t end) {
+                        promises.emplace_back();
+                        virialPromises.emplace_back();
+                        if (halfShell) {
+                            auto &forceBuffer = _forceBuffers.at(tasks.size());
+                            if (ctx.recordVirial()) {
                                 tasks.push_back(pool.pack(
-                                        calculateOrder2<true>, std::make_tuple(it, itNext), data,
-                                        std::cref(*neighborList), std::ref(promises.back()),
-                                        std::ref(virialPromises.back()), ctx.potentials().potentialsOrder2(),
-                                        ctx.boxSize(), ctx.periodicBoundaryConditions()
+                                        calculateOrder2HalfShell<true>, std::make_tuple(begin, end), data,
+                                        std::cref(*neighborList), std::ref(forceBuffer), nParticles,
+                                        std::ref(promises.back()), std::ref(virialPromises.back()),
+                                        std::cref(ctx.potentials()), ctx.boxSize(), ctx.periodicBoundaryConditions()
                                 ));
                             } else {
                                 tasks.push_back(pool.pack(
-                                        calculateOrder2<false>, std::make_tuple(it, itNext), data,
-                                        std::cref(*neighborList), std::ref(promises.back()),
-                                        std::ref(virialPromises.back()), ctx.potentials().potentialsOrder2(),
-                                        ctx.boxSize(), ctx.periodicBoundaryConditions()
+                                        calculateOrder2HalfShell<false>, std::make_tuple(begin, end), data,
+                                        std::cref(*neighborList), std::ref(forceBuffer), nParticles,
+                                        std::ref(promises.back()), std::ref(virialPromises.back()),
+                                        std::cref(ctx.potentials()), ctx.boxSize(), ctx.periodicBoundaryConditions()
                                 ));
                             }
-                        }
-                        it = itNext;
-                    }
-                    if (it != nCells) {
-                        promises.emplace_back();
-                        virialPromises.emplace_back();
-                        if(ctx.recordVirial()) {
+                        } else if (ctx.recordVirial()) {
                             tasks.push_back(pool.pack(
-                                    calculateOrder2<true>, std::make_tuple(it, nCells), data, std::cref(*neighborList),
-                                    std::ref(promises.back()), std::ref(virialPromises.back()),
-                                    ctx.potentials().potentialsOrder2(), ctx.boxSize(), ctx.periodicBoundaryConditions()
+                                    calculateOrder2<true>, std::make_tuple(begin, end), data,
+                                    std::cref(*neighborList), std::ref(promises.back()),
+                                    std::ref(virialPromises.back()), std::cref(ctx.potentials()),
+                                    ctx.boxSize(), ctx.periodicBoundaryConditions()
                             ));
                         } else {
                             tasks.push_back(pool.pack(
-                                    calculateOrder2<false>, std::make_tuple(it, nCells), data, std::cref(*neighborList),
-                                    std::ref(promises.back()), std::ref(virialPromises.back()),
-                                    ctx.potentials().potentialsOrder2(), ctx.boxSize(), ctx.periodicBoundaryConditions()
+                                    calculateOrder2<false>, std::make_tuple(begin, end), data,
+                                    std::cref(*neighborList), std::ref(promises.back()),
+                                    std::ref(virialPromises.back()), std::cref(ctx.potentials()),
+                                    ctx.boxSize(), ctx.periodicBoundaryConditions()
                             ));
                         }
+                    };
+                    auto granularity = nThreads;
+                    const std::size_t grainSize = nCells / granularity;
+                    auto it = 0_z;
+                    for (auto i = 0_z; i < granularity; ++i) {
+                        auto itNext = i < granularity - 1 ? std::min(it + grainSize, nCells) : nCells;
+                        if (it != itNext) {
+                            packOrder2(it, itNext);
+                        }
+                        it = itNext;
                     }
+                    const auto nBuffers = tasks.size();
                     {
                         auto futures = pool.pushAll(std::move(tasks));
                         std::vector<util::thread::joining_future<void>> joiningFutures;
@@ -194,6 +247,21 @@ void CPUCalculateForces::perform() {
                                            return util::thread::joining_future<void>{std::move(future)};
                                        });
                     }
+                    if (halfShell) {
+                        // every particle range is reduced over all buffers by exactly one task
+                        std::vector<util::thread::joining_future<void>> joiningFutures;
+                        joiningFutures.reserve(nThreads);
+                        const auto reductionGrainSize = std::max(1_z, nParticles / nThreads);
+                        auto begin = 0_z;
+                        while (begin < nParticles) {
+                            const auto end = joiningFutures.size() + 1 == nThreads
+                                             ? nParticles : std::min(begin + reductionGrainSize, nParticles);
+                            joiningFutures.emplace_back(pool.push(
+                                    reduceForceBuffers, begin, end, data,
+                                    std::cref(_forceBuffers), nBuffers));
+                            begin = end;
+                        }
+                    }
                 }
             }
 
@@ -212,42 +280,41 @@ void CPUCalculateForces::perform() {
 }
 
 template<bool COMPUTE_VIRIAL>
-void CPUCalculateForces::calculateOrder2(std::size_t, nl_bounds nlBounds,
-                                         CPUStateModel::data_type *data, const CPUStateModel::neighbor_list &nl,
+void CPUCalculateForces::calculateOrder2(std::size_t, nl_bounds nlBounds, CPUStateModel::data_type *data,
+                                         const CPUStateModel::neighbor_list &nl,
                                          std::promise<scalar> &energyPromise, std::promise<Matrix33> &virialPromise,
-                                         model::potentials::PotentialRegistry::PotentialsO2Map pot2,
+                                         const model::potentials::PotentialRegistry &pot2,
                                          model::Context::BoxSize box, model::Context::PeriodicBoundaryConditions pbc) {
     scalar energyUpdate = 0.0;
     Matrix33 virialUpdate{{{0, 0, 0, 0, 0, 0, 0, 0, 0}}};
 
     for (auto cell = std::get<0>(nlBounds); cell < std::get<1>(nlBounds); ++cell) {
         for (auto particleIt = nl.particlesBegin(cell); particleIt != nl.particlesEnd(cell); ++particleIt) {
-            auto &entry = data->entry_at(*particleIt);
+            const auto particleIndex = *particleIt;
+            auto &entry = data->entry_at(particleIndex);
             if (entry.deactivated) {
                 log::critical("deactivated particle in neighbor list!");
                 continue;
             }
+            const Vec3 myPos = entry.pos;
+            const auto myType = entry.type;
+            Vec3 force{0, 0, 0};
 
-            nl.forEachNeighbor(*particleIt, cell, [&](auto neighborIndex) {
-                auto &neighbor = data->entry_at(neighborIndex);
+            nl.forEachNeighbor(particleIndex, cell, [&](auto neighborIndex) {
+                const auto &neighbor = data->entry_at(neighborIndex);
                 if (!neighbor.deactivated) {
-                    auto &force = entry.force;
-                    const auto &myPos = entry.pos;
-
                     scalar mySecondOrderEnergy = 0.;
-                    auto potit = pot2.find(std::tie(entry.type, neighbor.type));
-                    if (potit != pot2.end()) {
+                    const auto neighborType = neighbor.type;
+                    if (!pot2.potentialsOrder2Table()(myType, neighborType).empty()) {
                         auto x_ij = bcs::shortestDifference(myPos, neighbor.pos, box.data(), pbc.data());
                         auto distSquared = x_ij * x_ij;
-                        for (const auto &potential : potit->second) {
-                            if (distSquared < potential->getCutoffRadiusSquared()) {
-                                Vec3 forceUpdate{0, 0, 0};
-                                potential->calculateForceAndEnergy(forceUpdate, mySecondOrderEnergy, x_ij);
-                                force += forceUpdate;
-                                if(COMPUTE_VIRIAL && *particleIt < neighborIndex) {
-                                    virialUpdate += math::outerProduct<Matrix33>(-1.*x_ij, forceUpdate);
-                                }
-                            }
+                        Vec3 pairForce{0, 0, 0};
+                        pot2.potentialsOrder2ByClass().forEachClass(myType, neighborType, [&](const auto &range) {
+                            evaluatePotentials(range, x_ij, distSquared, pairForce, mySecondOrderEnergy);
+                        });
+                        force += pairForce;
+                        if(COMPUTE_VIRIAL && particleIndex < neighborIndex) {
+                            virialUpdate += math::outerProduct<Matrix33>(-1.*x_ij, pairForce);
                         }
                     }
 
@@ -258,13 +325,90 @@ void CPUCalculateForces::calculateOrder2(std::size_t, nl_bounds nlBounds,
                     log::critical("disabled neighbour");
                 }
             });
+            entry.force += force;
+        }
+
+    }
+
+    energyPromise.set_value(energyUpdate);
+    virialPromise.set_value(virialUpdate);
+
+}
+
+template<bool COMPUTE_VIRIAL>
+void CPUCalculateForces::calculateOrder2HalfShell(std::size_t, nl_bounds nlBounds, CPUStateModel::data_type *data,
+                                                  const CPUStateModel::neighbor_list &nl,
+                                                  util::IndexWindowBuffer<Vec3> &forceBuffer, std::size_t nParticles,
+                                                  std::promise<scalar> &energyPromise,
+                                                  std::promise<Matrix33> &virialPromise,
+                                                  const model::potentials::PotentialRegistry &pot2,
+                                                  model::Context::BoxSize box,
+                                                  model::Context::PeriodicBoundaryConditions pbc) {
+    scalar energyUpdate = 0.0;
+    Matrix33 virialUpdate{{{0, 0, 0, 0, 0, 0, 0, 0, 0}}};
+    {
+        // the window starts out covering the task's own particles and grows to the neighbors outside of it
+        auto first = nParticles;
+        std::size_t last = 0;
+        for (auto cell = std::get<0>(nlBounds); cell < std::get<1>(nlBounds); ++cell) {
+            for (auto particleIt = nl.particlesBegin(cell); particleIt != nl.particlesEnd(cell); ++particleIt) {
+                first = std::min(first, *particleIt);
+                last = std::max(last, *particleIt + 1);
+            }
         }
+        forceBuffer.reset(first, std::max(first, last), nParticles);
+    }
+
+    for (auto cell = std::get<0>(nlBounds); cell < std::get<1>(nlBounds); ++cell) {
+        for (auto particleIt = nl.particlesBegin(cell); particleIt != nl.particlesEnd(cell); ++particleIt) {
+            const auto particleIndex = *particleIt;
+            auto &entry = data->entry_at(particleIndex);
+            if (entry.deactivated) {
+                log::critical("deactivated particle in neighbor list!");
+                continue;
+            }
+            const Vec3 myPos = entry.pos;
+            const auto myType = entry.type;
+            Vec3 force{0, 0, 0};
 
+            nl.forEachNeighborHalf(particleIndex, cell, [&](auto neighborIndex) {
+                const auto &neighbor = data->entry_at(neighborIndex);
+                if (!neighbor.deactivated) {
+                    const auto neighborType = neighbor.type;
+                    if (!pot2.potentialsOrder2Table()(myType, neighborType).empty()) {
+                        auto x_ij = bcs::shortestDifference(myPos, neighbor.pos, box.data(), pbc.data());
+                        auto distSquared = x_ij * x_ij;
+                        Vec3 pairForce{0, 0, 0};
+                        pot2.potentialsOrder2ByClass().forEachClass(myType, neighborType, [&](const auto &range) {
+                            evaluatePotentials(range, x_ij, distSquared, pairForce, energyUpdate);
+                        });
+                        force += pairForce;
+                        forceBuffer[neighborIndex] -= pairForce;
+                        if (COMPUTE_VIRIAL) {
+                            virialUpdate += math::outerProduct<Matrix33>(-1.*x_ij, pairForce);
+                        }
+                    }
+                } else {
+                    log::critical("disabled neighbour");
+                }
+            });
+            forceBuffer[particleIndex] += force;
+        }
     }
 
     energyPromise.set_value(energyUpdate);
     virialPromise.set_value(virialUpdate);
+}
 
+void CPUCalculateForces::reduceForceBuffers(std::size_t, std::size_t begin, std::size_t end,
+                                            CPUStateModel::data_type *data,
+                                            const std::vector<util::IndexWindowBuffer<Vec3>> &forceBuffers,
+                                            std::size_t nBuffers) {
+    for (auto b = 0_z; b < nBuffers; ++b) {
+        forceBuffers[b].forEachIn(begin, end, [data](std::size_t i, const Vec3 &force) {
+            data->entry_at(i).force += force;
+        });
+    }
 }
 
 void CPUCalculateForces::calculateTopologies(std::size_t, top_bounds topBounds,
@@ -275,15 +419,15 @@ void CPUCalculateForces::calculateTopologies(std::size_t, top_bounds topBounds,
         const auto &top = *it;
         if (!top->isDeactivated()) {
             for (const auto &bondedPot : top->getBondedPotentials()) {
-                auto energy = bondedPot->createForceAndEnergyAction(taf)->perform(top.get());
+                auto energy = bondedPot->forceAndEnergyAction(taf)->perform(top.get());
                 energyUpdate += energy;
             }
             for (const auto &anglePot : top->getAnglePotentials()) {
-                auto energy = anglePot->createForceAndEnergyAction(taf)->perform(top.get());
+                auto energy = anglePot->forceAndEnergyAction(taf)->perform(top.get());
                 energyUpdate += energy;
             }
             for (const auto &torsionPot : top->getTorsionPotentials()) {
-                auto energy = torsionPot->createForceAndEnergyAction(taf)->perform(top.get());
+                auto energy = torsionPot->forceAndEnergyAction(taf)->perform(top.get());
                 energyUpdate += energy;
             }
         }
@@ -52,6 +52,7 @@ namespace actions {
 namespace rnd = readdy::model::rnd;
 
 void CPUEulerBDIntegrator::perform() {
+    const auto &stateModel = kernel->getCPUKernelStateModel();
     auto data = kernel->getCPUKernelStateModel().getParticleData();
     const auto size = data->size();
 
@@ -60,15 +61,32 @@ void CPUEulerBDIntegrator::perform() {
 
     const auto dt = timeStep();
 
-    auto worker = [&context, data, dt](std::size_t, std::size_t beginIdx, iter_t entry_begin, iter_t entry_end)  {
+    auto worker = [&context, &stateModel, data, dt](std::size_t, std::size_t beginIdx,
+                                                    iter_t entry_begin, iter_t entry_end)  {
+        const auto seeded = stateModel.seeded();
         const auto kbt = context.kBT();
         std::size_t idx = beginIdx;
         const auto &box = context.boxSize().data();
         const auto &pbc = context.periodicBoundaryConditions().data();
+        // without a seed the noise is drawn in blocks, which uses both numbers of each generated pair
+        std::array<scalar, 3 * 64> noiseBlock;
+        auto nextNoise = noiseBlock.size();
         for (auto it = entry_begin; it != entry_end; ++it, ++idx) {
             if(!it->deactivated) {
                 const scalar D = context.particleTypes().diffusionConstantOf(it->type);
-                const auto randomDisplacement = std::sqrt(2. * D * dt) * rnd::normal3<readdy::scalar>(0, 1);
+                Vec3 noise;
+                if (seeded) {
+                    auto random = stateModel.randomStream(it->id, CPUStateModel::RandomStream::integrator);
+                    noise = random.normal3<readdy::scalar>(0, 1);
+                } else {
+                    if (nextNoise == noiseBlock.size()) {
+                        rnd::fillNormal<readdy::scalar>(noiseBlock.begin(), noiseBlock.end(), 0, 1);
+                        nextNoise = 0;
+                    }
+                    noise = {noiseBlock[nextNoise], noiseBlock[nextNoise + 1], noiseBlock[nextNoise + 2]};
+                    nextNoise += 3;
+                }
+                const auto randomDisplacement = std::sqrt(2. * D * dt) * noise;
                 const auto deterministicDisplacement = it->force * dt * D / kbt;
                 it->pos += randomDisplacement + deterministicDisplacement;
                 bcs::fixPosition(it->pos, box, pbc);
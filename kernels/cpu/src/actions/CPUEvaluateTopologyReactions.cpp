@@ -43,23 +43,24 @@
  * @copyright BSD-3
  */
 
+#include <optional>
+#include <tuple>
+
 #include <readdy/kernel/cpu/actions/CPUEvaluateTopologyReactions.h>
 #include <readdy/common/algorithm.h>
 #include <readdy/model/actions/Utils.h>
 
 namespace readdy::kernel::cpu::actions::top {
 
-CPUEvaluateTopologyReactions::CPUEvaluateTopologyReactions(CPUKernel *const kernel, scalar timeStep)
-        : EvaluateTopologyReactions(timeStep), kernel(kernel) {}
-
 /**
  * Struct holding information about a topology reaction event.
  */
 struct CPUEvaluateTopologyReactions::TREvent {
     using index_type = CPUStateModel::data_type::size_type;
 
-    rate_t cumulativeRate{0};
     rate_t rate{0};
+    // probability of the event to occur within the time step if cached for its reaction, negative otherwise
+    scalar probability{-1};
     std::size_t topology_idx{0};
     // for topology-topology fusion only
     std::ptrdiff_t topology_idx2{-1};
@@ -69,21 +70,15 @@ struct CPUEvaluateTopologyReactions::TREvent {
     // idx1 is always the particle that belongs to a topology
     index_type idx1{0}, idx2{0};
     bool spatial{false};
+    // the rate is given by a user function of the two topologies, it is evaluated after gathering
+    bool rateFunction{false};
     ReactionId reactionId{0};
 };
 
-template<bool approximated>
-bool performReactionEvent(scalar rate, scalar timeStep);
-
-template<>
-bool performReactionEvent<true>(const scalar rate, const scalar timeStep) {
-    return readdy::model::rnd::uniform_real() < rate * timeStep;
-}
+CPUEvaluateTopologyReactions::CPUEvaluateTopologyReactions(CPUKernel *const kernel, scalar timeStep)
+        : EvaluateTopologyReactions(timeStep), kernel(kernel) {}
 
-template<>
-bool performReactionEvent<false>(const scalar rate, const scalar timeStep) {
-    return readdy::model::rnd::uniform_real() < 1 - std::exp(-rate * timeStep);
-}
+CPUEvaluateTopologyReactions::~CPUEvaluateTopologyReactions() = default;
 
 void CPUEvaluateTopologyReactions::perform() {
     auto &model = kernel->getCPUKernelStateModel();
@@ -95,20 +90,63 @@ void CPUEvaluateTopologyReactions::perform() {
     }
 
     if (!topologies.empty()) {
+        kernel->context().topologyRegistry().cacheProbabilities(timeStep(), false);
 
-        auto events = gatherEvents();
+        auto &events = _events;
+        gatherEvents(events);
 
         if (!events.empty()) {
 
             std::vector<readdy::model::top::GraphTopology> new_topologies;
 
             {
-                auto shouldEval = [this](const TREvent &event) {
-                    return performReactionEvent<false>(event.rate, timeStep());
+                std::optional<readdy::model::rnd::CounterBasedRandom> selection;
+                if (model.seeded()) {
+                    // spatial events are gathered through the neighbor list, bring them into a fixed order
+                    std::sort(events.begin(), events.end(), [](const TREvent &e1, const TREvent &e2) {
+                        return std::tie(e1.topology_idx, e1.topology_idx2, e1.spatial, e1.reaction_idx,
+                                        e1.idx1, e1.idx2)
+                               < std::tie(e2.topology_idx, e2.topology_idx2, e2.spatial, e2.reaction_idx,
+                                          e2.idx1, e2.idx2);
+                    });
+                    selection = model.randomStream(0, CPUStateModel::RandomStream::topologyEventSelection);
+                }
+                auto probabilityOf = [this](const TREvent &event) {
+                    return event.probability >= 0 ? event.probability : 1 - std::exp(-event.rate * timeStep());
+                };
+                auto shouldEval = [&model, &probabilityOf](const TREvent &event) {
+                    if (!model.seeded()) {
+                        return readdy::model::rnd::uniform_real<scalar>() < probabilityOf(event);
+                    }
+                    namespace rnd = readdy::model::rnd;
+                    auto subject = rnd::combineSubjects(event.topology_idx, event.reactionId);
+                    if (event.spatial) {
+                        const auto &data = *model.getParticleData();
+                        const auto pair = rnd::combineSubjects(data.entry_at(event.idx1).id,
+                                                               data.entry_at(event.idx2).id);
+                        subject = rnd::combineSubjects(subject, pair);
+                    }
+                    auto random = model.randomStream(subject, CPUStateModel::RandomStream::topologyReactions);
+                    return random.uniform_real<scalar>() < probabilityOf(event);
+                };
+                auto draw = [&selection](scalar cumulativeRate) {
+                    if (selection) {
+                        return selection->uniform_real<scalar>(0., cumulativeRate);
+                    }
+                    return readdy::model::rnd::uniform_real<scalar>(0., cumulativeRate);
                 };
                 auto depending = [this](const TREvent &e1, const TREvent &e2) {
                     return eventsDependent(e1, e2);
                 };
+                // topologies and particles involved in an event, any two dependent events share one of these
+                auto dependencyKeys = [](const TREvent &event, const auto &key) {
+                    key(2 * event.topology_idx);
+                    if (event.topology_idx2 >= 0) {
+                        key(2 * static_cast<std::size_t>(event.topology_idx2));
+                    } else {
+                        key(2 * event.idx2 + 1);
+                    }
+                };
                 auto eval = [&](const TREvent &event) {
                     auto &topology = topologies.at(event.topology_idx);
                     if (topology->isDeactivated()) {
@@ -153,7 +191,8 @@ void CPUEvaluateTopologyReactions::perform() {
                         }
                     }
                 };*/
-                algo::performEvents(events, shouldEval, depending, eval);
+                algo::performEvents(events, shouldEval, depending, eval,
+                                    algo::detail::noPostPerform<topology_reaction_events>, draw, dependencyKeys);
             }
 
             if (!new_topologies.empty()) {
@@ -194,144 +233,197 @@ void CPUEvaluateTopologyReactions::handleStructuralReactionEvent(CPUStateModel::
                                                            kernel);
 }
 
-CPUEvaluateTopologyReactions::topology_reaction_events CPUEvaluateTopologyReactions::gatherEvents() {
-    topology_reaction_events events;
-    const auto &topology_types = kernel->context().topologyRegistry();
+void CPUEvaluateTopologyReactions::gatherEvents(topology_reaction_events &events) {
+    const auto &context = kernel->context();
+    const auto &topologies = kernel->getCPUKernelStateModel().topologies();
+    const auto &nl = *kernel->getCPUKernelStateModel().getNeighborList();
+    const auto gatherSpatial = !context.topologyRegistry().spatialReactionRegistry().empty();
+
+    // dense lookup of the particle types taking part in spatial topology reactions, so that pairs without any
+    // reaction are skipped before the reactions are looked up by the types of particles and topologies
+    _spatialTypes.assign(context.particleTypes().nTypes(), 0);
+    for (ParticleTypeId type = 0; type < _spatialTypes.size(); ++type) {
+        _spatialTypes[type] = context.topologyRegistry().isSpatialReactionType(type) ? 1 : 0;
+    }
+
+    const auto nThreads = static_cast<std::size_t>(kernel->getNThreads());
+    _threadEvents.resize(nThreads);
     {
-        rate_t current_cumulative_rate = 0;
-        std::size_t topology_idx = 0;
-        for (auto &top : kernel->getCPUKernelStateModel().topologies()) {
-            if (!top->isDeactivated()) {
-                std::size_t reaction_idx = 0;
-                for (const auto &reaction : topology_types.structuralReactionsOf(top->type())) {
-                    TREvent event{};
-                    event.reactionId = reaction.id();
-                    event.rate = top->rates().at(reaction_idx);
-                    event.cumulativeRate = event.rate + current_cumulative_rate;
-                    current_cumulative_rate = event.cumulativeRate;
-                    event.topology_idx = topology_idx;
-                    event.reaction_idx = reaction_idx;
-
-                    events.push_back(event);
-                    ++reaction_idx;
+        auto &pool = kernel->pool();
+        std::vector<util::thread::joining_future<void>> futures;
+        futures.reserve(nThreads);
+        const auto topologiesGrain = topologies.size() / nThreads;
+        const auto cellsGrain = nl.nCells() / nThreads;
+        for (std::size_t t = 0; t < nThreads; ++t) {
+            const auto topologiesBegin = t * topologiesGrain;
+            const auto topologiesEnd = t == nThreads - 1 ? topologies.size() : topologiesBegin + topologiesGrain;
+            const auto cellsBegin = t * cellsGrain;
+            const auto cellsEnd = t == nThreads - 1 ? nl.nCells() : cellsBegin + cellsGrain;
+            futures.emplace_back(pool.push([&, t, topologiesBegin, topologiesEnd, cellsBegin, cellsEnd](std::size_t) {
+                auto &threadEvents = _threadEvents[t];
+                threadEvents.clear();
+                gatherStructuralEvents(topologiesBegin, topologiesEnd, threadEvents);
+                if (gatherSpatial) {
+                    gatherSpatialEvents(cellsBegin, cellsEnd, threadEvents);
                 }
+            }));
+        }
+    }
+
+    std::size_t nEvents = 0;
+    for (const auto &threadEvents : _threadEvents) {
+        nEvents += threadEvents.size();
+    }
+    events.clear();
+    events.reserve(nEvents);
+    for (const auto &threadEvents : _threadEvents) {
+        events.insert(events.end(), threadEvents.begin(), threadEvents.end());
+    }
+
+    // rate functions may be implemented in python and acquire the GIL, which the thread that performs this action
+    // might hold while it waits for the pool, hence they are only called here
+    for (auto &event : events) {
+        if (event.rateFunction) {
+            const auto &top1 = *topologies.at(event.topology_idx);
+            const auto &top2 = *topologies.at(static_cast<std::size_t>(event.topology_idx2));
+            const auto &reaction = context.topologyRegistry().spatialReactionsByType(
+                    event.t1, top1.type(), event.t2, top2.type()).at(event.reaction_idx);
+            event.rate = reaction.rate(top1, top2);
+        }
+    }
+}
+
+void CPUEvaluateTopologyReactions::gatherStructuralEvents(std::size_t topologiesBegin, std::size_t topologiesEnd,
+                                                          topology_reaction_events &events) const {
+    const auto &topology_types = kernel->context().topologyRegistry();
+    const auto &topologies = kernel->getCPUKernelStateModel().topologies();
+    for (auto topology_idx = topologiesBegin; topology_idx < topologiesEnd; ++topology_idx) {
+        const auto &top = topologies.at(topology_idx);
+        if (!top->isDeactivated()) {
+            std::size_t reaction_idx = 0;
+            for (const auto &reaction : topology_types.structuralReactionsOf(top->type())) {
+                TREvent event{};
+                event.reactionId = reaction.id();
+                event.rate = top->rates().at(reaction_idx);
+                event.topology_idx = topology_idx;
+                event.reaction_idx = reaction_idx;
+
+                events.push_back(event);
+                ++reaction_idx;
             }
-            ++topology_idx;
         }
+    }
+}
 
-        const auto &context = kernel->context();
-
-        static const CPUStateModel::topology_ref EMPTY_TOP{};
-
-        if (!context.topologyRegistry().spatialReactionRegistry().empty()) {
-            const auto &model = kernel->getCPUKernelStateModel();
-            const auto &top_registry = context.topologyRegistry();
-            const auto &box = context.boxSize().data();
-            const auto &pbc = context.periodicBoundaryConditions().data();
-            const auto &data = *kernel->getCPUKernelStateModel().getParticleData();
-            const auto &nl = *kernel->getCPUKernelStateModel().getNeighborList();
-            const auto &topologies = kernel->getCPUKernelStateModel().topologies();
-
-            for (std::size_t cell = 0; cell < nl.nCells(); ++cell) {
-                for (auto itParticle = nl.particlesBegin(cell); itParticle != nl.particlesEnd(cell); ++itParticle) {
-                    const auto &entry = data.entry_at(*itParticle);
-                    if (!entry.deactivated && top_registry.isSpatialReactionType(entry.type)) {
-                        const auto entryTopologyDeactivated = topologyDeactivated(entry.topology_index);
-                        const auto hasEntryTop = entry.topology_index >= 0 && !entryTopologyDeactivated;
-
-                        nl.forEachNeighbor(*itParticle, cell, [&](std::size_t neighborIndex) {
-                            const auto &neighbor = data.entry_at(neighborIndex);
-                            const auto neighborTopDeactivated = topologyDeactivated(neighbor.topology_index);
-                            const auto hasNeighborTop = neighbor.topology_index >= 0 && !neighborTopDeactivated;
-                            if ((!hasEntryTop && !hasNeighborTop) || (hasNeighborTop && *itParticle > neighborIndex)) {
-                                // use symmetry or skip entirely
-                                return;
+void CPUEvaluateTopologyReactions::gatherSpatialEvents(std::size_t cellsBegin, std::size_t cellsEnd,
+                                                       topology_reaction_events &events) const {
+    const auto &context = kernel->context();
+    const auto &top_registry = context.topologyRegistry();
+    const auto &box = context.boxSize().data();
+    const auto &pbc = context.periodicBoundaryConditions().data();
+    const auto &data = *kernel->getCPUKernelStateModel().getParticleData();
+    const auto &nl = *kernel->getCPUKernelStateModel().getNeighborList();
+    const auto &topologies = kernel->getCPUKernelStateModel().topologies();
+    const auto &spatialTypes = _spatialTypes;
+
+    for (auto cell = cellsBegin; cell < cellsEnd; ++cell) {
+        for (auto itParticle = nl.particlesBegin(cell); itParticle != nl.particlesEnd(cell); ++itParticle) {
+            const auto &entry = data.entry_at(*itParticle);
+            if (!entry.deactivated && spatialTypes[entry.type]) {
+                const auto entryTopologyDeactivated = topologyDeactivated(entry.topology_index);
+                const auto hasEntryTop = entry.topology_index >= 0 && !entryTopologyDeactivated;
+
+                nl.forEachNeighbor(*itParticle, cell, [&](std::size_t neighborIndex) {
+                    const auto &neighbor = data.entry_at(neighborIndex);
+                    if (!spatialTypes[neighbor.type]) {
+                        // no spatial topology reaction involves this pair of particles
+                        return;
+                    }
+                    const auto neighborTopDeactivated = topologyDeactivated(neighbor.topology_index);
+                    const auto hasNeighborTop = neighbor.topology_index >= 0 && !neighborTopDeactivated;
+                    if ((!hasEntryTop && !hasNeighborTop) || (hasNeighborTop && *itParticle > neighborIndex)) {
+                        // use symmetry or skip entirely
+                        return;
+                    }
+                    TopologyTypeId tt1 = hasEntryTop ? topologies.at(
+                            static_cast<std::size_t>(entry.topology_index))->type()
+                                                     : static_cast<TopologyTypeId>(-1);
+                    TopologyTypeId tt2 = hasNeighborTop ? topologies.at(
+                            static_cast<std::size_t>(neighbor.topology_index))->type()
+                                                        : static_cast<TopologyTypeId>(-1);
+
+                    const auto distSquared = bcs::distSquared(entry.pos, neighbor.pos, box, pbc);
+                    std::size_t reaction_index = 0;
+                    const auto &reactions = top_registry.spatialReactionsByType(entry.type, tt1,
+                                                                                neighbor.type, tt2);
+                    for (const auto &reaction : reactions) {
+                        if (!reaction.allow_self_connection() &&
+                            entry.topology_index == neighbor.topology_index) {
+                            ++reaction_index;
+                            continue;
+                        }
+                        if (distSquared < reaction.radius() * reaction.radius()) {
+                            TREvent event{};
+                            event.reactionId = reaction.id();
+                            if (hasEntryTop && !hasNeighborTop) {
+                                // entry is a topology, neighbor an ordinary particle
+                                event.topology_idx = static_cast<std::size_t>(entry.topology_index);
+                                event.t1 = entry.type;
+                                event.t2 = neighbor.type;
+                                event.idx1 = *itParticle;
+                                event.idx2 = neighborIndex;
+                                event.rate = reaction.rate();
+                                event.probability = reaction.probability();
+                            } else if (!hasEntryTop && hasNeighborTop) {
+                                // neighbor is a topology, entry an ordinary particle
+                                event.topology_idx = static_cast<std::size_t>(neighbor.topology_index);
+                                event.t1 = neighbor.type;
+                                event.t2 = entry.type;
+                                event.idx1 = neighborIndex;
+                                event.idx2 = *itParticle;
+                                event.rate = reaction.rate();
+                                event.probability = reaction.probability();
+                            } else if (hasEntryTop && hasNeighborTop) {
+                                // this is a topology-topology fusion
+                                event.topology_idx = static_cast<std::size_t>(entry.topology_index);
+                                event.topology_idx2 = static_cast<std::size_t>(neighbor.topology_index);
+                                event.t1 = entry.type;
+                                event.t2 = neighbor.type;
+                                event.idx1 = *itParticle;
+                                event.idx2 = neighborIndex;
+                                if (reaction.rateIsConstant()) {
+                                    event.rate = reaction.rate();
+                                } else {
+                                    event.rateFunction = true;
+                                }
+                            } else {
+                                log::critical("got no topology for topology-fusion");
                             }
-                            TopologyTypeId tt1 = hasEntryTop ? topologies.at(
-                                    static_cast<std::size_t>(entry.topology_index))->type()
-                                                             : static_cast<TopologyTypeId>(-1);
-                            TopologyTypeId tt2 = hasNeighborTop ? topologies.at(
-                                    static_cast<std::size_t>(neighbor.topology_index))->type()
-                                                                : static_cast<TopologyTypeId>(-1);
-
-                            const auto distSquared = bcs::distSquared(entry.pos, neighbor.pos, box, pbc);
-                            std::size_t reaction_index = 0;
-                            const auto &otherTop = hasNeighborTop ? model.topologies().at(
-                                    static_cast<std::size_t>(neighbor.topology_index)
-                            ) : EMPTY_TOP;
-                            const auto &reactions = top_registry.spatialReactionsByType(entry.type, tt1,
-                                                                                        neighbor.type, tt2);
-                            for (const auto &reaction : reactions) {
-                                if (!reaction.allow_self_connection() &&
-                                    entry.topology_index == neighbor.topology_index) {
+                            if (reaction.allow_self_connection() &&
+                                entry.topology_index == neighbor.topology_index) {
+                                const auto &topol = topologies.at(
+                                        static_cast<std::size_t>(neighbor.topology_index));
+                                // auto topol = topologies.at(event.topology_idx);
+                                const readdy::model::top::Graph &gr = topol->graph();
+                                const auto &v1 = topol->vertexIteratorForParticle(event.idx1);
+                                const auto &v2 = topol->vertexIteratorForParticle(event.idx2);
+                                auto d = gr.graphDistance(v1, v2);
+                                if (d != -1 && d <= reaction.min_graph_distance()) {
                                     ++reaction_index;
                                     continue;
                                 }
-                                if (distSquared < reaction.radius() * reaction.radius()) {
-                                    TREvent event{};
-                                    event.reactionId = reaction.id();
-                                    current_cumulative_rate = event.cumulativeRate;
-                                    if (hasEntryTop && !hasNeighborTop) {
-                                        // entry is a topology, neighbor an ordinary particle
-                                        event.topology_idx = static_cast<std::size_t>(entry.topology_index);
-                                        event.t1 = entry.type;
-                                        event.t2 = neighbor.type;
-                                        event.idx1 = *itParticle;
-                                        event.idx2 = neighborIndex;
-                                        event.rate = reaction.rate();
-                                        event.cumulativeRate = event.rate + current_cumulative_rate;
-                                    } else if (!hasEntryTop && hasNeighborTop) {
-                                        // neighbor is a topology, entry an ordinary particle
-                                        event.topology_idx = static_cast<std::size_t>(neighbor.topology_index);
-                                        event.t1 = neighbor.type;
-                                        event.t2 = entry.type;
-                                        event.idx1 = neighborIndex;
-                                        event.idx2 = *itParticle;
-                                        event.rate = reaction.rate();
-                                        event.cumulativeRate = event.rate + current_cumulative_rate;
-                                    } else if (hasEntryTop && hasNeighborTop) {
-                                        // this is a topology-topology fusion
-                                        event.topology_idx = static_cast<std::size_t>(entry.topology_index);
-                                        event.topology_idx2 = static_cast<std::size_t>(neighbor.topology_index);
-                                        event.t1 = entry.type;
-                                        event.t2 = neighbor.type;
-                                        event.idx1 = *itParticle;
-                                        event.idx2 = neighborIndex;event.rate = reaction.rate(
-                                                *topologies.at(event.topology_idx),
-                                                *topologies.at(event.topology_idx2)
-                                        );
-                                        event.cumulativeRate = event.rate + current_cumulative_rate;
-                                    } else {
-                                        log::critical("got no topology for topology-fusion");
-                                    }
-                                    if (reaction.allow_self_connection() &&
-                                        entry.topology_index == neighbor.topology_index) {
-                                        const auto &topol = model.topologies().at(
-                                                static_cast<std::size_t>(neighbor.topology_index));
-                                        // auto topol = topologies.at(event.topology_idx);
-                                        const readdy::model::top::Graph &gr = topol->graph();
-                                        const auto &v1 = topol->vertexIteratorForParticle(event.idx1);
-                                        const auto &v2 = topol->vertexIteratorForParticle(event.idx2);
-                                        auto d = gr.graphDistance(v1, v2);
-                                        if (d != -1 && d <= reaction.min_graph_distance()) {
-                                            ++reaction_index;
-                                            continue;
-                                        }
-                                    }
-                                    event.reaction_idx = reaction_index;
-                                    event.spatial = true;
-
-                                    events.push_back(event);
-                                }
-                                ++reaction_index;
                             }
-                        });
+                            event.reaction_idx = reaction_index;
+                            event.spatial = true;
+
+                            events.push_back(event);
+                        }
+                        ++reaction_index;
                     }
-                }
+                });
             }
         }
     }
-    return events;
 }
 
 void CPUEvaluateTopologyReactions::handleTopologyParticleReaction(CPUStateModel::topology_ref &topology,
@@ -0,0 +1,455 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+
+/**
+ * @file CPUDetailedBalance.cpp
+ * @brief CPU kernel implementation of the detailed balance reaction handler
+ * @date 17.10.26
+ */
+
+#include <readdy/kernel/cpu/actions/reactions/CPUDetailedBalance.h>
+
+#include <numeric>
+#include <optional>
+
+#include <readdy/common/algorithm.h>
+#include <readdy/common/range.h>
+
+namespace readdy {
+namespace kernel {
+namespace cpu {
+namespace actions {
+namespace reactions {
+
+CPUDetailedBalance::CPUDetailedBalance(CPUKernel *kernel, readdy::scalar timeStep) : super(timeStep), kernel(kernel) {
+    searchReversibleReactions(kernel->context());
+}
+
+void CPUDetailedBalance::perform() {
+    const auto &ctx = kernel->context();
+    if (ctx.reactions().nOrder1() == 0 && ctx.reactions().nOrder2() == 0) {
+        return;
+    }
+    auto &stateModel = kernel->getCPUKernelStateModel();
+    auto data = stateModel.getParticleData();
+    auto nl = stateModel.getNeighborList();
+    const auto recordReactions = ctx.recordReactionsWithPositions();
+    const auto recordCounts = ctx.recordReactionCounts();
+    const auto &box = ctx.boxSize().data();
+    const auto &pbc = ctx.periodicBoundaryConditions().data();
+
+    if (recordCounts) {
+        stateModel.resetReactionCounts();
+    }
+    if (recordReactions) {
+        stateModel.reactionRecords().clear();
+    }
+    kernel->context().reactions().cacheProbabilities(timeStep(), false);
+
+    _buffers.clear(static_cast<std::size_t>(kernel->getNThreads()), 2);
+    findEvents();
+    auto &events = _buffers.events;
+    // forward and backward update of the current event
+    auto &forwardNew = _buffers.newEntries[0];
+    auto &forwardRemoved = _buffers.removedEntries[0];
+    auto &backwardNew = _buffers.newEntries[1];
+    auto &backwardRemoved = _buffers.removedEntries[1];
+
+    std::optional<readdy::model::rnd::CounterBasedRandom> selection;
+    if (stateModel.seeded()) {
+        sortEvents(events);
+        selection = stateModel.randomStream(0, CPUStateModel::RandomStream::eventSelection);
+    }
+
+    // the subject of the random numbers deciding upon the event, it is taken before the educts are replaced
+    auto subjectOf = [&](const event_t &event) {
+        const auto &entry1 = data->entry_at(event.idx1);
+        if (event.nEducts == 1) {
+            return eventSubject(entry1.id, event.reactionIndex);
+        }
+        return eventSubject(entry1.id, data->entry_at(event.idx2).id, event.reactionIndex);
+    };
+
+    auto shouldEval = [&](const event_t &event) {
+        const auto stream = event.nEducts == 1 ? CPUStateModel::RandomStream::reactionsOrder1
+                                               : CPUStateModel::RandomStream::reactionsOrder2;
+        const auto *reaction = event.nEducts == 1
+                               ? ctx.reactions().order1ByType(event.t1)[event.reactionIndex]
+                               : ctx.reactions().order2Table()(event.t1, event.t2)[event.reactionIndex];
+        return drawUniform(stateModel, subjectOf(event), stream) < reaction->probability();
+    };
+
+    auto draw = [&](scalar cumulativeRate) {
+        if (selection) {
+            return selection->uniform_real<scalar>(0., cumulativeRate);
+        }
+        return readdy::model::rnd::uniform_real<scalar>(0., cumulativeRate);
+    };
+
+    auto depending = [&](const event_t &e1, const event_t &e2) {
+        return (e1.idx1 == e2.idx1 || (e2.nEducts == 2 && e1.idx1 == e2.idx2)
+                || (e1.nEducts == 2 && (e1.idx2 == e2.idx1 || (e2.nEducts == 2 && e1.idx2 == e2.idx2))));
+    };
+
+    auto dependencyKeys = [](const event_t &event, const auto &key) {
+        key(event.idx1);
+        if (event.nEducts == 2) {
+            key(event.idx2);
+        }
+    };
+
+    auto eval = [&](const event_t &event) {
+        const auto [revReaction, reaction] = findReversibleReaction(event);
+
+        if (revReaction != nullptr) {
+            // Monte Carlo move: perform the reaction and roll it back if the move is rejected
+            const auto energyBefore = stateModel.energy();
+            const auto subject = subjectOf(event);
+
+            record_t record;
+            forwardNew.clear();
+            forwardRemoved.clear();
+            const auto interactionEnergy = performReversibleReactionEvent(
+                    event, revReaction, reaction, forwardNew, forwardRemoved, recordReactions ? &record : nullptr);
+            backwardNew.clear();
+            backwardRemoved.clear();
+            generateBackwardUpdate(forwardRemoved, backwardNew);
+            // the indices of the inserted entries are the ones to remove when rolling back
+            data->update(forwardNew, forwardRemoved, &backwardRemoved);
+            nl->updateInPlace();
+            stateModel.energy() = calculateEnergies();
+
+            scalar prefactor = 1.;
+            scalar energyDelta = stateModel.energy() - energyBefore;
+            switch (revReaction->reversibleType) {
+                case readdy::model::actions::reactions::FusionFission: {
+                    // the sign of interactionEnergy was determined in performReversibleReactionEvent
+                    energyDelta -= interactionEnergy;
+                    break;
+                }
+                case readdy::model::actions::reactions::ConversionConversion: {
+                    break;
+                }
+                case readdy::model::actions::reactions::EnzymaticEnzymatic: {
+                    prefactor = reaction->id() == revReaction->forwardId ? revReaction->acceptancePrefactor
+                                                                         : 1. / revReaction->acceptancePrefactor;
+                    break;
+                }
+                default:
+                    throw std::runtime_error(fmt::format("Unknown type of reversible reaction, method: {} file: {}",
+                                                         "CPUDetailedBalance::perform::eval",
+                                                         "CPUDetailedBalance.cpp"));
+            }
+            const scalar acceptance = std::min(1., prefactor * std::exp(-1. / ctx.kBT() * energyDelta));
+            log::trace("Acceptance for current event is {}", acceptance);
+
+            if (drawUniform(stateModel, subject, CPUStateModel::RandomStream::detailedBalance) < acceptance) {
+                if (recordReactions) {
+                    for (std::size_t i = 0; i < std::min(backwardRemoved.size(), record.products.size()); ++i) {
+                        record.products[i] = data->entry_at(backwardRemoved[i]).id;
+                    }
+                    stateModel.reactionRecords().push_back(record);
+                }
+                if (recordCounts) {
+                    stateModel.reactionCounts().at(reaction->id())++;
+                }
+            } else {
+                // the backward update restores the very same entries, hence also the energy
+                data->update(backwardNew, backwardRemoved, nullptr);
+                nl->updateInPlace();
+                stateModel.energy() = energyBefore;
+            }
+        } else {
+            // vanilla Doi model
+            const auto idx2 = event.nEducts == 1 ? event.idx1 : event.idx2;
+            forwardNew.clear();
+            forwardRemoved.clear();
+            if (recordReactions) {
+                record_t record;
+                record.id = reaction->id();
+                performReaction(data, ctx, event.idx1, idx2, forwardNew, forwardRemoved, reaction, &record,
+                                stateModel);
+                bcs::fixPosition(record.where, box, pbc);
+                stateModel.reactionRecords().push_back(record);
+            } else {
+                performReaction(data, ctx, event.idx1, idx2, forwardNew, forwardRemoved, reaction, nullptr,
+                                stateModel);
+            }
+            if (recordCounts) {
+                stateModel.reactionCounts().at(reaction->id())++;
+            }
+            data->update(forwardNew, forwardRemoved, nullptr);
+            nl->updateInPlace();
+            stateModel.energy() = calculateEnergies();
+        }
+    };
+
+    stateModel.energy() = calculateEnergies();
+    algo::performEvents(events, shouldEval, depending, eval, algo::detail::noPostPerform<std::vector<event_t>>,
+                        draw, dependencyKeys);
+}
+
+void CPUDetailedBalance::findEvents() {
+    const auto &stateModel = kernel->getCPUKernelStateModel();
+    const auto data = stateModel.getParticleData();
+    const auto nl = stateModel.getNeighborList();
+    auto &pool = kernel->pool();
+    const auto nThreads = static_cast<std::size_t>(kernel->getNThreads());
+
+    {
+        const auto particlesGrain = data->size() / nThreads;
+        const auto cellsGrain = nl->nCells() / nThreads;
+        std::vector<util::thread::joining_future<void>> futures;
+        futures.reserve(nThreads);
+        for (std::size_t t = 0; t < nThreads; ++t) {
+            const auto particlesBegin = t * particlesGrain;
+            const auto particlesEnd = t == nThreads - 1 ? data->size() : particlesBegin + particlesGrain;
+            const auto cellsBegin = t * cellsGrain;
+            const auto cellsEnd = t == nThreads - 1 ? nl->nCells() : cellsBegin + cellsGrain;
+            futures.emplace_back(pool.push([&, t, particlesBegin, particlesEnd, cellsBegin, cellsEnd](std::size_t) {
+                scalar alpha = 0;
+                gatherEvents(kernel, readdy::util::range<event_t::index_type>(particlesBegin, particlesEnd),
+                             cellsBegin, cellsEnd, nl, data, alpha, _buffers.threadEvents[t]);
+            }));
+        }
+    }
+    _buffers.collectThreadEvents();
+}
+
+scalar CPUDetailedBalance::calculateEnergies() {
+    const auto &ctx = kernel->context();
+    const auto &stateModel = kernel->getCPUKernelStateModel();
+    const auto data = stateModel.getParticleData();
+    const auto nl = stateModel.getNeighborList();
+    const auto &potentials = ctx.potentials();
+    const auto &potentialsOrder2 = potentials.potentialsOrder2Table();
+    const auto &box = ctx.boxSize().data();
+    const auto &pbc = ctx.periodicBoundaryConditions().data();
+    auto &pool = kernel->pool();
+    const auto nThreads = static_cast<std::size_t>(kernel->getNThreads());
+
+    // one partial sum per task, reduced in a fixed order
+    _threadEnergies.assign(nThreads, 0);
+    {
+        const auto particlesGrain = data->size() / nThreads;
+        const auto cellsGrain = nl->nCells() / nThreads;
+        std::vector<util::thread::joining_future<void>> futures;
+        futures.reserve(nThreads);
+        for (std::size_t t = 0; t < nThreads; ++t) {
+            const auto particlesBegin = t * particlesGrain;
+            const auto particlesEnd = t == nThreads - 1 ? data->size() : particlesBegin + particlesGrain;
+            const auto cellsBegin = t * cellsGrain;
+            const auto cellsEnd = t == nThreads - 1 ? nl->nCells() : cellsBegin + cellsGrain;
+            futures.emplace_back(pool.push([&, t, particlesBegin, particlesEnd, cellsBegin, cellsEnd](std::size_t) {
+                scalar energy = 0;
+                for (auto index = particlesBegin; index < particlesEnd; ++index) {
+                    const auto &entry = data->entry_at(index);
+                    if (!entry.deactivated) {
+                        for (const auto &potential : potentials.potentialsOf(entry.type)) {
+                            energy += potential->calculateEnergy(entry.pos);
+                        }
+                    }
+                }
+                for (auto cell = cellsBegin; cell < cellsEnd; ++cell) {
+                    for (auto it = nl->particlesBegin(cell); it != nl->particlesEnd(cell); ++it) {
+                        const auto &entry = data->entry_at(*it);
+                        nl->forEachNeighborHalf(*it, cell, [&](auto neighborIndex) {
+                            const auto &neighbor = data->entry_at(neighborIndex);
+                            const auto pairPotentials = potentialsOrder2(entry.type, neighbor.type);
+                            if (!pairPotentials.empty()) {
+                                const auto x_ij = bcs::shortestDifference(entry.pos, neighbor.pos, box, pbc);
+                                const auto distSquared = x_ij * x_ij;
+                                for (const auto *potential : pairPotentials) {
+                                    if (distSquared < potential->getCutoffRadiusSquared()) {
+                                        energy += potential->calculateEnergy(x_ij);
+                                    }
+                                }
+                            }
+                        });
+                    }
+                }
+                _threadEnergies[t] = energy;
+            }));
+        }
+    }
+    return std::accumulate(_threadEnergies.begin(), _threadEnergies.end(), static_cast<scalar>(0));
+}
+
+scalar CPUDetailedBalance::performReversibleReactionEvent(
+        const event_t &event, const reversible_reaction *reversibleReaction, const reaction_t *reaction,
+        data_t::EntriesUpdate &newParticles, std::vector<data_t::size_type> &decayedEntries, record_t *record) const {
+    const auto &ctx = kernel->context();
+    const auto &stateModel = kernel->getCPUKernelStateModel();
+    const auto data = stateModel.getParticleData();
+    const auto &box = ctx.boxSize().data();
+    const auto &pbc = ctx.periodicBoundaryConditions().data();
+
+    // do not re-use entries, such that all educts end up in the decayed entries, which is required for
+    // constructing the backward update
+
+    if (record) {
+        record->id = reaction->id();
+        record->type = static_cast<int>(reaction->type());
+    }
+
+    scalar energyDelta = 0;
+    switch (reversibleReaction->reversibleType) {
+        case readdy::model::actions::reactions::FusionFission: {
+            if (event.nEducts == 1) {
+                // backward reaction C --> A + B
+                const auto &entry = data->entry_at(event.idx1);
+                Vec3 n3;
+                scalar distance;
+                if (stateModel.seeded()) {
+                    auto random = stateModel.randomStream(entry.id, CPUStateModel::RandomStream::fission);
+                    n3 = random.normal3<readdy::scalar>(0, 1);
+                    distance = reversibleReaction->drawFissionDistance(random.uniform_real<readdy::scalar>());
+                } else {
+                    n3 = readdy::model::rnd::normal3<readdy::scalar>(0, 1);
+                    distance = reversibleReaction->drawFissionDistance();
+                }
+                n3 /= std::sqrt(n3 * n3);
+                // orientation does not matter for the energy U_AB
+                const Vec3 difference(distance, 0, 0);
+                for (const auto &potential : reversibleReaction->lhsPotentials) {
+                    energyDelta += potential->calculateEnergy(difference);
+                }
+                newParticles.emplace_back(bcs::applyPBC(entry.pos - reaction->weight2() * distance * n3, box, pbc),
+                                          reaction->products()[1], readdy::model::Particle::nextId());
+                newParticles.emplace_back(bcs::applyPBC(entry.pos + reaction->weight1() * distance * n3, box, pbc),
+                                          reaction->products()[0], readdy::model::Particle::nextId());
+                decayedEntries.push_back(event.idx1);
+                if (record) {
+                    record->where = entry.pos;
+                    record->educts[0] = entry.id;
+                    record->educts[1] = entry.id;
+                    record->types_from[0] = entry.type;
+                    record->types_from[1] = entry.type;
+                }
+            } else {
+                // forward reaction A + B --> C
+                const auto &entry1 = data->entry_at(event.idx1);
+                const auto &entry2 = data->entry_at(event.idx2);
+                const auto difference = bcs::shortestDifference(entry1.pos, entry2.pos, box, pbc);
+                for (const auto &potential : reversibleReaction->lhsPotentials) {
+                    energyDelta -= potential->calculateEnergy(difference);
+                }
+                const auto weight = reaction->educts()[0] == entry1.type ? reaction->weight1() : reaction->weight2();
+                newParticles.emplace_back(bcs::applyPBC(entry1.pos + weight * difference, box, pbc),
+                                          reaction->products()[0], readdy::model::Particle::nextId());
+                decayedEntries.push_back(event.idx1);
+                decayedEntries.push_back(event.idx2);
+                if (record) {
+                    record->where = (entry1.pos + entry2.pos) / 2.;
+                    record->educts[0] = entry1.id;
+                    record->educts[1] = entry2.id;
+                    record->types_from[0] = entry1.type;
+                    record->types_from[1] = entry2.type;
+                }
+            }
+            break;
+        }
+        case readdy::model::actions::reactions::ConversionConversion: {
+            const auto &entry = data->entry_at(event.idx1);
+            newParticles.emplace_back(entry.pos, reaction->products()[0], readdy::model::Particle::nextId());
+            decayedEntries.push_back(event.idx1);
+            if (record) {
+                record->where = entry.pos;
+                record->educts[0] = entry.id;
+                record->educts[1] = entry.id;
+                record->types_from[0] = entry.type;
+                record->types_from[1] = entry.type;
+            }
+            break;
+        }
+        case readdy::model::actions::reactions::EnzymaticEnzymatic: {
+            // find out which particle is the catalyst in A + C -> B + C
+            const auto catalystFirst = event.t1 == reaction->educts()[1];
+            const auto eductIdx = catalystFirst ? event.idx2 : event.idx1;
+            const auto catalystIdx = catalystFirst ? event.idx1 : event.idx2;
+            const auto &educt = data->entry_at(eductIdx);
+            const auto &catalyst = data->entry_at(catalystIdx);
+            newParticles.emplace_back(educt.pos, reaction->products()[0], readdy::model::Particle::nextId());
+            decayedEntries.push_back(eductIdx);
+            if (record) {
+                record->where = (educt.pos + catalyst.pos) / 2.;
+                record->educts[0] = educt.id;
+                record->educts[1] = catalyst.id;
+                record->types_from[0] = educt.type;
+                record->types_from[1] = catalyst.type;
+                record->products[1] = catalyst.id;
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error(fmt::format("Unknown type of reversible reaction, method: {} file: {}",
+                                                 "CPUDetailedBalance::performReversibleReactionEvent",
+                                                 "CPUDetailedBalance.cpp"));
+    }
+    if (record) {
+        bcs::fixPosition(record->where, box, pbc);
+    }
+
+    return energyDelta;
+}
+
+void CPUDetailedBalance::generateBackwardUpdate(const std::vector<data_t::size_type> &removedEntries,
+                                                data_t::EntriesUpdate &backwardNew) const {
+    // the removed entries go back into the slots of the inserted ones and, as the data container re-uses the most
+    // recently freed slots first, the surplus ones end up at their previous indices
+    const auto data = kernel->getCPUKernelStateModel().getParticleData();
+    for (const auto index : removedEntries) {
+        backwardNew.push_back(data->entry_at(index));
+    }
+}
+
+std::pair<const CPUDetailedBalance::reversible_reaction *, const CPUDetailedBalance::reaction_t *>
+CPUDetailedBalance::findReversibleReaction(const event_t &event) const {
+    const auto &ctx = kernel->context();
+    const auto *reaction = event.nEducts == 1
+                           ? ctx.reactions().order1ByType(event.t1)[event.reactionIndex]
+                           : ctx.reactions().order2ByType(event.t1, event.t2)[event.reactionIndex];
+    auto it = _reversibleReactionsMap.find(reaction->id());
+    if (it != _reversibleReactionsMap.end()) {
+        return std::make_pair(it->second.get(), reaction);
+    }
+    return std::make_pair(nullptr, reaction);
+}
+
+}
+}
+}
+}
+}
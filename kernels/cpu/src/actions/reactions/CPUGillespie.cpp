@@ -41,6 +41,8 @@
  */
 #include <readdy/kernel/cpu/actions/reactions/CPUGillespie.h>
 
+#include <algorithm>
+
 
 namespace readdy {
 namespace kernel {
@@ -62,38 +64,163 @@ void CPUGillespie::perform() {
     if(ctx.recordReactionCounts()) {
         stateModel.resetReactionCounts();
     }
+    kernel->context().reactions().cacheProbabilities(timeStep(), false);
+
+    // the domains depend on the number of threads and their products draw ids concurrently, which seeded runs cannot
+    // reproduce, so these are always handled serially
+    if (ctx.kernelConfiguration().cpu.reactions.parallelGillespie && kernel->getNThreads() > 1
+        && !stateModel.seeded()) {
+        const auto &box = ctx.boxSize();
+        const auto axis = static_cast<std::size_t>(std::max_element(box.begin(), box.end()) - box.begin());
+        scalar maxReactionRadius = 0;
+        for (const auto reaction : ctx.reactions().order2Flat()) {
+            maxReactionRadius = std::max(maxReactionRadius, reaction->eductDistance());
+        }
+        auto nDomains = static_cast<std::size_t>(kernel->getNThreads());
+        if (maxReactionRadius > 0) {
+            nDomains = std::min(nDomains, static_cast<std::size_t>(std::floor(box[axis] / maxReactionRadius)));
+        }
+        if (nDomains > 1) {
+            performInDomains(nDomains, axis);
+            return;
+        }
+    }
 
+    _buffers.clear(1);
     scalar alpha = 0.0;
-    std::vector<event_t> events;
-    gatherEvents(kernel, readdy::util::range<event_t::index_type>(0, data->size()), nl, data, alpha, events);
-    if(ctx.recordReactionsWithPositions()) {
+    gatherEvents(kernel, readdy::util::range<event_t::index_type>(0, data->size()), nl, data, alpha,
+                 _buffers.events);
+    if (ctx.recordReactionsWithPositions()) {
+        stateModel.reactionRecords().clear();
+    }
+    auto &newEntries = _buffers.newEntries.front();
+    auto &removedEntries = _buffers.removedEntries.front();
+    handleEventsGillespie(kernel, false, _buffers.events, newEntries, removedEntries,
+                          ctx.recordReactionsWithPositions() ? &stateModel.reactionRecords() : nullptr,
+                          ctx.recordReactionCounts() ? &stateModel.reactionCounts() : nullptr);
+    data->update(newEntries, removedEntries, nullptr);
+}
+
+
+void CPUGillespie::performInDomains(std::size_t nDomains, std::size_t axis) {
+    const auto &ctx = kernel->context();
+    auto &stateModel = kernel->getCPUKernelStateModel();
+    auto data = stateModel.getParticleData();
+    const auto nl = stateModel.getNeighborList();
+    auto &pool = kernel->pool();
+    const auto nThreads = static_cast<std::size_t>(kernel->getNThreads());
+    const auto recordReactions = ctx.recordReactionsWithPositions();
+    const auto recordCounts = ctx.recordReactionCounts();
+    if (recordReactions) {
         stateModel.reactionRecords().clear();
-        if(ctx.recordReactionCounts()) {
-            auto &counts = stateModel.reactionCounts();
-            auto particlesUpdate = handleEventsGillespie(kernel, timeStep(), false, false, std::move(events),
-                                                         &stateModel.reactionRecords(), &counts);
-            data->update(std::move(particlesUpdate));
-        } else {
-            auto particlesUpdate = handleEventsGillespie(kernel, timeStep(), false, false, std::move(events),
-                                                         &stateModel.reactionRecords(), nullptr);
-            data->update(std::move(particlesUpdate));
+    }
+
+    const auto boxLength = ctx.boxSize()[axis];
+    const auto domainWidth = boxLength / static_cast<scalar>(nDomains);
+    auto domainOf = [&](event_t::index_type index) {
+        const auto x = data->entry_at(index).pos[axis] + .5 * boxLength;
+        const auto domain = static_cast<std::ptrdiff_t>(std::floor(x / domainWidth));
+        return static_cast<std::size_t>(std::clamp(domain, static_cast<std::ptrdiff_t>(0),
+                                                   static_cast<std::ptrdiff_t>(nDomains - 1)));
+    };
+
+    _buffers.clear(nThreads, nDomains + 1);
+    _threadBuckets.resize(nThreads);
+    _domainEvents.resize(nDomains + 1);
+    _domainRecords.resize(nDomains + 1);
+    _domainCounts.resize(nDomains + 1);
+    for (std::size_t domain = 0; domain < nDomains + 1; ++domain) {
+        _domainEvents[domain].clear();
+        _domainRecords[domain].clear();
+        if (_domainCounts[domain].size() != stateModel.reactionCounts().size()) {
+            _domainCounts[domain] = stateModel.reactionCounts();
         }
-    } else {
-        if(ctx.recordReactionCounts()) {
-            auto &counts = stateModel.reactionCounts();
-            auto particlesUpdate = handleEventsGillespie(kernel, timeStep(), false, false, std::move(events),
-                                                         nullptr, &counts);
-            data->update(std::move(particlesUpdate));
-        } else {
-            auto particlesUpdate = handleEventsGillespie(kernel, timeStep(), false, false, std::move(events),
-                                                         nullptr, nullptr);
-            data->update(std::move(particlesUpdate));
+        for (auto &[id, count] : _domainCounts[domain]) {
+            count = 0;
         }
     }
-}
+    _touched.assign(data->size(), 0);
+
+    // gather the events in parallel and sort them into the domains, the last bucket holds the events with educts
+    // in different domains
+    {
+        const auto particlesGrain = data->size() / nThreads;
+        const auto cellsGrain = nl->nCells() / nThreads;
+        std::vector<util::thread::joining_future<void>> futures;
+        futures.reserve(nThreads);
+        for (std::size_t t = 0; t < nThreads; ++t) {
+            const auto particlesBegin = t * particlesGrain;
+            const auto particlesEnd = t == nThreads - 1 ? data->size() : particlesBegin + particlesGrain;
+            const auto cellsBegin = t * cellsGrain;
+            const auto cellsEnd = t == nThreads - 1 ? nl->nCells() : cellsBegin + cellsGrain;
+            futures.emplace_back(pool.push([&, t, particlesBegin, particlesEnd, cellsBegin, cellsEnd](std::size_t) {
+                scalar alpha = 0;
+                auto &events = _buffers.threadEvents[t];
+                gatherEvents(kernel, readdy::util::range<event_t::index_type>(particlesBegin, particlesEnd),
+                             cellsBegin, cellsEnd, nl, data, alpha, events);
+                auto &buckets = _threadBuckets[t];
+                buckets.resize(nDomains + 1);
+                for (auto &bucket : buckets) {
+                    bucket.clear();
+                }
+                for (const auto &event : events) {
+                    const auto domain = domainOf(event.idx1);
+                    const auto crossing = event.nEducts == 2 && domainOf(event.idx2) != domain;
+                    buckets[crossing ? nDomains : domain].push_back(event);
+                }
+            }));
+        }
+    }
+    auto collectBuckets = [&](std::size_t domain) {
+        auto &events = _domainEvents[domain];
+        for (const auto &buckets : _threadBuckets) {
+            events.insert(events.end(), buckets[domain].begin(), buckets[domain].end());
+        }
+    };
+
+    // the domains do not share any particles, so they can be handled concurrently
+    {
+        std::vector<util::thread::joining_future<void>> futures;
+        futures.reserve(nDomains);
+        for (std::size_t domain = 0; domain < nDomains; ++domain) {
+            futures.emplace_back(pool.push([&, domain](std::size_t) {
+                collectBuckets(domain);
+                handleEventsGillespie(kernel, false, _domainEvents[domain],
+                                      _buffers.newEntries[domain], _buffers.removedEntries[domain],
+                                      recordReactions ? &_domainRecords[domain] : nullptr,
+                                      recordCounts ? &_domainCounts[domain] : nullptr, domain, &_touched);
+            }));
+        }
+    }
+    // events across domains whose educts already reacted are dropped, the others are handled serially
+    {
+        collectBuckets(nDomains);
+        auto &crossing = _domainEvents[nDomains];
+        crossing.erase(std::remove_if(crossing.begin(), crossing.end(), [this](const event_t &event) {
+            return _touched[event.idx1] || _touched[event.idx2];
+        }), crossing.end());
+        handleEventsGillespie(kernel, false, crossing, _buffers.newEntries[nDomains],
+                              _buffers.removedEntries[nDomains],
+                              recordReactions ? &_domainRecords[nDomains] : nullptr,
+                              recordCounts ? &_domainCounts[nDomains] : nullptr, nDomains);
+    }
 
+    // all events are performed, so the updates of the domains can be applied one after another
+    for (std::size_t domain = 0; domain < nDomains + 1; ++domain) {
+        data->update(_buffers.newEntries[domain], _buffers.removedEntries[domain], nullptr);
+        if (recordReactions) {
+            stateModel.reactionRecords().insert(stateModel.reactionRecords().end(), _domainRecords[domain].begin(),
+                                                _domainRecords[domain].end());
+        }
+        if (recordCounts) {
+            for (const auto &[id, count] : _domainCounts[domain]) {
+                stateModel.reactionCounts()[id] += count;
+            }
+        }
+    }
+}
+}
 }
 }
 }
 }
-}
\ No newline at end of file
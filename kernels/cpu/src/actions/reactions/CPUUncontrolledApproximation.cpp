@@ -40,8 +40,11 @@
  * @date 20.10.16
  */
 
+#include <atomic>
 #include <future>
+#include <limits>
 #include <random>
+#include <numeric>
 
 #include <readdy/kernel/cpu/actions/reactions/CPUUncontrolledApproximation.h>
 #include <readdy/kernel/cpu/actions/reactions/Event.h>
@@ -61,36 +64,30 @@ using neighbor_list = CPUStateModel::neighbor_list;
 using nl_bounds = std::tuple<std::size_t, std::size_t>;
 using entry_type = data_t::Entries::value_type;
 
-using event_future_t = std::future<std::vector<event_t>>;
-using event_promise_t = std::promise<std::vector<event_t>>;
-
 CPUUncontrolledApproximation::CPUUncontrolledApproximation(CPUKernel *kernel, readdy::scalar timeStep)
         : super(timeStep), kernel(kernel) {}
 
-void findEvents(std::size_t /*tid*/, data_iter_t begin, data_iter_t end, nl_bounds nlBounds,
-                const CPUKernel *const kernel, scalar dt, bool approximateRate, const neighbor_list &nl,
-                event_promise_t &events, std::promise<std::size_t> &n_events) {
-    std::vector<event_t> eventsUpdate;
-    const auto &data = *kernel->getCPUKernelStateModel().getParticleData();
+void findEvents(data_iter_t begin, data_iter_t end, nl_bounds nlBounds, const CPUKernel *const kernel,
+                const neighbor_list &nl, std::vector<event_t> &eventsUpdate) {
+    using stream = CPUStateModel::RandomStream;
+    const auto &stateModel = kernel->getCPUKernelStateModel();
+    const auto &data = *stateModel.getParticleData();
     const auto &box = kernel->context().boxSize().data();
     const auto &pbc = kernel->context().periodicBoundaryConditions().data();
+    const auto &registry = kernel->context().reactions();
+    const auto &reactionsO2 = registry.order2Table();
     auto index = static_cast<std::size_t>(std::distance(data.begin(), begin));
     for (auto it = begin; it != end; ++it, ++index) {
         const auto &entry = *it;
         // this being false should really not happen, though
-        if (!entry.deactivated) {
-            // order 1
-            {
-                const auto &reactions = kernel->context().reactions().order1ByType(entry.type);
-                for (auto it_reactions = reactions.begin(); it_reactions != reactions.end(); ++it_reactions) {
-                    const auto rate = (*it_reactions)->rate();
-                    if (rate > 0 && shouldPerformEvent(rate, dt, approximateRate)) {
-                        eventsUpdate.emplace_back(1, (*it_reactions)->nProducts(), index, index, rate, 0,
-                                                  static_cast<event_t::reaction_index_type>(it_reactions -
-                                                                                            reactions.begin()),
-                                                  entry.type, 0);
-                    }
-                }
+        if (!entry.deactivated && registry.order1Probability(entry.type) > 0) {
+            // order 1, one draw decides upon all reactions of the particle
+            const auto reactionIndex = drawOrder1Reaction(
+                    registry, entry.type, drawUniform(stateModel, entry.id, stream::reactionsOrder1));
+            if (reactionIndex) {
+                const auto *reaction = registry.order1ByType(entry.type)[*reactionIndex];
+                eventsUpdate.emplace_back(1, reaction->nProducts(), index, index, reaction->rate(), 0,
+                                          *reactionIndex, entry.type, 0);
             }
         }
     }
@@ -107,16 +104,17 @@ void findEvents(std::size_t /*tid*/, data_iter_t begin, data_iter_t end, nl_boun
                 if (*particleIt > neighborIdx) {
                     const auto &neighbor = data.entry_at(neighborIdx);
                     if(!neighbor.deactivated) {
-                        const auto &reactions = kernel->context().reactions().order2ByType(entry.type, neighbor.type);
+                        const auto reactions = reactionsO2(entry.type, neighbor.type);
                         if (!reactions.empty()) {
                             const auto distSquared = bcs::distSquared(neighbor.pos, entry.pos, box, pbc);
                             for (auto it_reactions = reactions.begin(); it_reactions < reactions.end(); ++it_reactions) {
                                 const auto &react = *it_reactions;
                                 const auto rate = react->rate();
+                                const auto reaction_index = static_cast<event_t::reaction_index_type>(
+                                        it_reactions - reactions.begin());
                                 if (rate > 0 && distSquared < react->eductDistanceSquared()
-                                    && shouldPerformEvent(rate, dt, approximateRate)) {
-                                    const auto reaction_index = static_cast<event_t::reaction_index_type>(it_reactions -
-                                                                                                          reactions.begin());
+                                    && drawUniform(stateModel, eventSubject(entry.id, neighbor.id, reaction_index),
+                                                   stream::reactionsOrder2) < react->probability()) {
                                     eventsUpdate.emplace_back(2, react->nProducts(), *particleIt, neighborIdx,
                                                               rate, 0, reaction_index, entry.type, neighbor.type);
                                 }
@@ -127,9 +125,98 @@ void findEvents(std::size_t /*tid*/, data_iter_t begin, data_iter_t end, nl_boun
             });
         }
     }
+}
+
+/**
+ * Decides which of the (shuffled) events are executed: an event is executed unless it shares a particle with an event
+ * before it that is executed. This greedy choice is inherently sequential when done event by event, it is found in
+ * rounds instead. In each round every undecided event claims its particles with its position in the list, events
+ * holding the claims to all their particles are executed and undecided events touching a particle of those are
+ * dropped. The outcome is the same as the one of the sequential pass, the number of rounds is logarithmic in the
+ * number of events for random orders.
+ * @return a flag per event whether it gets executed, it is held by the buffers
+ */
+const std::vector<std::uint8_t> &resolveConflicts(const std::vector<event_t> &events, std::size_t nParticles,
+                                                  CPUKernel *const kernel, ReactionBuffers &buffers) {
+    static constexpr std::uint8_t undecidedEvent = 0, acceptedEvent = 1, droppedEvent = 2;
+    static constexpr auto noClaim = std::numeric_limits<std::size_t>::max();
+
+    auto &status = buffers.eventStatus;
+    status.assign(events.size(), undecidedEvent);
+    if (events.empty()) {
+        return status;
+    }
+
+    auto &claims = buffers.claims;
+    auto &taken = buffers.taken;
+    if (claims.size() < nParticles) {
+        // atomics cannot be moved, so the claims are replaced instead of resized
+        claims = std::vector<std::atomic<std::size_t>>(nParticles);
+    }
+    if (taken.size() < nParticles) {
+        taken.resize(nParticles, 0);
+    }
 
-    n_events.set_value(eventsUpdate.size());
-    events.set_value(std::move(eventsUpdate));
+    auto &undecided = buffers.undecidedEvents;
+    undecided.resize(events.size());
+    std::iota(undecided.begin(), undecided.end(), 0);
+
+    auto &pool = kernel->pool();
+    const auto nThreads = kernel->getNThreads();
+    auto forEachUndecided = [&](const auto &f) {
+        const auto grainSize = std::max(undecided.size() / nThreads, static_cast<std::size_t>(1));
+        std::vector<util::thread::joining_future<void>> futures;
+        futures.reserve(nThreads);
+        for (std::size_t begin = 0; begin < undecided.size(); begin += grainSize) {
+            const auto end = std::min(begin + grainSize, undecided.size());
+            futures.emplace_back(pool.push([&f, &undecided, begin, end](std::size_t) {
+                for (auto i = begin; i < end; ++i) {
+                    f(undecided[i]);
+                }
+            }));
+        }
+    };
+
+    while (!undecided.empty()) {
+        forEachUndecided([&](std::size_t eventIndex) {
+            claims[events[eventIndex].idx1].store(noClaim, std::memory_order_relaxed);
+            claims[events[eventIndex].idx2].store(noClaim, std::memory_order_relaxed);
+        });
+        forEachUndecided([&](std::size_t eventIndex) {
+            for (auto particle : {events[eventIndex].idx1, events[eventIndex].idx2}) {
+                auto current = claims[particle].load(std::memory_order_relaxed);
+                while (eventIndex < current &&
+                       !claims[particle].compare_exchange_weak(current, eventIndex, std::memory_order_relaxed)) {}
+            }
+        });
+        forEachUndecided([&](std::size_t eventIndex) {
+            const auto &event = events[eventIndex];
+            if (claims[event.idx1].load(std::memory_order_relaxed) == eventIndex
+                && claims[event.idx2].load(std::memory_order_relaxed) == eventIndex) {
+                // no other undecided event holds these particles, so they are written by this event only
+                status[eventIndex] = acceptedEvent;
+                taken[event.idx1] = 1;
+                taken[event.idx2] = 1;
+            }
+        });
+        forEachUndecided([&](std::size_t eventIndex) {
+            const auto &event = events[eventIndex];
+            if (status[eventIndex] == undecidedEvent && (taken[event.idx1] || taken[event.idx2])) {
+                status[eventIndex] = droppedEvent;
+            }
+        });
+        undecided.erase(std::remove_if(undecided.begin(), undecided.end(), [&status](std::size_t eventIndex) {
+            return status[eventIndex] != undecidedEvent;
+        }), undecided.end());
+    }
+
+    for (std::size_t eventIndex = 0; eventIndex < events.size(); ++eventIndex) {
+        // leave the particle flags cleared for the next time step
+        taken[events[eventIndex].idx1] = 0;
+        taken[events[eventIndex].idx2] = 0;
+        status[eventIndex] = status[eventIndex] == acceptedEvent;
+    }
+    return status;
 }
 
 void CPUUncontrolledApproximation::perform() {
@@ -147,111 +234,97 @@ void CPUUncontrolledApproximation::perform() {
         stateModel.resetReactionCounts();
     }
 
+    kernel->context().reactions().cacheProbabilities(timeStep(), false);
+
     // gather events
-    std::vector<std::promise<std::size_t>> n_events_promises(kernel->getNThreads());
-    std::vector<event_promise_t> promises(kernel->getNThreads());
+    const auto nThreads = static_cast<std::size_t>(kernel->getNThreads());
+    _buffers.clear(nThreads);
     {
-
         auto &pool = kernel->pool();
+        std::vector<util::thread::joining_future<void>> futures;
+        futures.reserve(nThreads);
 
-        std::vector<std::function<void(std::size_t)>> executables;
-        executables.reserve(kernel->getNThreads());
-
-        std::size_t grainSize = data.size() / kernel->getNThreads();
-        std::size_t nlGrainSize = nl->nCells() / kernel->getNThreads();
+        std::size_t grainSize = data.size() / nThreads;
+        std::size_t nlGrainSize = nl->nCells() / nThreads;
 
         auto it = data.cbegin();
         std::size_t it_nl = 0;
-        for (auto i = 0U; i < kernel->getNThreads()-1 ; ++i) {
-            auto itNext = std::min(it+grainSize, data.cend());
-
-            auto nlNext = std::min(it_nl + nlGrainSize, nl->nCells());
+        for (std::size_t i = 0; i < nThreads; ++i) {
+            auto itNext = i == nThreads - 1 ? data.cend() : std::min(it + grainSize, data.cend());
+            auto nlNext = i == nThreads - 1 ? nl->nCells() : std::min(it_nl + nlGrainSize, nl->nCells());
             auto bounds_nl = std::make_tuple(it_nl, nlNext);
 
-            pool.push(findEvents, it, itNext, bounds_nl, kernel, timeStep(), false, std::cref(*nl),
-                      std::ref(promises.at(i)), std::ref(n_events_promises.at(i)));
+            futures.emplace_back(pool.push([=, &events = _buffers.threadEvents[i]](std::size_t) {
+                findEvents(it, itNext, bounds_nl, kernel, *nl, events);
+            }));
 
             it = itNext;
             it_nl = nlNext;
         }
-        pool.push(findEvents, it, data.cend(), std::make_tuple(it_nl, nl->nCells()), kernel, timeStep(), false,
-                  std::cref(*nl), std::ref(promises.back()), std::ref(n_events_promises.back()));
     }
+    _buffers.collectThreadEvents();
+    auto &events = _buffers.events;
 
-    // collect events
-    std::vector<event_t> events;
-    {
-        std::size_t n_events = 0;
-        for (auto &&f : n_events_promises) {
-            n_events += f.get_future().get();
-        }
-        events.reserve(n_events);
-        for (auto &&f : promises) {
-            auto eventUpdate = std::move(f.get_future().get());
-            auto mBegin = std::make_move_iterator(eventUpdate.begin());
-            auto mEnd = std::make_move_iterator(eventUpdate.end());
-            events.insert(events.end(), mBegin, mEnd);
-        }
+    // shuffle reactions
+    if (stateModel.seeded()) {
+        sortEvents(events);
+        auto random = stateModel.randomStream(0, CPUStateModel::RandomStream::eventSelection);
+        std::shuffle(events.begin(), events.end(), random);
+    } else {
+        std::shuffle(events.begin(), events.end(), std::mt19937(std::random_device()()));
     }
 
-    // shuffle reactions
-    std::shuffle(events.begin(), events.end(), std::mt19937(std::random_device()()));
+    // find the events that get executed, in parallel
+    const auto &accepted = resolveConflicts(events, data.size(), kernel, _buffers);
 
     // execute reactions
     {
-        data_t::EntriesUpdate newParticles{};
-        std::vector<data_t::size_type> decayedEntries{};
+        auto &newParticles = _buffers.newEntries.front();
+        auto &decayedEntries = _buffers.removedEntries.front();
 
-        // todo better conflict detection?
-        for (auto it = events.begin(); it != events.end(); ++it) {
-            auto &event = *it;
-            if (event.cumulativeRate == 0) {
-                auto entry1 = event.idx1;
-                if (event.nEducts == 1) {
-                    auto reaction = ctx.reactions().order1ByType(event.t1)[event.reactionIndex];
-                    if (ctx.recordReactionsWithPositions()) {
-                        record_t record;
-                        record.id = reaction->id();
-                        performReaction(&data, ctx, entry1, entry1, newParticles, decayedEntries, reaction, &record);
-                        bcs::fixPosition(record.where, box, pbc);
-                        kernel->getCPUKernelStateModel().reactionRecords().push_back(record);
-                    } else {
-                        performReaction(&data, ctx, entry1, entry1, newParticles, decayedEntries, reaction, nullptr);
-                    }
-                    if (ctx.recordReactionCounts()) {
-                        auto &counts = stateModel.reactionCounts();
-                        counts.at(reaction->id())++;
-                    }
-                    for (auto _it2 = it + 1; _it2 != events.end(); ++_it2) {
-                        if (_it2->idx1 == entry1 || _it2->idx2 == entry1) {
-                            _it2->cumulativeRate = 1;
-                        }
-                    }
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            if (!accepted[i]) {
+                continue;
+            }
+            const auto &event = events[i];
+            auto entry1 = event.idx1;
+            if (event.nEducts == 1) {
+                auto reaction = ctx.reactions().order1ByType(event.t1)[event.reactionIndex];
+                if (ctx.recordReactionsWithPositions()) {
+                    record_t record;
+                    record.id = reaction->id();
+                    performReaction(&data, ctx, entry1, entry1, newParticles, decayedEntries, reaction, &record,
+                                    stateModel);
+                    bcs::fixPosition(record.where, box, pbc);
+                    kernel->getCPUKernelStateModel().reactionRecords().push_back(record);
                 } else {
-                    auto reaction = ctx.reactions().order2ByType(event.t1, event.t2)[event.reactionIndex];
-                    if (ctx.recordReactionsWithPositions()) {
-                        record_t record;
-                        record.id = reaction->id();
-                        performReaction(&data, ctx, entry1, event.idx2, newParticles, decayedEntries, reaction, &record);
-                        bcs::fixPosition(record.where, box, pbc);
-                        kernel->getCPUKernelStateModel().reactionRecords().push_back(record);
-                    } else {
-                        performReaction(&data, ctx, entry1, event.idx2, newParticles, decayedEntries, reaction, nullptr);
-                    }
-                    if (ctx.recordReactionCounts()) {
-                        auto &counts = stateModel.reactionCounts();
-                        counts.at(reaction->id())++;
-                    }
-                    for (auto _it2 = it + 1; _it2 != events.end(); ++_it2) {
-                        if (_it2->idx1 == entry1 || _it2->idx2 == entry1 ||
-                            _it2->idx1 == event.idx2 || _it2->idx2 == event.idx2) {
-                            _it2->cumulativeRate = 1;
-                        }
-                    }
+                    performReaction(&data, ctx, entry1, entry1, newParticles, decayedEntries, reaction, nullptr,
+                                    stateModel);
+                }
+                if (ctx.recordReactionCounts()) {
+                    auto &counts = stateModel.reactionCounts();
+                    counts.at(reaction->id())++;
+                }
+            } else {
+                auto reaction = ctx.reactions().order2ByType(event.t1, event.t2)[event.reactionIndex];
+                if (ctx.recordReactionsWithPositions()) {
+                    record_t record;
+                    record.id = reaction->id();
+                    performReaction(&data, ctx, entry1, event.idx2, newParticles, decayedEntries, reaction, &record,
+                                    stateModel);
+                    bcs::fixPosition(record.where, box, pbc);
+                    kernel->getCPUKernelStateModel().reactionRecords().push_back(record);
+                } else {
+                    performReaction(&data, ctx, entry1, event.idx2, newParticles, decayedEntries, reaction, nullptr,
+                                    stateModel);
+                }
+                if (ctx.recordReactionCounts()) {
+                    auto &counts = stateModel.reactionCounts();
+                    counts.at(reaction->id())++;
                 }
             }
         }
-        data.update(std::make_pair(std::move(newParticles), std::move(decayedEntries)));
+        data.update(newParticles, decayedEntries, nullptr);
     }
 }
 }
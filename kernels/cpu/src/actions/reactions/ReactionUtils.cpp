@@ -44,6 +44,8 @@
  */
 
 #include <readdy/kernel/cpu/actions/reactions/ReactionUtils.h>
+#include <optional>
+
 #include <readdy/common/algorithm.h>
 
 namespace readdy {
@@ -52,26 +54,74 @@ namespace cpu {
 namespace actions {
 namespace reactions {
 
-data_t::DataUpdate handleEventsGillespie(
-        CPUKernel *const kernel, scalar timeStep, bool filterEventsInAdvance, bool approximateRate,
-        std::vector<event_t> &&events, std::vector<record_t> *maybeRecords, reaction_counts_map *maybeCounts) {
-    using rdy_particle_t = readdy::model::Particle;
+void ReactionBuffers::clear(std::size_t nThreads, std::size_t nUpdates) {
+    threadEvents.resize(nThreads);
+    for (auto &buffer : threadEvents) {
+        buffer.clear();
+    }
+    events.clear();
+    newEntries.resize(nUpdates);
+    removedEntries.resize(nUpdates);
+    for (std::size_t i = 0; i < nUpdates; ++i) {
+        newEntries[i].clear();
+        removedEntries[i].clear();
+    }
+}
+
+void ReactionBuffers::collectThreadEvents() {
+    std::size_t nEvents = events.size();
+    for (const auto &buffer : threadEvents) {
+        nEvents += buffer.size();
+    }
+    events.reserve(nEvents);
+    for (const auto &buffer : threadEvents) {
+        events.insert(events.end(), buffer.begin(), buffer.end());
+    }
+}
+
+void handleEventsGillespie(
+        CPUKernel *const kernel, bool filterEventsInAdvance, std::vector<event_t> &events,
+        data_t::EntriesUpdate &newParticles,
+        std::vector<data_t::size_type> &decayedEntries, std::vector<record_t> *maybeRecords,
+        reaction_counts_map *maybeCounts, std::uint64_t selectionSubject, std::vector<std::uint8_t> *maybeTouched) {
     const auto &box = kernel->context().boxSize().data();
     const auto &pbc = kernel->context().periodicBoundaryConditions().data();
 
-    data_t::EntriesUpdate newParticles{};
-    std::vector<data_t::size_type> decayedEntries{};
-
     if (!events.empty()) {
         const auto &ctx = kernel->context();
+        const auto &stateModel = kernel->getCPUKernelStateModel();
         auto data = kernel->getCPUKernelStateModel().getParticleData();
         /**
          * Handle gathered reaction events
          */
         {
+            std::optional<readdy::model::rnd::CounterBasedRandom> selection;
+            if (stateModel.seeded()) {
+                sortEvents(events);
+                selection = stateModel.randomStream(selectionSubject, CPUStateModel::RandomStream::eventSelection);
+            }
 
             auto shouldEval = [&](const event_t &event) {
-                return filterEventsInAdvance || shouldPerformEvent(event.rate, timeStep, approximateRate);
+                if (filterEventsInAdvance) {
+                    return true;
+                }
+                const auto &entry1 = data->entry_at(event.idx1);
+                if (event.nEducts == 1) {
+                    const auto uniform = drawUniform(stateModel, eventSubject(entry1.id, event.reactionIndex),
+                                                     CPUStateModel::RandomStream::reactionsOrder1);
+                    return uniform < ctx.reactions().order1ByType(event.t1)[event.reactionIndex]->probability();
+                }
+                const auto &entry2 = data->entry_at(event.idx2);
+                const auto uniform = drawUniform(stateModel, eventSubject(entry1.id, entry2.id, event.reactionIndex),
+                                                 CPUStateModel::RandomStream::reactionsOrder2);
+                return uniform < ctx.reactions().order2Table()(event.t1, event.t2)[event.reactionIndex]->probability();
+            };
+
+            auto draw = [&](scalar cumulativeRate) {
+                if (selection) {
+                    return selection->uniform_real<scalar>(0., cumulativeRate);
+                }
+                return readdy::model::rnd::uniform_real<scalar>(0., cumulativeRate);
             };
 
             auto depending = [&](const event_t &e1, const event_t &e2) {
@@ -79,18 +129,33 @@ data_t::DataUpdate handleEventsGillespie(
                         || (e1.nEducts == 2 && (e1.idx2 == e2.idx1 || (e2.nEducts == 2 && e1.idx2 == e2.idx2))));
             };
 
+            auto dependencyKeys = [](const event_t &event, const auto &key) {
+                key(event.idx1);
+                if (event.nEducts == 2) {
+                    key(event.idx2);
+                }
+            };
+
             auto eval = [&](const event_t &event) {
                 auto entry1 = event.idx1;
+                if (maybeTouched != nullptr) {
+                    (*maybeTouched)[event.idx1] = 1;
+                    if (event.nEducts == 2) {
+                        (*maybeTouched)[event.idx2] = 1;
+                    }
+                }
                 if (event.nEducts == 1) {
                     auto reaction = ctx.reactions().order1ByType(event.t1)[event.reactionIndex];
                     if (maybeRecords != nullptr) {
                         record_t record;
                         record.id = reaction->id();
-                        performReaction(data, ctx, entry1, entry1, newParticles, decayedEntries, reaction, &record);
+                        performReaction(data, ctx, entry1, entry1, newParticles, decayedEntries, reaction, &record,
+                                        stateModel);
                         bcs::fixPosition(record.where, box, pbc);
                         maybeRecords->push_back(record);
                     } else {
-                        performReaction(data, ctx, entry1, entry1, newParticles, decayedEntries, reaction, nullptr);
+                        performReaction(data, ctx, entry1, entry1, newParticles, decayedEntries, reaction, nullptr,
+                                        stateModel);
                     }
                     if (maybeCounts != nullptr) {
                         auto &counts = *maybeCounts;
@@ -102,12 +167,12 @@ data_t::DataUpdate handleEventsGillespie(
                         record_t record;
                         record.id = reaction->id();
                         performReaction(data, ctx, entry1, event.idx2, newParticles, decayedEntries, reaction,
-                                        &record);
+                                        &record, stateModel);
                         bcs::fixPosition(record.where, box, pbc);
                         maybeRecords->push_back(record);
                     } else {
                         performReaction(data, ctx, entry1, event.idx2, newParticles, decayedEntries, reaction,
-                                        nullptr);
+                                        nullptr, stateModel);
                     }
                     if (maybeCounts != nullptr) {
                         auto &counts = *maybeCounts;
@@ -116,10 +181,10 @@ data_t::DataUpdate handleEventsGillespie(
                 }
             };
 
-            algo::performEvents(events, shouldEval, depending, eval);
+            algo::performEvents(events, shouldEval, depending, eval, algo::detail::noPostPerform<std::vector<event_t>>,
+                                draw, dependencyKeys);
         }
     }
-    return std::make_pair(std::move(newParticles), std::move(decayedEntries));
 }
 }
 }
@@ -43,9 +43,19 @@
 
 #include <readdy/kernel/cpu/nl/CellLinkedList.h>
 #include <readdy/common/numeric.h>
+#include <readdy/common/thread/parallel_for.h>
 
 namespace readdy::kernel::cpu::nl {
 
+namespace {
+template<typename Box>
+bool particleInBox(const Box &boxSize, const Vec3 &pos) {
+    return -.5*boxSize[0] <= pos.x && .5*boxSize[0] > pos.x
+           && -.5*boxSize[1] <= pos.y && .5*boxSize[1] > pos.y
+           && -.5*boxSize[2] <= pos.z && .5*boxSize[2] > pos.z;
+}
+}
+
 CellLinkedList::CellLinkedList(data_type &data, const readdy::model::Context &context, thread_pool &pool)
         : _data(data), _context(context), _pool(pool) {}
 
@@ -63,7 +73,7 @@ void CellLinkedList::setUp(scalar cutoff, cell_radius_type radius) {
         _cutoff = cutoff;
 
         auto size = _context.get().boxSize();
-        auto desiredWidth = static_cast<scalar>((_cutoff) / static_cast<scalar>(radius));
+        auto desiredWidth = static_cast<scalar>((_cutoff + _skin) / static_cast<scalar>(radius));
         std::array<std::size_t, 3> dims{};
         for (int i = 0; i < 3; ++i) {
             dims[i] = static_cast<unsigned int>(std::max(1., std::floor(size[i] / desiredWidth)));
@@ -142,6 +152,17 @@ void CellLinkedList::setUp(scalar cutoff, cell_radius_type radius) {
     }
 }
 
+void CellLinkedList::setSkin(scalar skin) {
+    if (skin < 0) {
+        throw std::invalid_argument(fmt::format("The neighbor list skin must be non-negative but was {}", skin));
+    }
+    if (skin != _skin) {
+        _skin = skin;
+        _isSetUp = false;
+    }
+    _data.get().trackModifications(_skin > 0);
+}
+
 CompactCellLinkedList::CompactCellLinkedList(data_type &data, const readdy::model::Context &context,
                                              thread_pool &pool) : CellLinkedList(data, context, pool) {}
 
@@ -171,15 +192,6 @@ void CompactCellLinkedList::fillBins<true>() {
 
 template<>
 void CompactCellLinkedList::fillBins<false>() {
-    {/*
-        static int i = 0;
-        if(i % 100 == 0) {
-            _data.get().hilbertSort(_max_cutoff + _skin);
-            i = 0;
-        }
-        ++i;
-    */}
-
     const auto &boxSize = _context.get().boxSize();
     const auto &data = _data.get();
     const auto grainSize = data.size() / _pool.get().size();
@@ -242,9 +254,211 @@ void CompactCellLinkedList::setUpBins() {
         } else {
             fillBins<false>();
         }
+        if (_skin > 0) {
+            buildVerletLists();
+        } else {
+            _verletListsValid = false;
+        }
     } else {
         throw std::logic_error("Attempting to fill neighborlist bins, but cell structure is not set up yet");
     }
 }
 
+void CompactCellLinkedList::update() {
+    if (_isSetUp && _reorderInterval > 0 && ++_updatesSinceReorder >= _reorderInterval) {
+        // sorting permutes the particle data, hence the bins and Verlet lists are rebuilt from scratch
+        _updatesSinceReorder = 0;
+        _data.get().spatialSort(_cutoff + _skin, _reorderCurve);
+        setUpBins();
+        return;
+    }
+    updateInPlace();
+}
+
+void CompactCellLinkedList::updateInPlace() {
+    if (_verletListsValid) {
+        // the displacement check comes first, patching is wasted work if the lists are rebuilt afterwards anyway
+        const auto modified = modifiedParticles();
+        if (!verletRebuildRequired(modified)) {
+            patchVerletLists(modified);
+            return;
+        }
+    }
+    setUpBins();
+}
+
+std::size_t CompactCellLinkedList::cellOfPosition(const Vec3 &pos) const {
+    const auto &boxSize = _context.get().boxSize();
+    const auto i = static_cast<std::size_t>(std::floor((pos.x + .5 * boxSize[0]) / _cellSize.x));
+    const auto j = static_cast<std::size_t>(std::floor((pos.y + .5 * boxSize[1]) / _cellSize.y));
+    const auto k = static_cast<std::size_t>(std::floor((pos.z + .5 * boxSize[2]) / _cellSize.z));
+    return _cellIndex(i, j, k);
+}
+
+void CompactCellLinkedList::buildVerletLists() {
+    const auto &data = _data.get();
+    const auto nParticles = data.size();
+    const auto &boxSize = _context.get().boxSize();
+    const auto &pbc = _context.get().periodicBoundaryConditions();
+    const auto verletCutoffSquared = (_cutoff + _skin) * (_cutoff + _skin);
+
+    _verletLists.resize(nParticles);
+    _verletPositions.resize(nParticles);
+    _verletCells.resize(nParticles);
+
+    util::thread::parallelFor(_pool.get(), nParticles, [this, &data](std::size_t, std::size_t begin, std::size_t end) {
+        for (auto i = begin; i < end; ++i) {
+            _verletPositions[i] = (data.begin() + i)->pos;
+            _verletCells[i] = noCell;
+            _verletLists[i].clear();
+        }
+    });
+
+    // every particle is binned exactly once, so each list is only ever written by one task
+    util::thread::parallelFor(_pool.get(), nCells(), [&](std::size_t, std::size_t cellsBegin, std::size_t cellsEnd) {
+        for (auto cell = cellsBegin; cell < cellsEnd; ++cell) {
+            for (auto it = particlesBegin(cell); it != particlesEnd(cell); ++it) {
+                const auto particle = *it;
+                const auto &pos = _verletPositions[particle];
+                auto &neighbors = _verletLists[particle];
+                _verletCells[particle] = cell;
+                auto consider = [&](std::size_t neighbor) {
+                    if (bcs::distSquared(pos, _verletPositions[neighbor], boxSize, pbc) < verletCutoffSquared) {
+                        neighbors.push_back(neighbor);
+                    }
+                };
+                std::for_each(particlesBegin(cell), particlesEnd(cell), [&](std::size_t neighbor) {
+                    if (neighbor != particle) consider(neighbor);
+                });
+                for (auto itNeighCell = neighborsBegin(cell); itNeighCell != neighborsEnd(cell); ++itNeighCell) {
+                    std::for_each(particlesBegin(*itNeighCell), particlesEnd(*itNeighCell), consider);
+                }
+            }
+        }
+    });
+
+    _data.get().clearModifiedIndices();
+    _verletListsValid = true;
+}
+
+std::vector<std::size_t> CompactCellLinkedList::modifiedParticles() const {
+    const auto &indices = _data.get().modifiedIndices();
+    std::vector<std::size_t> modified (indices.begin(), indices.end());
+    std::sort(modified.begin(), modified.end());
+    modified.erase(std::unique(modified.begin(), modified.end()), modified.end());
+    return modified;
+}
+
+void CompactCellLinkedList::patchVerletLists(const std::vector<std::size_t> &modified) {
+    auto &data = _data.get();
+    if (modified.empty()) {
+        return;
+    }
+
+    const auto &boxSize = _context.get().boxSize();
+    const auto &pbc = _context.get().periodicBoundaryConditions();
+    const auto verletCutoffSquared = (_cutoff + _skin) * (_cutoff + _skin);
+
+    const auto nParticles = data.size();
+    _verletLists.resize(nParticles);
+    _verletPositions.resize(nParticles);
+    _verletCells.resize(nParticles, noCell);
+    _list.resize(nParticles + 1, 0);
+
+    for (const auto particle : modified) {
+        // detach whatever previously occupied this slot
+        for (const auto neighbor : _verletLists[particle]) {
+            auto &neighborList = _verletLists[neighbor];
+            auto it = std::find(neighborList.begin(), neighborList.end(), particle);
+            if (it != neighborList.end()) {
+                *it = neighborList.back();
+                neighborList.pop_back();
+            }
+        }
+        _verletLists[particle].clear();
+        if (_verletCells[particle] != noCell) {
+            const auto pidx = particle + 1;
+            auto &head = *_head.at(_verletCells[particle]);
+            if (head.load() == pidx) {
+                head.store(_list[pidx]);
+            } else {
+                auto previous = head.load();
+                while (_list[previous] != pidx) {
+                    previous = _list[previous];
+                }
+                _list[previous] = _list[pidx];
+            }
+            _list[pidx] = 0;
+            _verletCells[particle] = noCell;
+        }
+
+        // attach the current occupant
+        const auto &entry = data.entry_at(particle);
+        _verletPositions[particle] = entry.pos;
+        if (!entry.deactivated && particleInBox(boxSize, entry.pos)) {
+            const auto cell = cellOfPosition(entry.pos);
+            auto &head = *_head.at(cell);
+            _list[particle + 1] = head.load();
+            head.store(particle + 1);
+            _verletCells[particle] = cell;
+
+            auto attach = [&](std::size_t neighbor) {
+                if (neighbor != particle && bcs::distSquared(entry.pos, _verletPositions[neighbor], boxSize, pbc)
+                                            < verletCutoffSquared) {
+                    _verletLists[particle].push_back(neighbor);
+                    _verletLists[neighbor].push_back(particle);
+                }
+            };
+            std::for_each(particlesBegin(cell), particlesEnd(cell), attach);
+            for (auto itNeighCell = neighborsBegin(cell); itNeighCell != neighborsEnd(cell); ++itNeighCell) {
+                std::for_each(particlesBegin(*itNeighCell), particlesEnd(*itNeighCell), attach);
+            }
+        }
+    }
+    data.clearModifiedIndices();
+}
+
+bool CompactCellLinkedList::verletRebuildRequired(const std::vector<std::size_t> &modified) const {
+    const auto &data = _data.get();
+    const auto nListed = _verletLists.size();
+    // every patched particle costs a stencil search, beyond a few percent of the particles rebuilding is cheaper
+    if (data.size() < nListed || 20 * modified.size() > data.size()) {
+        return true;
+    }
+    // particles appended after the last build can only be patched in if they are among the modified ones
+    const auto firstAppended = std::lower_bound(modified.begin(), modified.end(), nListed);
+    if (static_cast<std::size_t>(std::distance(firstAppended, modified.end())) != data.size() - nListed) {
+        return true;
+    }
+
+    const auto &boxSize = _context.get().boxSize();
+    const auto &pbc = _context.get().periodicBoundaryConditions();
+    const auto maxDisplacementSquared = .25 * _skin * _skin;
+
+    std::atomic<bool> rebuild {false};
+    util::thread::parallelFor(_pool.get(), nListed, [&](std::size_t, std::size_t begin, std::size_t end) {
+        // modified particles are patched with their current positions, their displacement does not matter
+        auto nextModified = std::lower_bound(modified.begin(), modified.end(), begin);
+        auto it = data.begin() + begin;
+        for (auto i = begin; i < end && !rebuild.load(std::memory_order_relaxed); ++i, ++it) {
+            if (nextModified != modified.end() && *nextModified == i) {
+                ++nextModified;
+                continue;
+            }
+            if (it->deactivated) continue;
+            bool exceeded;
+            if (_verletCells[i] == noCell) {
+                // particles that were outside of a non-periodic box are not binned, they have to enter via rebuild
+                exceeded = particleInBox(boxSize, it->pos);
+            } else {
+                exceeded = bcs::distSquared(it->pos, _verletPositions[i], boxSize, pbc) > maxDisplacementSquared;
+            }
+            if (exceeded) {
+                rebuild.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+    return rebuild.load();
+}
+
 }
@@ -0,0 +1,174 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+
+/**
+ * Tests for the force calculation of the CPU kernel.
+ *
+ * @file TestCalculateForces.cpp
+ * @brief Tests for the CPU kernel's force calculation
+ * @date 17.10.26
+ */
+
+#include <catch2/catch.hpp>
+
+#include <readdy/kernel/cpu/CPUKernel.h>
+#include <readdy/model/RandomProvider.h>
+
+namespace cpu = readdy::kernel::cpu;
+
+TEST_CASE("Test cpu calculate forces", "[cpu]") {
+    SECTION("Half shell evaluation yields the same forces") {
+        auto skin = GENERATE(0., .5);
+        INFO(fmt::format("Testing with skin = {}", skin));
+
+        cpu::CPUKernel full;
+        cpu::CPUKernel half;
+        for (auto *kernel : {&full, &half}) {
+            auto &ctx = kernel->context();
+            ctx.boxSize() = {{10, 8, 8}};
+            ctx.periodicBoundaryConditions() = {{true, true, false}};
+            ctx.particleTypes().add("A", 1.);
+            ctx.particleTypes().add("B", 1.);
+            ctx.potentials().addHarmonicRepulsion("A", "A", 10., 1.2);
+            ctx.potentials().addHarmonicRepulsion("A", "B", 5., 1.);
+            ctx.potentials().addLennardJones("B", "B", 12, 6, 2., true, 1., 1.);
+            ctx.recordVirial() = true;
+            ctx.kernelConfiguration().cpu.neighborList.skin = skin;
+        }
+        half.context().kernelConfiguration().cpu.neighborList.halfShell = true;
+
+        const auto &types = full.context().particleTypes();
+        std::vector<readdy::model::Particle> particles;
+        for (std::size_t i = 0; i < 400; ++i) {
+            particles.emplace_back(readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                                   readdy::model::rnd::uniform_real<readdy::scalar>(-3.9, 3.9),
+                                   readdy::model::rnd::uniform_real<readdy::scalar>(-3.9, 3.9),
+                                   i % 3 == 0 ? types.idOf("B") : types.idOf("A"));
+        }
+
+        for (auto *kernel : {&full, &half}) {
+            kernel->stateModel().addParticles(particles);
+            kernel->stateModel().removeParticle(particles.at(3));
+            kernel->initialize();
+            kernel->actions().createNeighborList(kernel->context().calculateMaxCutoff())->perform();
+            kernel->actions().calculateForces()->perform();
+        }
+
+        REQUIRE(full.stateModel().energy() > 0);
+        REQUIRE(full.stateModel().energy() == Approx(half.stateModel().energy()));
+        for (std::size_t i = 0; i < 9; ++i) {
+            REQUIRE(full.getCPUKernelStateModel().virial().data()[i]
+                    == Approx(half.getCPUKernelStateModel().virial().data()[i]).margin(1e-10));
+        }
+        const auto &fullData = *full.getCPUKernelStateModel().getParticleData();
+        const auto &halfData = *half.getCPUKernelStateModel().getParticleData();
+        REQUIRE(fullData.size() == halfData.size());
+        for (std::size_t i = 0; i < fullData.size(); ++i) {
+            const auto &e1 = fullData.entry_at(i);
+            const auto &e2 = halfData.entry_at(i);
+            REQUIRE(e1.deactivated == e2.deactivated);
+            if (!e1.deactivated) {
+                REQUIRE(e1.force.x == Approx(e2.force.x).margin(1e-8));
+                REQUIRE(e1.force.y == Approx(e2.force.y).margin(1e-8));
+                REQUIRE(e1.force.z == Approx(e2.force.z).margin(1e-8));
+            }
+        }
+    }
+    SECTION("Flat bonded interactions yield the same forces") {
+        cpu::CPUKernel perTopology;
+        cpu::CPUKernel flat;
+        for (auto *kernel : {&perTopology, &flat}) {
+            auto &ctx = kernel->context();
+            ctx.boxSize() = {{20, 20, 20}};
+            ctx.particleTypes().addTopologyType("T", 1.);
+            ctx.topologyRegistry().addType("chain");
+            ctx.topologyRegistry().configureBondPotential("T", "T", {10., 1.});
+            ctx.topologyRegistry().configureAnglePotential("T", "T", "T", {2., 2.5});
+            ctx.topologyRegistry().configureTorsionPotential("T", "T", "T", "T", {1., 3, .5});
+            ctx.kernelConfiguration().cpu.threadConfig.nThreads = 3;
+        }
+        flat.context().kernelConfiguration().cpu.dataLayout.flatBondedInteractions = true;
+
+        // one long chain next to many short ones
+        std::vector<std::vector<readdy::model::Particle>> chains;
+        for (auto length : {80, 4, 4, 4, 5, 5, 5, 6, 6, 6}) {
+            chains.emplace_back();
+            for (int i = 0; i < length; ++i) {
+                chains.back().emplace_back(readdy::model::rnd::uniform_real<readdy::scalar>(-9, 9),
+                                           readdy::model::rnd::uniform_real<readdy::scalar>(-9, 9),
+                                           readdy::model::rnd::uniform_real<readdy::scalar>(-9, 9),
+                                           perTopology.context().particleTypes().idOf("T"));
+            }
+        }
+        for (auto *kernel : {&perTopology, &flat}) {
+            kernel->initialize();
+            const auto type = kernel->context().topologyRegistry().idOf("chain");
+            for (const auto &chain : chains) {
+                auto *top = kernel->stateModel().addTopology(type, chain);
+                for (std::size_t i = 0; i + 1 < chain.size(); ++i) {
+                    top->addEdge({i}, {i + 1});
+                }
+                top->configure();
+            }
+        }
+
+        auto compare = [&]() {
+            for (auto *kernel : {&perTopology, &flat}) {
+                kernel->actions().calculateForces()->perform();
+            }
+            REQUIRE(perTopology.stateModel().energy() > 0);
+            REQUIRE(perTopology.stateModel().energy() == Approx(flat.stateModel().energy()));
+            const auto &data1 = *perTopology.getCPUKernelStateModel().getParticleData();
+            const auto &data2 = *flat.getCPUKernelStateModel().getParticleData();
+            REQUIRE(data1.size() == data2.size());
+            for (std::size_t i = 0; i < data1.size(); ++i) {
+                const auto &e1 = data1.entry_at(i);
+                const auto &e2 = data2.entry_at(i);
+                REQUIRE(e1.force.x == Approx(e2.force.x).margin(1e-8));
+                REQUIRE(e1.force.y == Approx(e2.force.y).margin(1e-8));
+                REQUIRE(e1.force.z == Approx(e2.force.z).margin(1e-8));
+            }
+        };
+        compare();
+
+        // a changed graph makes the flat arrays outdated
+        for (auto *kernel : {&perTopology, &flat}) {
+            auto *top = kernel->stateModel().getTopologies().front();
+            top->addEdge({0}, {79});
+            top->configure();
+        }
+        compare();
+    }
+}
@@ -0,0 +1,238 @@
+/********************************************************************
+ * Copyright © 2018 Computational Molecular Biology Group,          *
+ *                  Freie Universität Berlin (GER)                  *
+ *                                                                  *
+ * Redistribution and use in source and binary forms, with or       *
+ * without modification, are permitted provided that the            *
+ * following conditions are met:                                    *
+ *  1. Redistributions of source code must retain the above         *
+ *     copyright notice, this list of conditions and the            *
+ *     following disclaimer.                                        *
+ *  2. Redistributions in binary form must reproduce the above      *
+ *     copyright notice, this list of conditions and the following  *
+ *     disclaimer in the documentation and/or other materials       *
+ *     provided with the distribution.                              *
+ *  3. Neither the name of the copyright holder nor the names of    *
+ *     its contributors may be used to endorse or promote products  *
+ *     derived from this software without specific                  *
+ *     prior written permission.                                    *
+ *                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND           *
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,      *
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF         *
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE         *
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR            *
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,     *
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,         *
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; *
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER *
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,      *
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)    *
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF      *
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                       *
+ ********************************************************************/
+
+
+/**
+ * Tests for the particle data containers of the CPU kernel.
+ *
+ * @file TestDataContainer.cpp
+ * @brief Tests for the CPU kernel's particle data containers
+ * @date 17.10.26
+ */
+
+#include <catch2/catch.hpp>
+
+#include <readdy/kernel/cpu/CPUKernel.h>
+#include <readdy/model/RandomProvider.h>
+#include <readdy/common/space_filling_curves.h>
+
+namespace cpu = readdy::kernel::cpu;
+
+namespace {
+
+auto setUpContext(readdy::model::Context &ctx) {
+    ctx.boxSize() = {{10, 10, 10}};
+    ctx.periodicBoundaryConditions() = {{true, true, true}};
+    ctx.particleTypes().add("A", 1.);
+    ctx.particleTypes().add("B", 1.);
+    ctx.potentials().addHarmonicRepulsion("A", "A", 10., 1.2);
+    ctx.potentials().addHarmonicRepulsion("A", "B", 5., 1.);
+}
+
+std::vector<readdy::model::Particle> randomParticles(const readdy::model::Context &ctx, std::size_t n) {
+    std::vector<readdy::model::Particle> particles;
+    particles.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        auto type = i % 3 == 0 ? ctx.particleTypes().idOf("B") : ctx.particleTypes().idOf("A");
+        particles.emplace_back(readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                               readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                               readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9), type);
+    }
+    return particles;
+}
+
+}
+
+TEST_CASE("Test cpu data containers", "[cpu]") {
+    SECTION("Spatial sort keeps particles and topologies consistent") {
+        auto curve = GENERATE(readdy::conf::cpu::SpaceFillingCurve::hilbert,
+                              readdy::conf::cpu::SpaceFillingCurve::morton);
+        cpu::CPUKernel unsorted;
+        cpu::CPUKernel sorted;
+        for (auto *kernel : {&unsorted, &sorted}) {
+            auto &ctx = kernel->context();
+            setUpContext(ctx);
+            ctx.particleTypes().add("T", 1., readdy::model::particleflavor::TOPOLOGY);
+            ctx.potentials().addHarmonicRepulsion("T", "A", 10., 1.);
+            ctx.topologyRegistry().addType("chain");
+            ctx.topologyRegistry().configureBondPotential("T", "T", {10., 1.});
+        }
+        sorted.context().kernelConfiguration().cpu.dataLayout.reorderInterval = 1;
+        sorted.context().kernelConfiguration().cpu.dataLayout.spaceFillingCurve = curve;
+
+        auto particles = randomParticles(sorted.context(), 500);
+        std::vector<readdy::model::Particle> chain;
+        for (std::size_t i = 0; i < 10; ++i) {
+            chain.emplace_back(readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                               readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                               readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                               sorted.context().particleTypes().idOf("T"));
+        }
+        for (auto *kernel : {&unsorted, &sorted}) {
+            kernel->stateModel().addParticles(particles);
+            kernel->stateModel().removeParticle(particles.at(3));
+            kernel->stateModel().removeParticle(particles.at(42));
+            auto *top = kernel->stateModel().addTopology(kernel->context().topologyRegistry().idOf("chain"), chain);
+            for (std::size_t i = 0; i + 1 < chain.size(); ++i) {
+                top->addEdge(readdy::model::top::Graph::PersistentVertexIndex{i},
+                             readdy::model::top::Graph::PersistentVertexIndex{i + 1});
+            }
+            kernel->initialize();
+            kernel->actions().createNeighborList(kernel->context().calculateMaxCutoff())->perform();
+            kernel->actions().calculateForces()->perform();
+        }
+
+        const auto &data = *sorted.getCPUKernelStateModel().getParticleData();
+        // blanks are dropped
+        REQUIRE(data.size() == particles.size() + chain.size() - 2);
+        REQUIRE(data.getNDeactivated() == 0);
+
+        // the data is ordered along the curve through the neighbor list cells
+        const auto gridWidth = sorted.context().calculateMaxCutoff();
+        auto key = [&](const readdy::Vec3 &pos) {
+            readdy::util::sfc::coordinates_type coordinates{};
+            for (int d = 0; d < 3; ++d) {
+                coordinates[d] = static_cast<readdy::util::sfc::coordinate_type>((pos[d] + 5.) / gridWidth);
+            }
+            return curve == readdy::conf::cpu::SpaceFillingCurve::hilbert ? readdy::util::sfc::hilbertIndex(coordinates)
+                                                                         : readdy::util::sfc::mortonIndex(coordinates);
+        };
+        for (std::size_t i = 1; i < data.size(); ++i) {
+            REQUIRE(key(data.entry_at(i - 1).pos) <= key(data.entry_at(i).pos));
+        }
+
+        // topology vertices still refer to the chain particles in order
+        auto topologies = sorted.stateModel().getTopologies();
+        REQUIRE(topologies.size() == 1);
+        const auto indices = topologies.front()->particleIndices();
+        REQUIRE(indices.size() == chain.size());
+        for (std::size_t i = 0; i < chain.size(); ++i) {
+            REQUIRE(data.entry_at(indices[i]).id == chain[i].id());
+            REQUIRE(data.entry_at(indices[i]).topology_index == 0);
+        }
+
+        // and so do the bonds, hence the energy is unaffected by the order
+        REQUIRE(unsorted.stateModel().energy() > 0);
+        REQUIRE(sorted.stateModel().energy() == Approx(unsorted.stateModel().energy()));
+    }
+
+    SECTION("Lookup of particles by id") {
+        cpu::CPUKernel kernel;
+        setUpContext(kernel.context());
+        auto particles = randomParticles(kernel.context(), 200);
+        kernel.stateModel().addParticles(particles);
+        auto &data = *kernel.getCPUKernelStateModel().getParticleData();
+
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            REQUIRE(data.getIndexForId(particles[i].id()) == i);
+        }
+        data.removeParticle(particles[5]);
+        REQUIRE_THROWS_AS(data.getIndexForId(particles[5].id()), std::out_of_range);
+        // the blank is reused
+        readdy::model::Particle p{0, 0, 0, particles[5].type()};
+        data.addParticle(p);
+        REQUIRE(data.getIndexForId(p.id()) == 5);
+
+        // reactions rewrite ids in place and then hand over an update
+        const auto oldId = data.entry_at(17).id;
+        data.entry_at(17).id = readdy::model::Particle::nextId();
+        data.update({{}, {42}});
+        REQUIRE(data.getIndexForId(data.entry_at(17).id) == 17);
+        REQUIRE_THROWS_AS(data.getIndexForId(oldId), std::out_of_range);
+        REQUIRE_THROWS_AS(data.getIndexForId(particles[42].id()), std::out_of_range);
+        REQUIRE(data.getIndexForId(particles[199].id()) == 199);
+    }
+
+    SECTION("Concurrent lookup of particles by id") {
+        cpu::CPUKernel kernel;
+        setUpContext(kernel.context());
+        kernel.context().kernelConfiguration().cpu.threadConfig.nThreads = 4;
+        kernel.initialize();
+        auto particles = randomParticles(kernel.context(), 500);
+        kernel.stateModel().addParticles(particles);
+        auto &data = *kernel.getCPUKernelStateModel().getParticleData();
+        // the index is dropped, the first lookups of all threads race for the rebuild
+        data.update({{}, {3}});
+
+        std::vector<std::size_t> found(particles.size(), 0);
+        {
+            std::vector<readdy::util::thread::joining_future<void>> futures;
+            for (std::size_t task = 0; task < 4; ++task) {
+                futures.emplace_back(kernel.pool().push([&, task](std::size_t) {
+                    for (auto i = task; i < particles.size(); i += 4) {
+                        try {
+                            found[i] = data.getIndexForId(particles[i].id());
+                        } catch (const std::out_of_range &) {
+                            found[i] = particles.size();
+                        }
+                    }
+                }));
+            }
+        }
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            REQUIRE(found[i] == (i == 3 ? particles.size() : i));
+        }
+    }
+
+    SECTION("Updates from buffers report the indices of new entries") {
+        cpu::CPUKernel kernel;
+        setUpContext(kernel.context());
+        auto particles = randomParticles(kernel.context(), 10);
+        kernel.stateModel().addParticles(particles);
+        auto &data = *kernel.getCPUKernelStateModel().getParticleData();
+
+        // one entry goes into the slot of a removed one, the other one is appended
+        std::vector<cpu::data::Entry> newEntries;
+        newEntries.emplace_back(readdy::Vec3(0, 0, 0), particles[0].type(), readdy::model::Particle::nextId());
+        newEntries.emplace_back(readdy::Vec3(0, 0, 0), particles[0].type(), readdy::model::Particle::nextId());
+        const auto firstId = newEntries[0].id;
+        std::vector<std::size_t> removedEntries {3};
+        std::vector<std::size_t> newIndices;
+        data.update(newEntries, removedEntries, &newIndices);
+        REQUIRE(newIndices == std::vector<std::size_t>{3, 10});
+        REQUIRE(data.entry_at(3).id == firstId);
+        REQUIRE(data.size() == 11);
+        REQUIRE(data.getNDeactivated() == 0);
+
+        // the buffers can be cleared and used again
+        newEntries.clear();
+        removedEntries.assign({5, 7});
+        newIndices.clear();
+        data.update(newEntries, removedEntries, &newIndices);
+        REQUIRE(newIndices.empty());
+        REQUIRE(data.getNDeactivated() == 2);
+        REQUIRE(data.entry_at(5).deactivated);
+        REQUIRE(data.entry_at(7).deactivated);
+    }
+}
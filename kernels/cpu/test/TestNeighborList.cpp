@@ -360,4 +360,63 @@ TEST_CASE("Test cpu neighbor list", "[cpu]") {
             reactionHandler->perform();
         }
     }
+    SECTION("Verlet lists with skin") {
+        auto &context = kernel->context();
+        context.particleTypes().add("A", .1);
+        context.particleTypes().add("B", .1);
+        scalar cutoff = 2;
+        context.reactions().addFusion("Fusion", "A", "A", "B", .1, cutoff);
+        context.reactions().addFission("Fission", "B", "A", "A", .1, 1.);
+        context.boxSize() = {{12, 10, 10}};
+        context.periodicBoundaryConditions() = {{true, true, true}};
+        context.kernelConfiguration().cpu.neighborList.skin = 1.;
+
+        for (auto i = 0; i < 300; ++i) {
+            model::Particle particle(model::rnd::uniform_real<scalar>(-6, 6), model::rnd::uniform_real<scalar>(-5, 5),
+                                     model::rnd::uniform_real<scalar>(-5, 5), context.particleTypes().idOf("A"));
+            kernel->stateModel().addParticle(particle);
+        }
+
+        kernel->initialize();
+        kernel->stateModel().initializeNeighborList(cutoff);
+
+        auto integrator = kernel->actions().eulerBDIntegrator(.1);
+        auto forces = kernel->actions().calculateForces();
+        auto reactionHandler = kernel->actions().uncontrolledApproximation(.1);
+
+        const auto &neighborList = *kernel->getCPUKernelStateModel().getNeighborList();
+        REQUIRE(neighborList.verlet());
+
+        for (auto t = 0U; t < 20U; ++t) {
+            forces->perform();
+            integrator->perform();
+            kernel->stateModel().updateNeighborList();
+            reactionHandler->perform();
+            kernel->stateModel().updateNeighborList();
+
+            const auto &data = *kernel->getCPUKernelStateModel().getParticleData();
+            std::size_t nBinned = 0;
+            for (auto cell = 0U; cell < neighborList.nCells(); ++cell) {
+                for (auto it = neighborList.particlesBegin(cell); it != neighborList.particlesEnd(cell); ++it) {
+                    ++nBinned;
+                    const auto &entry = data.entry_at(*it);
+                    REQUIRE_FALSE(entry.deactivated);
+                    std::vector<std::size_t> neighbors;
+                    neighborList.forEachNeighbor(*it, cell, [&](const std::size_t neighborIndex) {
+                        REQUIRE_FALSE(data.entry_at(neighborIndex).deactivated);
+                        neighbors.push_back(neighborIndex);
+                    });
+                    std::size_t pidx = 0;
+                    for (const auto &e : data) {
+                        if (pidx != *it && !e.deactivated && bcs::dist(entry.pos, e.pos, context.boxSize(),
+                                context.periodicBoundaryConditions()) < cutoff) {
+                            REQUIRE(std::find(neighbors.begin(), neighbors.end(), pidx) != neighbors.end());
+                        }
+                        ++pidx;
+                    }
+                }
+            }
+            REQUIRE(nBinned == data.size() - data.getNDeactivated());
+        }
+    }
 }
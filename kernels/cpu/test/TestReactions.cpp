@@ -103,7 +103,8 @@ TEST_CASE("Test cpu kernel reaction handling", "[cpu]") {
             data_t::EntriesUpdate newParticles{};
             std::vector<data_t::size_type> decayedEntries {};
 
-            reac::performReaction(&data, ctx, 0, 0, newParticles, decayedEntries, &conversion, nullptr);
+            reac::performReaction(&data, ctx, 0, 0, newParticles, decayedEntries, &conversion, nullptr,
+                                  kernel->getCPUKernelStateModel());
 
             REQUIRE(data.entry_at(0).type == conversion.getTypeTo());
             REQUIRE(data.pos(0) == readdy::Vec3(0,0,0));
@@ -123,7 +124,8 @@ TEST_CASE("Test cpu kernel reaction handling", "[cpu]") {
             particle_t p_B{-1, 0, 0, 1};
             data.addParticles({p_A, p_B});
 
-            reac::performReaction(&data, ctx, 0, 1, newParticles, decayedEntries, &fusion, nullptr);
+            reac::performReaction(&data, ctx, 0, 1, newParticles, decayedEntries, &fusion, nullptr,
+                                  kernel->getCPUKernelStateModel());
             REQUIRE(decayedEntries.size() == 2);
             REQUIRE((decayedEntries.size() == 2 && (decayedEntries.at(0) == 1 || decayedEntries.at(1) == 1)));
             data.update(std::make_pair(std::move(newParticles), std::move(decayedEntries)));
@@ -144,7 +146,8 @@ TEST_CASE("Test cpu kernel reaction handling", "[cpu]") {
             particle_t p_C{0, 0, 0, 2};
             data.addParticle(p_C);
 
-            reac::performReaction(&data, ctx, 0, 0, newParticles, decayedEntries, &fission, nullptr);
+            reac::performReaction(&data, ctx, 0, 0, newParticles, decayedEntries, &fission, nullptr,
+                                  kernel->getCPUKernelStateModel());
             data.update(std::make_pair(std::move(newParticles), std::move(decayedEntries)));
 
             REQUIRE(data.entry_at(0).type == fission.getTo1());
@@ -168,7 +171,8 @@ TEST_CASE("Test cpu kernel reaction handling", "[cpu]") {
             particle_t p_A{0, 0, 0, 0};
             particle_t p_C{5, 5, 5, 2};
             data.addParticles({p_A, p_C});
-            reac::performReaction(&data, ctx, 0, 1, newParticles, decayedEntries, &enzymatic, nullptr);
+            reac::performReaction(&data, ctx, 0, 1, newParticles, decayedEntries, &enzymatic, nullptr,
+                                  kernel->getCPUKernelStateModel());
             data.update(std::make_pair(std::move(newParticles), std::move(decayedEntries)));
             {
                 const auto &e1 = data.entry_at(0);
@@ -197,7 +201,8 @@ TEST_CASE("Test cpu kernel reaction handling", "[cpu]") {
             particle_t p_A{0, 0, 0, 0};
             particle_t p_C{5, 5, 5, 2};
             data.addParticles({p_C, p_A});
-            reac::performReaction(&data, ctx, 0, 1, newParticles, decayedEntries, &enzymatic, nullptr);
+            reac::performReaction(&data, ctx, 0, 1, newParticles, decayedEntries, &enzymatic, nullptr,
+                                  kernel->getCPUKernelStateModel());
             data.update(std::make_pair(std::move(newParticles), std::move(decayedEntries)));
             {
                 const auto &e1 = data.entry_at(0);
@@ -351,4 +356,167 @@ TEST_CASE("Test cpu kernel reaction handling", "[cpu]") {
             }) != particles.end());
         }
     }
+    SECTION("Gillespie in spatial domains") {
+        ctx.boxSize() = {{10, 10, 100}};
+        ctx.periodicBoundaryConditions() = {{false, false, false}};
+        ctx.particleTypes().add("A", 1.);
+        ctx.reactions().addFusion("fusion", "A", "A", "A", 1e16, 1.);
+        ctx.recordReactionCounts() = true;
+        ctx.recordReactionsWithPositions() = true;
+        ctx.kernelConfiguration().cpu.reactions.parallelGillespie = true;
+        ctx.kernelConfiguration().cpu.threadConfig.nThreads = 4;
+        const auto typeA = ctx.particleTypes().idOf("A");
+        // pairs of particles that are closer than the reaction radius, pairs are further apart than that, the one
+        // around z = 0 sits on the border between two domains
+        const std::size_t nPairs = 48;
+        for (std::size_t k = 0; k < nPairs; ++k) {
+            const auto z = -48. + 2. * k;
+            kernel->stateModel().addParticle({0, 0, z - .25, typeA});
+            kernel->stateModel().addParticle({0, 0, z + .25, typeA});
+        }
+        kernel->initialize();
+        REQUIRE(kernel->getNThreads() == 4);
+        auto &&initNeighborList = kernel->actions().createNeighborList(ctx.calculateMaxCutoff());
+        auto &&reactions = kernel->actions().gillespie(1);
+        initNeighborList->perform();
+        reactions->perform();
+
+        const auto particles = kernel->stateModel().getParticles();
+        REQUIRE(particles.size() == nPairs);
+        for (std::size_t k = 0; k < nPairs; ++k) {
+            const auto z = -48. + 2. * k;
+            REQUIRE(std::find_if(particles.begin(), particles.end(), [z](const particle_t &p) {
+                return std::abs(p.pos().z - z) < 1e-8;
+            }) != particles.end());
+        }
+        const auto &stateModel = kernel->getCPUKernelStateModel();
+        REQUIRE(stateModel.reactionRecords().size() == nPairs);
+        REQUIRE(stateModel.reactionCounts().at(ctx.reactions().idOf("fusion")) == nPairs);
+    }
+    SECTION("Gillespie in spatial domains agrees with serial Gillespie on average") {
+        std::vector<particle_t> particles;
+        for (std::size_t i = 0; i < 1000; ++i) {
+            particles.emplace_back(readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                                   readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                                   readdy::model::rnd::uniform_real<readdy::scalar>(-19.9, 19.9), 0);
+        }
+        auto countFusions = [&particles](bool parallelGillespie) {
+            std::size_t nFusions = 0;
+            for (int run = 0; run < 5; ++run) {
+                readdy::kernel::cpu::CPUKernel k;
+                auto &kctx = k.context();
+                kctx.boxSize() = {{10, 10, 40}};
+                kctx.particleTypes().add("A", 1.);
+                kctx.reactions().addFusion("fusion", "A", "A", "A", 1., 1.);
+                kctx.recordReactionCounts() = true;
+                kctx.kernelConfiguration().cpu.reactions.parallelGillespie = parallelGillespie;
+                kctx.kernelConfiguration().cpu.threadConfig.nThreads = 4;
+                k.stateModel().addParticles(particles);
+                k.initialize();
+
+                const readdy::scalar dt = .01;
+                auto &&integrator = k.actions().eulerBDIntegrator(dt);
+                auto &&initNeighborList = k.actions().createNeighborList(kctx.calculateMaxCutoff());
+                auto &&neighborList = k.actions().updateNeighborList();
+                auto &&reactions = k.actions().gillespie(dt);
+                initNeighborList->perform();
+                const auto fusionId = kctx.reactions().idOf("fusion");
+                for (int t = 0; t < 200; ++t) {
+                    integrator->perform();
+                    neighborList->perform();
+                    reactions->perform();
+                    nFusions += k.getCPUKernelStateModel().reactionCounts().at(fusionId);
+                }
+            }
+            return static_cast<readdy::scalar>(nFusions);
+        };
+        // the events across slab faces lose their conflicts, at this density that shifts the counts by far less than
+        // the tolerance, which is a few standard deviations of the counts
+        const auto serialFusions = countFusions(false);
+        const auto parallelFusions = countFusions(true);
+        REQUIRE(serialFusions > 1000);
+        REQUIRE(parallelFusions == Approx(serialFusions).epsilon(.15));
+    }
+    SECTION("Seeded runs do not depend on the number of threads") {
+        auto useGillespie = GENERATE(false, true);
+        std::vector<particle_t> particles;
+        for (std::size_t i = 0; i < 300; ++i) {
+            particles.emplace_back(readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                                   readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9),
+                                   readdy::model::rnd::uniform_real<readdy::scalar>(-4.9, 4.9), i % 2);
+        }
+        readdy::kernel::cpu::CPUKernel serial;
+        readdy::kernel::cpu::CPUKernel parallel;
+        for (auto *k : {&serial, &parallel}) {
+            auto &kctx = k->context();
+            kctx.boxSize() = {{10, 10, 10}};
+            kctx.particleTypes().add("A", 1.); // type id 0
+            kctx.particleTypes().add("B", .5); // type id 1
+            kctx.reactions().addDecay("A decay", "A", .5);
+            kctx.reactions().addDecay("B decay", "B", 1.);
+            // reactions creating particles draw new ids, which differ between the two kernels of this process,
+            // this one only gives the neighbor list a cutoff
+            kctx.reactions().addFusion("never", "A", "B", "A", 0., 1.);
+            kctx.kernelConfiguration().cpu.random.seed = 42;
+            kctx.kernelConfiguration().cpu.threadConfig.nThreads = k == &serial ? 1 : 4;
+            // the slabs of the parallel Gillespie depend on the number of threads, seeded runs ignore them
+            kctx.kernelConfiguration().cpu.reactions.parallelGillespie = true;
+            k->stateModel().addParticles(particles);
+            k->initialize();
+
+            const readdy::scalar dt = .01;
+            auto &&integrator = k->actions().eulerBDIntegrator(dt);
+            auto &&initNeighborList = k->actions().createNeighborList(kctx.calculateMaxCutoff());
+            auto &&neighborList = k->actions().updateNeighborList();
+            std::unique_ptr<readdy::model::actions::Action> reactions;
+            if (useGillespie) {
+                reactions = k->actions().gillespie(dt);
+            } else {
+                reactions = k->actions().uncontrolledApproximation(dt);
+            }
+            initNeighborList->perform();
+            for (int t = 0; t < 50; ++t) {
+                integrator->perform();
+                neighborList->perform();
+                reactions->perform();
+                k->stateModel().setTime(k->stateModel().time() + dt);
+            }
+        }
+        REQUIRE(serial.getNThreads() == 1);
+        REQUIRE(parallel.getNThreads() == 4);
+        auto serialParticles = serial.stateModel().getParticles();
+        auto parallelParticles = parallel.stateModel().getParticles();
+        REQUIRE(!serialParticles.empty());
+        REQUIRE(serialParticles.size() < particles.size());
+        REQUIRE(serialParticles.size() == parallelParticles.size());
+        for (std::size_t i = 0; i < serialParticles.size(); ++i) {
+            REQUIRE(serialParticles[i].id() == parallelParticles[i].id());
+            REQUIRE(serialParticles[i].type() == parallelParticles[i].type());
+            REQUIRE(serialParticles[i].pos() == parallelParticles[i].pos());
+        }
+    }
+    SECTION("Combined draw of the first order reactions of a particle") {
+        ctx.particleTypes().add("A", 1.); // type id 0
+        ctx.particleTypes().add("B", 1.); // type id 1
+        ctx.particleTypes().add("C", 1.); // type id 2
+        ctx.reactions().addConversion("A->B", "A", "B", 1.);
+        ctx.reactions().addConversion("never", "A", "C", 0.);
+        ctx.reactions().addDecay("A decay", "A", 3.);
+        const readdy::scalar dt = .1;
+        ctx.reactions().cacheProbabilities(dt, false);
+
+        const auto &registry = ctx.reactions();
+        REQUIRE(registry.order1TotalRate(0) == Approx(4.));
+        REQUIRE(registry.order1Probability(0) == Approx(1 - std::exp(-4. * dt)));
+        REQUIRE(registry.order1Probability(1) == 0);
+        REQUIRE(registry.order1ByName("A decay")->probability() == Approx(1 - std::exp(-3. * dt)));
+
+        const auto probability = registry.order1Probability(0);
+        REQUIRE_FALSE(reac::drawOrder1Reaction(registry, 0, probability));
+        REQUIRE_FALSE(reac::drawOrder1Reaction(registry, 1, 0.));
+        // the rescaled number selects the reactions proportionally to their rates, skipping the one with rate zero
+        REQUIRE(*reac::drawOrder1Reaction(registry, 0, .2 * probability) == 0);
+        REQUIRE(*reac::drawOrder1Reaction(registry, 0, .3 * probability) == 2);
+        REQUIRE(*reac::drawOrder1Reaction(registry, 0, .99 * probability) == 2);
+    }
 }
@@ -48,9 +48,12 @@
 #include <readdy/kernel/mpi/actions/MPIActionFactory.h>
 #include <readdy/kernel/mpi/observables/MPIObservableFactory.h>
 #include <readdy/kernel/mpi/model/MPIDomain.h>
+#include <readdy/kernel/mpi/pool.h>
 #include <readdy/common/Timer.h>
 
+#include <memory>
 #include <utility>
+#include <unordered_map>
 
 namespace readdy::kernel::mpi {
 
@@ -125,6 +128,28 @@ public:
         return false;
     }
 
+    void initialize() override;
+
+    void setNThreads(std::uint32_t n) {
+        _pool.resize_wait(n);
+    }
+
+    std::size_t getNThreads() const {
+        return _pool.size();
+    }
+
+    /**
+     * The threads with which a worker evaluates its domain, sized by the thread config of the MPI kernel
+     * configuration. Running fewer ranks with more threads each reduces the halo volume.
+     */
+    thread_pool &pool() {
+        return _pool;
+    }
+
+    const thread_pool &pool() const {
+        return _pool;
+    }
+
     const model::MPIDomain &domain() const {
         return _domain;
     }
@@ -133,7 +158,24 @@ public:
         return _commUsedRanks;
     }
 
+    /**
+     * Moves the domain boundaries such that each worker is responsible for a similar number of particles, this is
+     * collective over all used ranks. Particles migrate to their new workers with the next synchronization.
+     */
+    void balanceLoad();
+
+    /**
+     * The shard file of this worker at the given path, shared by all observables of this kernel that write into it,
+     * see observables::DistributedOutput. The shard is created on first use and closed with the last observable
+     * holding it.
+     * @param path the path of the shard file
+     */
+    std::shared_ptr<File> outputShard(const std::string &path);
+
     virtual void evaluateObservables(TimeStep t) override {
+        if (_domain.isWorkerRank()) {
+            _stateModel.completeSynchronizationWithNeighbors();
+        }
         if (not _domain.isIdleRank()) {
             _signal(t);
         }
@@ -145,6 +187,7 @@ protected:
     // domain needs context
     // data needs domain
     // state model needs data and domain
+    thread_pool _pool;
     model::MPIDomain _domain;
     MPIStateModel::Data _data;
     MPIStateModel _stateModel;
@@ -154,6 +197,9 @@ protected:
 
     // The communicator for the subgroup of actually used workers
     MPI_Comm _commUsedRanks = MPI_COMM_WORLD;
+
+    // shard files of distributed observable output by path
+    std::unordered_map<std::string, std::weak_ptr<File>> _outputShards;
 };
 
 }
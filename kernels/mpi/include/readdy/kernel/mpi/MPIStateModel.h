@@ -180,11 +180,11 @@ public:
     void resetReactionCounts();
 
     Particle getParticleForIndex(std::size_t index) const override {
-        return _data.get().getParticle(index);
+        return getParticleData()->getParticle(index);
     }
 
     ParticleTypeId getParticleType(std::size_t index) const override {
-        return _data.get().entry_at(index).type;
+        return getParticleData()->entry_at(index).type;
     }
 
     void toDenseParticleIndices(std::vector<std::size_t>::iterator begin,
@@ -222,39 +222,99 @@ public:
 
     void distributeParticles(const std::vector<Particle> &ps);
 
-    std::vector<MPIStateModel::Particle> gatherParticles() const;
+    std::vector<MPIStateModel::Particle> gatherParticles();
 
     /**
      * 1. fill list `own` of own-responsible particles [to be sent around]
      * 2. prepare list `other` of other-responsible particles [to be applied to self and send to other directions]
      * 3. send/receive EW (x direction)
-     *    3.1 send data `own` to east and west
+     *    3.1 send particles of `own` that lie in the halo slab facing east (west) or left the core through it
+     *        to east (west)
      *    3.2 receive data from east and west and append to `other`
      * 4. send/receive NS (y direction)
-     *    4.1 send data `own` and `other` to north and south
+     *    4.1 send particles of `own` and `other` in the halo slab facing north (south) to north (south)
      *    4.2 receive data from north and south and append to `other`
      * 5. send/receive UP (z direction)
-     *    5.1 send data `own` and `other` to up and down
+     *    5.1 send particles of `own` and `other` in the halo slab facing up (down) to up (down)
      *    5.2 receive data from up and down and append to `other`
      * --- now `other` contains all particles from all neighbors for which the worker is not responsible for
      * 6. Delete all particles in particleData that have responsible=false
      * 7. Add all particles p in `other` to particleData that have domain.isInCoreOrHalo(p.pos)
      *    and set each p.responsible flag to domain.isInDomainCore(p.pos)
      *
-     * The amount of actually sent data can be optimized by filtering out particles that will
-     * eventually be dropped by the receiving worker (because they are not in respective CoreOrHalo),
-     * but keep in mind that particles are indirectly transferred several times before arriving at the final worker,
-     * so filtering out the wrong particles might lead to falsely synchronized states.
+     * The slab of one axis is the same for all neighbors that are offset in that axis, hence particles that are
+     * indirectly transferred (e.g. to a diagonal neighbor via x and then y) are still forwarded correctly.
+     * The send lists and receive buffers are kept across calls to avoid reallocations.
+     *
+     * This is beginSynchronizationWithNeighbors() directly followed by finishSynchronizationWithNeighbors().
      **/
     void synchronizeWithNeighbors();
 
+    /**
+     * Steps 1-3.1 of synchronizeWithNeighbors(), the sends along the first axis are posted without waiting for
+     * them. Until the synchronization is finished, the particle data and the neighbor list still hold the state
+     * before the synchronization. A synchronization that is still pending is completed first.
+     */
+    void beginSynchronizationWithNeighbors();
+
+    /**
+     * Steps 3.2-7 of synchronizeWithNeighbors(), i.e. receive and forward the remaining halo particles and apply
+     * them to the particle data. Does nothing if no synchronization is pending. The neighbor list is not updated.
+     */
+    void finishSynchronizationWithNeighbors();
+
+    /**
+     * Finishes a pending synchronization and updates the neighbor list accordingly, does nothing otherwise. Actions
+     * that operate on the particle data of a worker call this first, as the synchronization started by
+     * MPIUpdateNeighborList is only finished by MPICalculateForces.
+     */
+    void completeSynchronizationWithNeighbors();
+
+    bool synchronizationPending() const {
+        return _synchronizationPending;
+    }
+
+    /**
+     * Whether any particle that a worker is responsible for moved at least one grid cell along an axis since the
+     * last synchronization. The synchronization can only be overlapped with the force evaluation if this is not the
+     * case, see CellLinkedList::interiorCells(). This is collective over the used ranks.
+     */
+    bool movedBeyondOneCell() const;
+
+    /**
+     * Counts the particles each worker is responsible for per grid cell slab of the domain decomposition along each
+     * axis and sums these counts over all workers. Afterwards every used rank knows the load of the whole system,
+     * which is the input for MPIDomain::balancedGridBoundaries.
+     * @return per axis the number of particles in each grid cell slab
+     */
+    std::array<std::vector<scalar>, 3> gatherLoad() const;
+
 private:
+    /** Fill the send lists for coordinate coord and post the sends to the neighbors along it */
+    void postSendsAlongAxis(unsigned int coord);
+
+    /** Receive from the neighbors along coordinate coord, append to `other` and wait for the posted sends */
+    void receiveAlongAxis(unsigned int coord);
+
     readdy::kernel::scpu::model::ObservableData _observableData;
     std::reference_wrapper<const readdy::model::Context> _context;
     std::reference_wrapper<Data> _data;
     NeighborList _neighborList;
     const model::MPIDomain* _domain;
     MPI_Comm _commUsedRanks = MPI_COMM_WORLD;
+
+    struct SyncBuffers {
+        std::vector<util::ParticlePOD> own;
+        std::vector<util::ParticlePOD> other;
+        std::array<std::vector<util::ParticlePOD>, 2> send;
+        std::array<std::vector<util::ParticlePOD>, 2> received;
+        std::vector<MPI_Request> requests; // pending sends, the send lists must not be touched before completion
+        std::vector<std::size_t> removedEntries; // particles that this worker is NOT responsible for
+    };
+    SyncBuffers _syncBuffers;
+    bool _synchronizationPending {false};
+    // positions of the entries right after the last synchronization, indexed like the particle data
+    std::vector<Vec3> _positionsAtSynchronization;
 };
 
 }
@@ -45,6 +45,7 @@
 
 #include <readdy/model/actions/Actions.h>
 #include <readdy/kernel/mpi/MPIKernel.h>
+#include <readdy/common/IndexWindowBuffer.h>
 
 #include <utility>
 #include <readdy/api/Saver.h>
@@ -97,6 +98,8 @@ public:
 
 private:
     MPIKernel *const kernel;
+    // one force buffer per thread for the pair potentials, kept around to avoid reallocation
+    std::vector<readdy::util::IndexWindowBuffer<Vec3>> _forceBuffers;
 
     template<bool COMPUTE_VIRIAL>
     void performImpl();
@@ -128,16 +131,34 @@ public:
     explicit MPIUpdateNeighborList(MPIKernel *kernel) : UpdateNeighborList(), kernel(kernel) {}
 
     void perform() override {
-        if (kernel->domain().isWorkerRank()) {
-            // synchronize with neighbors, do the plimpton
-            kernel->getMPIKernelStateModel().synchronizeWithNeighbors();
-            // fill neighborlist bins
-            kernel->getMPIKernelStateModel().updateNeighborList();
+        const auto loadBalanceStride = kernel->context().kernelConfiguration().mpi.loadBalanceStride;
+        if (loadBalanceStride > 0 and ++nUpdates % loadBalanceStride == 0) {
+            // move domain boundaries, particles are migrated by the following synchronization
+            kernel->balanceLoad();
+            if (kernel->domain().isWorkerRank()) {
+                // the interior cells of the new boundaries still contain particles of the old ones, the
+                // synchronization cannot be overlapped with the force evaluation
+                kernel->getMPIKernelStateModel().synchronizeWithNeighbors();
+                kernel->getMPIKernelStateModel().updateNeighborList();
+            }
+        } else if (kernel->getMPIKernelStateModel().movedBeyondOneCell()) {
+            // particles of a neighbor may arrive anywhere in the interior cells, the synchronization cannot be
+            // overlapped with the force evaluation either
+            if (kernel->domain().isWorkerRank()) {
+                kernel->getMPIKernelStateModel().synchronizeWithNeighbors();
+                kernel->getMPIKernelStateModel().updateNeighborList();
+            }
+        } else if (kernel->domain().isWorkerRank()) {
+            // synchronize with neighbors, do the plimpton. This only posts the first sends, the synchronization
+            // is finished (and the neighborlist bins filled) by MPICalculateForces after it evaluated the interior
+            // cells, or by the next action that operates on the particle data
+            kernel->getMPIKernelStateModel().beginSynchronizationWithNeighbors();
         }
     }
 
 private:
     MPIKernel *const kernel;
+    std::size_t nUpdates {0};
 };
 
 /** no-op but needed to run the default simulation loop */
@@ -154,6 +175,9 @@ public:
     void perform() override {
         const auto &ctx = kernel->context();
         const auto &compartments = ctx.compartments().get();
+        if (kernel->domain().isWorkerRank()) {
+            kernel->getMPIKernelStateModel().completeSynchronizationWithNeighbors();
+        }
         for (auto &e : *kernel->getMPIKernelStateModel().getParticleData()) {
             if (!e.deactivated) {
                 for (const auto &compartment : compartments) {
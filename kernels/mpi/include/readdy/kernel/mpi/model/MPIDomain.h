@@ -48,6 +48,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 #include <readdy/common/common.h>
 #include <readdy/model/Context.h>
 #include <mpi.h>
@@ -78,6 +82,12 @@ private:
     std::array<std::size_t, 3> _nDomainsPerAxis{};
     readdy::util::Index3D _domainIndex; // rank of (ijk) is domainIndex(i,j,k)+1
 
+    // domain boundaries lie on a regular grid, which coincides with the cells of the neighbor list,
+    // per axis there are nDomainsPerAxis+1 boundaries given in units of grid cells
+    std::array<std::size_t, 3> _nGridCellsPerAxis{};
+    Vec3 _gridCellSize;
+    std::array<std::vector<std::size_t>, 3> _gridBoundaries;
+
     /** The following members will only be defined for rank != 0 */
 
     // origin and extent define the core region of the domain
@@ -180,6 +190,30 @@ public:
         return isInDomainCoreOrHalo(pos) and not isInDomainCore(pos);
     }
 
+    /**
+     * Determines whether a position has to be sent to the neighbors along one axis, i.e. whether it lies in the slab
+     * of thickness haloThickness at the lower or upper face of this domain's core or has left the core through that
+     * face. Distances are measured from the center of the core with respect to periodic boundaries, so that particles
+     * which left the box on one side are attributed to the face they crossed.
+     * @param pos the position
+     * @param axis the axis 0, 1 or 2
+     * @return array of two flags, the first for the neighbor in -axis direction, the second for +axis direction
+     */
+    [[nodiscard]] std::array<bool, 2> haloSlabsOfPosition(const Vec3 &pos, std::uint8_t axis) const {
+        validateRankNotMaster();
+        const auto &box = _context.get().boxSize();
+        auto distance = pos[axis] - (_origin[axis] + 0.5 * _extent[axis]);
+        if (_context.get().periodicBoundaryConditions()[axis]) {
+            if (distance >= 0.5 * box[axis]) {
+                distance -= box[axis];
+            } else if (distance < -0.5 * box[axis]) {
+                distance += box[axis];
+            }
+        }
+        const auto innerBoundary = 0.5 * _extent[axis] - _haloThickness;
+        return {distance < -innerBoundary, distance >= innerBoundary};
+    }
+
     [[nodiscard]] const Vec3 &origin() const {
         validateRankNotMaster();
         return _origin;
@@ -248,8 +282,9 @@ public:
             auto ijkOfOtherRank = _domainIndex.inverse(otherRank - 1);
             Vec3 origin, extent;
             for (std::size_t i = 0; i < 3; ++i) {
-                extent[i] = boxSize[i] / static_cast<scalar>(_nDomainsPerAxis[i]);
-                origin[i] = -0.5 * boxSize[i] + ijkOfOtherRank[i] * extent[i];
+                const auto &boundaries = _gridBoundaries[i];
+                extent[i] = (boundaries[ijkOfOtherRank[i] + 1] - boundaries[ijkOfOtherRank[i]]) * _gridCellSize[i];
+                origin[i] = -0.5 * boxSize[i] + boundaries[ijkOfOtherRank[i]] * _gridCellSize[i];
                 //originWithHalo[i] = origin[i] - haloThickness;
                 //extentWithHalo[i] = extent[i] + 2 * haloThickness;
             }
@@ -278,17 +313,122 @@ public:
     }
 
     [[nodiscard]] std::array<std::size_t, 3> ijkOfPosition(const Vec3 &pos) const {
+        const auto cell = gridCellOfPosition(pos);
+        std::array<std::size_t, 3> ijk{};
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            const auto &boundaries = _gridBoundaries[axis];
+            ijk[axis] = static_cast<std::size_t>(
+                    std::upper_bound(boundaries.begin(), boundaries.end(), cell[axis]) - boundaries.begin() - 1);
+        }
+        return ijk;
+    }
+
+    [[nodiscard]] std::array<std::size_t, 3> gridCellOfPosition(const Vec3 &pos) const {
         const auto &boxSize = _context.get().boxSize();
         if (!(-.5 * boxSize[0] <= pos.x && .5 * boxSize[0] > pos.x
               && -.5 * boxSize[1] <= pos.y && .5 * boxSize[1] > pos.y
               && -.5 * boxSize[2] <= pos.z && .5 * boxSize[2] > pos.z)) {
-            throw std::logic_error(fmt::format("ijkOfPosition: position {} was out of bounds.", pos));
+            throw std::logic_error(fmt::format("gridCellOfPosition: position {} was out of bounds.", pos));
+        }
+        std::array<std::size_t, 3> cell{};
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            cell[axis] = std::min(_nGridCellsPerAxis[axis] - 1, static_cast<std::size_t>(
+                    std::floor((pos[axis] + .5 * boxSize[axis]) / _gridCellSize[axis])));
+        }
+        return cell;
+    }
+
+    [[nodiscard]] const std::array<std::size_t, 3> &nGridCellsPerAxis() const {
+        return _nGridCellsPerAxis;
+    }
+
+    [[nodiscard]] const Vec3 &gridCellSize() const {
+        return _gridCellSize;
+    }
+
+    /**
+     * @return per axis the nDomainsPerAxis+1 domain boundaries in units of grid cells
+     */
+    [[nodiscard]] const std::array<std::vector<std::size_t>, 3> &gridBoundaries() const {
+        return _gridBoundaries;
+    }
+
+    /**
+     * Moves the domain boundaries, the neighborship between domains is not affected by this. Boundaries must start
+     * at 0, end at nGridCellsPerAxis and each domain that has neighbors must be at least twice as wide as the halo.
+     * @param boundaries per axis the nDomainsPerAxis+1 domain boundaries in units of grid cells
+     */
+    void setGridBoundaries(std::array<std::vector<std::size_t>, 3> boundaries) {
+        for (std::uint8_t axis = 0; axis < 3; ++axis) {
+            const auto &b = boundaries[axis];
+            if (b.size() != _nDomainsPerAxis[axis] + 1 or b.front() != 0 or b.back() != _nGridCellsPerAxis[axis]) {
+                throw std::invalid_argument(fmt::format("Invalid domain boundaries {} along axis {}", b, axis));
+            }
+            for (std::size_t i = 1; i < b.size(); ++i) {
+                if (b[i] < b[i - 1] + minGridCellsPerDomain(axis)) {
+                    throw std::invalid_argument(fmt::format(
+                            "Domain {} along axis {} is too narrow with boundaries {}", i - 1, axis, b));
+                }
+            }
+        }
+        _gridBoundaries = std::move(boundaries);
+        if (isWorkerRank()) {
+            updateCoreRegion();
+        }
+    }
+
+    /**
+     * Calculates domain boundaries that distribute the given load evenly along each axis. Each boundary is placed at
+     * the quantile of the load projected onto that axis, but moves at most up to the adjacent current boundary,
+     * so that particles only have to migrate to direct neighbors. Domains keep at least twice the halo thickness.
+     * If these constraints cannot be met the current boundaries of that axis are kept.
+     * @param load per axis the load (e.g. number of particles) of each grid cell slab along that axis
+     * @return the new boundaries, can be passed to setGridBoundaries
+     */
+    [[nodiscard]] std::array<std::vector<std::size_t>, 3>
+    balancedGridBoundaries(const std::array<std::vector<scalar>, 3> &load) const {
+        std::array<std::vector<std::size_t>, 3> result{_gridBoundaries};
+        for (std::uint8_t axis = 0; axis < 3; ++axis) {
+            const auto n = _nDomainsPerAxis[axis];
+            const auto nCells = _nGridCellsPerAxis[axis];
+            const auto &current = _gridBoundaries[axis];
+            if (n == 1 or load[axis].size() != nCells) {
+                continue;
+            }
+            std::vector<scalar> cumulative(nCells + 1, 0.);
+            std::partial_sum(load[axis].begin(), load[axis].end(), cumulative.begin() + 1);
+            const auto total = cumulative.back();
+            if (total <= 0.) {
+                continue;
+            }
+
+            const auto minCells = minGridCellsPerDomain(axis);
+            std::vector<std::size_t> b(current);
+            for (std::size_t k = 1; k < n; ++k) {
+                const auto target = total * static_cast<scalar>(k) / static_cast<scalar>(n);
+                const auto quantile = static_cast<std::size_t>(
+                        std::lower_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin());
+                b[k] = std::clamp(quantile, current[k - 1], current[k + 1]);
+            }
+            for (std::size_t k = 1; k < n; ++k) {
+                b[k] = std::max(b[k], b[k - 1] + minCells);
+            }
+            for (std::size_t k = n - 1; k > 0; --k) {
+                b[k] = std::min(b[k], b[k + 1] - minCells);
+            }
+
+            bool valid = true;
+            for (std::size_t k = 1; k <= n; ++k) {
+                valid &= b[k] >= b[k - 1] + minCells;
+                if (k < n) {
+                    valid &= current[k - 1] <= b[k] and b[k] <= current[k + 1];
+                }
+            }
+            if (valid) {
+                result[axis] = std::move(b);
+            }
         }
-        return {
-                        static_cast<std::size_t>(std::floor((pos.x + .5 * boxSize[0]) / _extent.x)),
-                        static_cast<std::size_t>(std::floor((pos.y + .5 * boxSize[1]) / _extent.y)),
-                        static_cast<std::size_t>(std::floor((pos.z + .5 * boxSize[2]) / _extent.z))
-                };
+        return result;
     }
 
     [[nodiscard]] std::string describe() const {
@@ -448,18 +588,47 @@ private:
         _nIdleRanks = _worldSize - _nUsedRanks;
 
         _domainIndex = readdy::util::Index3D(_nDomainsPerAxis[0], _nDomainsPerAxis[1], _nDomainsPerAxis[2]);
+
+        // initially all domains have the same number of grid cells, which are at least as wide as the cutoff
+        const auto cutoff = _context.get().calculateMaxCutoff();
+        for (std::size_t i = 0; i < 3; ++i) {
+            const auto domainWidth = boxSize[i] / static_cast<scalar>(_nDomainsPerAxis[i]);
+            const auto cellsPerDomain = static_cast<std::size_t>(std::max(1., std::floor(domainWidth / cutoff)));
+            _nGridCellsPerAxis[i] = cellsPerDomain * _nDomainsPerAxis[i];
+            _gridCellSize[i] = boxSize[i] / static_cast<scalar>(_nGridCellsPerAxis[i]);
+            _gridBoundaries[i].resize(_nDomainsPerAxis[i] + 1);
+            for (std::size_t k = 0; k <= _nDomainsPerAxis[i]; ++k) {
+                _gridBoundaries[i][k] = k * cellsPerDomain;
+            }
+        }
     }
 
-    void setupWorker() {
+    /** Minimal number of grid cells of a domain along axis, such that halo regions do not overlap */
+    [[nodiscard]] std::size_t minGridCellsPerDomain(std::uint8_t axis) const {
+        if (_nDomainsPerAxis[axis] == 1 and not _context.get().periodicBoundaryConditions()[axis]) {
+            return 1;
+        }
+        const auto cells = static_cast<std::size_t>(std::ceil(2. * _haloThickness / _gridCellSize[axis] - 1e-6));
+        const auto initialCells = _nGridCellsPerAxis[axis] / _nDomainsPerAxis[axis];
+        return std::clamp(cells, static_cast<std::size_t>(1), initialCells);
+    }
+
+    /** Core and halo region of this worker from its grid boundaries */
+    void updateCoreRegion() {
         const auto &boxSize = _context.get().boxSize();
-        // find out which this ranks' ijk coordinates are, consider -1 because of master rank 0
-        _myIdx = _domainIndex.inverse(_rank - 1);
         for (std::size_t i = 0; i < 3; ++i) {
-            _extent[i] = boxSize[i] / static_cast<scalar>(_nDomainsPerAxis[i]);
-            _origin[i] = -0.5 * boxSize[i] + _myIdx[i] * _extent[i];
+            const auto &boundaries = _gridBoundaries[i];
+            _origin[i] = -0.5 * boxSize[i] + boundaries[_myIdx[i]] * _gridCellSize[i];
+            _extent[i] = (boundaries[_myIdx[i] + 1] - boundaries[_myIdx[i]]) * _gridCellSize[i];
             _originWithHalo[i] = _origin[i] - _haloThickness;
             _extentWithHalo[i] = _extent[i] + 2 * _haloThickness;
         }
+    }
+
+    void setupWorker() {
+        // find out which this ranks' ijk coordinates are, consider -1 because of master rank 0
+        _myIdx = _domainIndex.inverse(_rank - 1);
+        updateCoreRegion();
 
         // set up neighbors, i.e. the adjacency between domains
         for (int di = -1; di < 2; ++di) {
@@ -82,17 +82,32 @@ public:
      */
     CellLinkedList(Data &data, const readdy::model::Context &context, const model::MPIDomain *domain)
             : _data(data), _context(context), _head{}, _list{}, _domain(domain) {
+        setUp();
+    }
+
+    /**
+     * Sets up the cell structure for the current boundaries of the domain, i.e. this has to be called again
+     * after the domain boundaries were moved.
+     */
+    void setUp() {
         if (_domain->isWorkerRank()) {
-            // Each domain is subdivided into `cellsExtent[coord]` cells along axis coord
-            // This guarantees that domain boundaries are also cell boundaries
+            _cellsInCore.clear();
+            _cellsInHalo.clear();
+            _interiorCells.clear();
+            _boundaryCells.clear();
+            _cellNeighbors.clear();
+            // Each domain is subdivided into `cellsExtent[coord]` cells along axis coord, the cells are the
+            // grid cells of the domain. This guarantees that domain boundaries are also cell boundaries
             const auto boxSize = _context.get().boxSize();
             std::array<std::size_t, 3> nCellsPerAxis{};
             std::array<std::size_t, 3> cellsExtent{}; // number of cells per domain per axis
             std::array<std::size_t, 3> cellsOrigin{}; // ijk of this domain's origin cell, i.e. the lower left cell
             for (std::size_t coord = 0; coord < 3; ++coord) {
-                cellsExtent[coord] = static_cast<std::size_t>(std::max(1., std::floor(_domain->extent()[coord] / _context.get().calculateMaxCutoff())));
-                cellsOrigin[coord] = _domain->myIdx()[coord] * cellsExtent[coord];
-                nCellsPerAxis[coord] = cellsExtent[coord] * _domain->nDomainsPerAxis()[coord];
+                const auto &boundaries = _domain->gridBoundaries()[coord];
+                const auto myIdx = _domain->myIdx()[coord];
+                cellsExtent[coord] = boundaries[myIdx + 1] - boundaries[myIdx];
+                cellsOrigin[coord] = boundaries[myIdx];
+                nCellsPerAxis[coord] = _domain->nGridCellsPerAxis()[coord];
                 _cellSize[coord] = boxSize[coord] / static_cast<scalar>(nCellsPerAxis[coord]);
             }
 
@@ -106,6 +121,11 @@ public:
                             const auto cellIdx = _cellIndex(i,j,k);
                             _cellsInCore.push_back(cellIdx);
                             _cellNeighbors[cellIdx] = {}; // default initialize neighbors of cell, only relevant if this is the only cell
+                            if (isInteriorCell({i, j, k}, cellsOrigin, cellsExtent)) {
+                                _interiorCells.push_back(cellIdx);
+                            } else {
+                                _boundaryCells.push_back(cellIdx);
+                            }
 
                             // for di,dj,dk, this also reaches neighbor cells that overlap with halo
                             for (int di=-1; di<2; ++di) {
@@ -124,6 +144,8 @@ public:
 
                 // clean up, why not
                 std::sort(_cellsInCore.begin(), _cellsInCore.end());
+                std::sort(_interiorCells.begin(), _interiorCells.end());
+                std::sort(_boundaryCells.begin(), _boundaryCells.end());
 
                 // remove duplicates out of _cellsInHalo
                 std::sort(_cellsInHalo.begin(), _cellsInHalo.end());
@@ -191,13 +213,47 @@ public:
         return _cellsInHalo;
     }
 
+    /**
+     * Core cells that are at least two cells away from the core boundary towards every neighboring domain.
+     * Neither they nor their neighbor cells contain halo particles, and as long as no particle moved a whole
+     * cell since the last synchronization, synchronizing with the neighbors does not change which particles they
+     * contain. Thus their pairs can be evaluated while the synchronization is still in flight.
+     * MPIUpdateNeighborList checks the displacements and synchronizes fully otherwise.
+     */
+    const std::vector<std::size_t> &interiorCells() const {
+        return _interiorCells;
+    }
+
+    /** Core cells that are not interior cells, i.e. their pairs require the synchronized halo */
+    const std::vector<std::size_t> &boundaryCells() const {
+        return _boundaryCells;
+    }
+
     /**
      * Function f is evaluated for each pair (e1, e2) of data entries that are potentially interacting,
      * i.e. (e1, e2) live in neighboring cells or in the same cell.
      * Identical permuted pairs (e2, e1) will not be evaluated.
      **/
     template<typename Function>
-    void forAllPairs(const Function &f);
+    void forAllPairs(const Function &f) {
+        // due to the neighborhood structure, all pairs can be reached via the neighbors of core cells
+        // (might change, but the result would be the same)
+        forAllPairsOfCells(cellsInCore(), f);
+    }
+
+    /**
+     * Like forAllPairs but only for the pairs that are reached via the neighborhood of the given core cells.
+     * Each pair belongs to exactly one core cell, so interiorCells() and boundaryCells() together yield all pairs.
+     */
+    template<typename Function>
+    void forAllPairsOfCells(const std::vector<std::size_t> &cells, const Function &f);
+
+    /**
+     * Like forAllPairsOfCells for the cells in [cellsBegin, cellsEnd), but f is called with the indices of the two
+     * data entries. This does not modify the neighbor list, so disjoint cell ranges can be processed concurrently.
+     */
+    template<typename CellIterator, typename Function>
+    void forAllIndexPairsOfCells(CellIterator cellsBegin, CellIterator cellsEnd, const Function &f) const;
 
     std::size_t nCells() const {
         if (_domain->isWorkerRank()) {
@@ -208,9 +264,9 @@ public:
         }
     }
 
-    BoxIterator particlesBegin(std::size_t cellIndex);
+    BoxIterator particlesBegin(std::size_t cellIndex) const;
 
-    BoxIterator particlesEnd(std::size_t cellIndex);
+    BoxIterator particlesEnd(std::size_t cellIndex) const;
 
     void update() {
         if (_domain->isWorkerRank()) {
@@ -270,12 +326,29 @@ protected:
     // keep track which cells are in the core of the domain and which cells overlap with the halo region
     std::vector<std::size_t> _cellsInCore;
     std::vector<std::size_t> _cellsInHalo;
+    // partition of _cellsInCore into cells that are unaffected by the synchronization and those that are not
+    std::vector<std::size_t> _interiorCells;
+    std::vector<std::size_t> _boundaryCells;
 
     std::reference_wrapper<Data> _data;
     std::reference_wrapper<const readdy::model::Context> _context;
     const model::MPIDomain * _domain;
 
 private:
+    bool isInteriorCell(std::array<int, 3> cell, const std::array<std::size_t, 3> &cellsOrigin,
+                        const std::array<std::size_t, 3> &cellsExtent) const {
+        for (std::size_t axis = 0; axis < 3; ++axis) {
+            if (_domain->nDomainsPerAxis()[axis] > 1) {
+                const auto origin = static_cast<int>(cellsOrigin[axis]);
+                const auto last = static_cast<int>(cellsOrigin[axis] + cellsExtent[axis]) - 1;
+                if (cell[axis] - origin < 2 or last - cell[axis] < 2) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
     /** Add the cell indicated by otherCell (3D index) to the neighborhood of thisCell*/
     void addNeighborCell(std::array<int, 3> thisCell, std::array<int, 3> otherCell) {
         auto cellIdx = _cellIndex.index(thisCell);
@@ -381,35 +454,40 @@ private:
     std::size_t _state, _val;
 };
 
-// no const iterator, because head is lazily default constructed if an unknown cellIndex is requested
-inline BoxIterator CellLinkedList::particlesBegin(std::size_t cellIndex) {
-    return {*this, _head[cellIndex]};
+// cells without particles have no entry in head, they are represented by the terminator 0
+inline BoxIterator CellLinkedList::particlesBegin(std::size_t cellIndex) const {
+    const auto it = _head.find(cellIndex);
+    return {*this, it != _head.end() ? it->second : 0};
 }
 
-inline BoxIterator CellLinkedList::particlesEnd(std::size_t /*cellIndex*/) {
+inline BoxIterator CellLinkedList::particlesEnd(std::size_t /*cellIndex*/) const {
     return {*this, 0};
 }
 
 template<typename Function>
-inline void CellLinkedList::forAllPairs(const Function &f) {
-    // due to the neighborhood structure, all pairs can be reached via the neighbors of core cells
-    // (might change, but the result would be the same)
+inline void CellLinkedList::forAllPairsOfCells(const std::vector<std::size_t> &cells, const Function &f) {
     auto &data = _data.get();
-    for (const auto &cellIdx : cellsInCore()) {
+    forAllIndexPairsOfCells(cells.begin(), cells.end(), [&](std::size_t i, std::size_t j) {
+        f(data.entry_at(i), data.entry_at(j));
+    });
+}
+
+template<typename CellIterator, typename Function>
+inline void CellLinkedList::forAllIndexPairsOfCells(CellIterator cellsBegin, CellIterator cellsEnd,
+                                                    const Function &f) const {
+    for (auto itCell = cellsBegin; itCell != cellsEnd; ++itCell) {
+        const auto cellIdx = *itCell;
         for (auto boxIt1 = particlesBegin(cellIdx); boxIt1 != particlesEnd(cellIdx); ++boxIt1) {
-            auto &entry1 = data.entry_at(*boxIt1);
             // neighbors within cell
             for (auto boxIt2 = particlesBegin(cellIdx); boxIt2 != particlesEnd(cellIdx); ++boxIt2) {
                 if (*boxIt1 < *boxIt2) { // avoid double counting of permuted pairs
-                    auto &entry2 = data.entry_at(*boxIt2);
-                    f(entry1, entry2);
+                    f(*boxIt1, *boxIt2);
                 }
             }
             // neighbors in adjacent cells
             for (auto itNeighCell = neighborsBegin(cellIdx); itNeighCell != neighborsEnd(cellIdx); ++itNeighCell) {
                 for (auto boxIt2 = particlesBegin(*itNeighCell); boxIt2 != particlesEnd(*itNeighCell); ++boxIt2) {
-                    auto &entry2 = data.entry_at(*boxIt2);
-                    f(entry1, entry2);
+                    f(*boxIt1, *boxIt2);
                 }
             }
         }
@@ -118,8 +118,10 @@ public:
                 const auto idx = _blanks.back();
                 _blanks.pop_back();
                 entries.at(idx) = entry;
+                indexEntry(idx);
             } else {
                 entries.emplace_back(entry);
+                indexEntry(entries.size() - 1);
             }
         }
     }
@@ -114,6 +114,12 @@ inline void sendObjects(int targetRank, const std::vector<T> &objects, const MPI
              targetRank, tags::transmitObjects, comm);
 }
 
+template<typename T>
+inline void isendObjects(int targetRank, const std::vector<T> &objects, const MPI_Comm &comm, MPI_Request *request) {
+    MPI_Isend((void *) objects.data(), static_cast<int>(objects.size() * sizeof(T)), MPI_BYTE,
+              targetRank, tags::transmitObjects, comm, request);
+}
+
 inline std::ostream &operator<<(std::ostream& os, readdy::kernel::mpi::model::MPIDomain::NeighborType n) {
     switch(n) {
         case readdy::kernel::mpi::model::MPIDomain::NeighborType::self: os << "self"; break;
@@ -123,57 +129,34 @@ inline std::ostream &operator<<(std::ostream& os, readdy::kernel::mpi::model::MP
     return os;
 }
 
-inline std::vector<util::ParticlePOD>
-sendThenReceive(std::array<std::size_t, 3> otherDirection, std::vector<util::ParticlePOD> &own,
-                std::vector<util::ParticlePOD> &other, const model::MPIDomain &domain, const MPI_Comm &comm) {
+/**
+ * Post a non-blocking send of objects to the neighbor in otherDirection, the request is appended to requests.
+ * The objects must not be modified until the request has completed. Nothing happens if there is no regular
+ * neighbor in that direction.
+ * @param otherDirection direction of the neighbor in the 3x3x3 neighborhood, (1,1,1) is self
+ */
+inline void postSendToNeighbor(std::array<std::size_t, 3> otherDirection,
+                               const std::vector<util::ParticlePOD> &objects, std::vector<MPI_Request> &requests,
+                               const model::MPIDomain &domain, const MPI_Comm &comm) {
     const auto otherFlatIndex = domain.neighborIndex.index(otherDirection);
-    const auto nType = domain.neighborTypes().at(otherFlatIndex);
-    const auto otherRank = domain.neighborRanks().at(otherFlatIndex);
-    //readdy::log::trace("rank={}, sendThenReceive, otherRank {}, otherType {}", domain.rank(), otherRank, nType);
-    if (nType == model::MPIDomain::NeighborType::regular) {
-        // send
-        std::vector<util::ParticlePOD> objects;
-        objects.insert(objects.end(), own.begin(), own.end());
-        objects.insert(objects.end(), other.begin(), other.end());
-        readdy::util::Timer t1("sendThenReceive.sendObjects");
-        util::sendObjects(otherRank, objects, comm);
-        t1.stop();
-        //readdy::log::trace("rank={}, sendThenReceive.sent", domain.rank());
-        // receive
-        readdy::util::Timer t2("sendThenReceive.receiveObjects");
-        auto received = util::receiveObjects<util::ParticlePOD>(otherRank, comm);
-        t2.stop();
-        //readdy::log::trace("rank={}, sendThenReceive.received", domain.rank());
-        return received;
-    } else {
-        return {};
+    if (domain.neighborTypes().at(otherFlatIndex) == model::MPIDomain::NeighborType::regular) {
+        const auto otherRank = domain.neighborRanks().at(otherFlatIndex);
+        requests.emplace_back();
+        isendObjects(otherRank, objects, comm, &requests.back());
     }
 }
 
-inline std::vector<util::ParticlePOD>
-receiveThenSend(std::array<std::size_t, 3> otherDirection, std::vector<util::ParticlePOD> &own,
-                std::vector<util::ParticlePOD> &other, const model::MPIDomain &domain, const MPI_Comm &comm) {
+/**
+ * Receive the objects sent by the neighbor in otherDirection and append them to received, this blocks until the
+ * message has arrived. Nothing happens if there is no regular neighbor in that direction.
+ */
+inline void receiveFromNeighbor(std::array<std::size_t, 3> otherDirection, std::vector<util::ParticlePOD> &received,
+                                const model::MPIDomain &domain, const MPI_Comm &comm) {
     const auto otherFlatIndex = domain.neighborIndex.index(otherDirection);
-    const auto nType = domain.neighborTypes().at(otherFlatIndex);
-    const auto otherRank = domain.neighborRanks().at(otherFlatIndex);
-    //readdy::log::trace("rank={}, receiveThenSend, otherRank {}, otherType {}", domain.rank(), otherRank, nType);
-    if (nType == model::MPIDomain::NeighborType::regular) {
-        // receive
-        readdy::util::Timer t1("receiveThenSend.receiveObjects");
-        auto received = util::receiveObjects<util::ParticlePOD>(otherRank, comm);
-        t1.stop();
-        //readdy::log::trace("rank={}, receiveThenSend.received", domain.rank());
-        // send
-        std::vector<util::ParticlePOD> objects;
-        objects.insert(objects.end(), own.begin(), own.end());
-        objects.insert(objects.end(), other.begin(), other.end());
-        readdy::util::Timer t2("receiveThenSend.sendObjects");
-        util::sendObjects(otherRank, objects, comm);
-        t2.stop();
-        //readdy::log::trace("rank={}, receiveThenSend.sent", domain.rank());
-        return received;
-    } else {
-        return {};
+    if (domain.neighborTypes().at(otherFlatIndex) == model::MPIDomain::NeighborType::regular) {
+        const auto otherRank = domain.neighborRanks().at(otherFlatIndex);
+        readdy::util::Timer t("receiveFromNeighbor.receiveObjects");
+        util::receiveAppendObjects(otherRank, received, comm);
     }
 }
 
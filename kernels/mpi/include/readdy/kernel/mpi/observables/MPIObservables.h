@@ -38,6 +38,10 @@
  * @author chrisfroe
  * @date 03.06.19
  *
+ * Per default the results are gathered on the master rank which writes them. For the observables that scale with
+ * the number of particles (positions, particles, forces) there is a distributed output mode, in which every worker
+ * writes its own shard file, see DistributedOutput.
+ *
  * todo: https://support.hdfgroup.org/HDF5/PHDF5/ ?
  */
 
@@ -55,6 +59,43 @@ class MPIKernel;
 
 namespace observables {
 
+/**
+ * Decides where an observable that scales with the number of particles is written. If the distributedOutput flag of
+ * the MPI kernel configuration is set, each worker writes the particles it is responsible for into a shard file
+ * next to the output file, i.e. "out.h5" yields "out.rank1.h5", "out.rank2.h5", ..., and the master rank only
+ * records the file names of the shards in the group of the observable in a json data set "shards". The python
+ * Trajectory reader reassembles the frames from the shards. Otherwise the results are gathered on the master rank.
+ * Note that in distributed mode callbacks, which are only invoked on the master rank, see no particles.
+ */
+class DistributedOutput {
+public:
+    explicit DistributedOutput(MPIKernel *kernel);
+
+    /**
+     * Whether the results stay on the workers instead of being gathered on the master rank
+     */
+    [[nodiscard]] bool enabled() const {
+        return _enabled;
+    }
+
+    /**
+     * Whether this rank writes results, i.e. the workers in distributed mode and the master rank otherwise
+     */
+    [[nodiscard]] bool writes() const;
+
+    /**
+     * Prepares the output of the observable's data set, collective over the used ranks. In distributed mode the
+     * shards are named after the file of the master rank, the workers' files are not written to.
+     * @return the file into which this rank writes the data set, nullptr if it does not write
+     */
+    File *initialize(File &file, const std::string &dataSetName);
+
+private:
+    MPIKernel *kernel;
+    bool _enabled;
+    std::shared_ptr<File> _shard{nullptr};
+};
+
 class MPIEnergy : public readdy::model::observables::Energy {
 public:
     MPIEnergy(MPIKernel *kernel, Stride stride);
@@ -99,6 +140,8 @@ protected:
     void append() override;
 
     void initializeDataSet(File &file, const std::string &dataSetName, Stride flushStride) override;
+
+    DistributedOutput output;
 };
 
 class MPIParticles : public readdy::model::observables::Particles {
@@ -114,6 +157,8 @@ protected:
     void append() override;
 
     void initializeDataSet(File &file, const std::string &dataSetName, Stride flushStride) override;
+
+    DistributedOutput output;
 };
 
 class MPIHistogramAlongAxis : public readdy::model::observables::HistogramAlongAxis {
@@ -165,6 +210,8 @@ protected:
     void append() override;
 
     void initializeDataSet(File &file, const std::string &dataSetName, Stride flushStride) override;
+
+    DistributedOutput output;
 };
 
 class MPIReactions : public readdy::model::observables::Reactions {
@@ -50,7 +50,8 @@ MPIKernel::MPIKernel() : MPIKernel(readdy::model::Context{}) {}
 
 // pay attention to order of initialization, which is defined by class hierarchy, then by order of declaration
 MPIKernel::MPIKernel(const readdy::model::Context &ctx)
-        : Kernel(name, ctx), _domain(_context), _data(&_domain), _actions(this), _observables(this),
+        : Kernel(name, ctx), _pool(_context.kernelConfiguration().mpi.threadConfig.getNThreads()),
+          _domain(_context), _data(&_domain), _actions(this), _observables(this),
           _stateModel(_data, _context, &_domain) {
     // Description of decomposition
     if (_domain.isMasterRank()) {
@@ -90,6 +91,42 @@ MPIKernel::MPIKernel(const readdy::model::Context &ctx)
     _stateModel.virial() = Matrix33{{{0, 0, 0, 0, 0, 0, 0, 0, 0}}};
 }
 
+void MPIKernel::initialize() {
+    readdy::model::Kernel::initialize();
+    setNThreads(static_cast<std::uint32_t>(context().kernelConfiguration().mpi.threadConfig.getNThreads()));
+}
+
+void MPIKernel::balanceLoad() {
+    if (_domain.isIdleRank()) {
+        return;
+    }
+    readdy::util::Timer timer("MPIKernel::balanceLoad");
+    if (_domain.isWorkerRank()) {
+        _stateModel.completeSynchronizationWithNeighbors();
+    }
+    _domain.setGridBoundaries(_domain.balancedGridBoundaries(_stateModel.gatherLoad()));
+    if (_domain.isWorkerRank()) {
+        _stateModel.getNeighborList().setUp();
+    }
+}
+
+std::shared_ptr<File> MPIKernel::outputShard(const std::string &path) {
+    for (auto it = _outputShards.begin(); it != _outputShards.end();) {
+        if (it->second.expired()) {
+            it = _outputShards.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    auto &shard = _outputShards[path];
+    if (auto existing = shard.lock()) {
+        return existing;
+    }
+    auto created = File::create(path, File::Flag::OVERWRITE);
+    shard = created;
+    return created;
+}
+
 const std::string MPIKernel::name = "MPI";
 
 readdy::model::Kernel *MPIKernel::create(const readdy::model::Context &ctx) {
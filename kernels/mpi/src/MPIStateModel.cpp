@@ -43,6 +43,7 @@
 
 #include <readdy/kernel/mpi/MPIStateModel.h>
 #include <readdy/common/Timer.h>
+#include <readdy/common/boundary_condition_operations.h>
 
 namespace readdy::kernel::mpi {
 
@@ -61,7 +62,7 @@ std::vector<readdy::Vec3> MPIStateModel::getParticlePositions() const {
 
 // encapsulate the following combination of Gather and Gatherv, e.g. for gathering particles or observables
 std::vector<MPIStateModel::Particle>
-MPIStateModel::gatherParticles() const {
+MPIStateModel::gatherParticles() {
     if (_domain->isIdleRank()) {
         return {};
     }
@@ -69,8 +70,10 @@ MPIStateModel::gatherParticles() const {
 
     std::vector<util::ParticlePOD> thinParticles;
     if (_domain->isWorkerRank()) {
+        // this is collective anyway, so a pending synchronization can be completed here
+        completeSynchronizationWithNeighbors();
         // prepare send data
-        for (const MPIEntry &entry : _data.get()) {
+        for (const MPIEntry &entry : *getParticleData()) {
             if (not entry.deactivated and entry.responsible) {
                 thinParticles.emplace_back(entry);
             }
@@ -110,7 +113,7 @@ void MPIStateModel::resetReactionCounts() {
 void MPIStateModel::toDenseParticleIndices(
         std::vector<std::size_t>::iterator begin,
         std::vector<std::size_t>::iterator end) const {
-    const auto &blanks = _data.get().blanks();
+    const auto &blanks = getParticleData()->blanks();
     std::transform(begin, end, begin, [&blanks](const std::size_t &ix) {
         auto result = ix;
         for (auto blankIx : blanks) {
@@ -214,13 +217,24 @@ void MPIStateModel::addParticle(const MPIStateModel::Particle &p) {
 //                        MPI_Datatype sendtype, void* recvbuf, int recvcount,
 //                        MPI_Datatype recvtype, MPI_Comm comm)
 void MPIStateModel::synchronizeWithNeighbors() {
+    beginSynchronizationWithNeighbors();
+    finishSynchronizationWithNeighbors();
+}
+
+void MPIStateModel::beginSynchronizationWithNeighbors() {
     if (domain()->isIdleRank() or domain()->isMasterRank()) {
         return;
     }
-    readdy::util::Timer timer("MPIStateModel::synchronizeWithNeighbors");
+    // a previous synchronization that was not completed by an action still has to be applied
+    completeSynchronizationWithNeighbors();
+    readdy::util::Timer timer("MPIStateModel::beginSynchronizationWithNeighbors");
     auto& data = _data.get();
-    std::vector<util::ParticlePOD> own; // particles that this worker is responsible for
-    std::vector<std::size_t> removedEntries; // particles that this worker is NOT responsible for
+    auto &own = _syncBuffers.own; // particles that this worker is responsible for
+    auto &other = _syncBuffers.other; // particles received by other workers
+    auto &removedEntries = _syncBuffers.removedEntries; // particles that this worker is NOT responsible for
+    own.clear();
+    other.clear();
+    removedEntries.clear();
 
     // gather own responsible and prepare data structure
     // i.e. gather to-be-removed indices,
@@ -231,56 +245,41 @@ void MPIStateModel::synchronizeWithNeighbors() {
             own.emplace_back(entry);
             if (domain()->isInDomainHalo(entry.pos)) {
                 entry.responsible = false;
+            } else if (not domain()->isInDomainCore(entry.pos)) {
+                // e.g. after the domain boundaries were moved, the particle is taken over by a neighbor
+                removedEntries.push_back(i);
             }
         } else if (not entry.deactivated and not entry.responsible) {
             removedEntries.push_back(i);
         }
     }
 
-    readdy::util::Timer t1("MPIStateModel::synchronizeWithNeighbors.plimpton");
-    const auto &pbc = _context.get().periodicBoundaryConditions();
-    // Plimpton synchronization
-    std::vector<util::ParticlePOD> other; // particles received by other workers
-    for (unsigned int coord=0; coord<3; coord++) { // east-west, north-south, up-down
-        const auto idx = domain()->myIdx()[coord];
-        if (idx % 2 == 0) {
-            // send + then receive +
-            std::array<std::size_t, 3> otherDirection {1,1,1}; // (1,1,1) is self
-            otherDirection.at(coord) += 1;
-            auto received1 = util::sendThenReceive(otherDirection, own, other, *domain(), commUsedRanks());
-
-            // receive - then send -
-            otherDirection = {1,1,1};
-            otherDirection.at(coord) -= 1;
-            std::vector<util::ParticlePOD> received2;
-            if (domain()->nDomainsPerAxis()[coord] == 2 and pbc[coord]) {
-                // skip because we have already communicated with that one
-            } else {
-                received2 = util::receiveThenSend(otherDirection, own, other, *domain(), commUsedRanks());
-            }
-            // after data from both directions have been received we can merge them with `other`,
-            // so they will be communicated along other coordinates
-            other.insert(other.end(), received1.begin(), received1.end());
-            other.insert(other.end(), received2.begin(), received2.end());
-        } else {
-            // receive - then send -
-            std::array<std::size_t, 3> otherDirection {1,1,1};
-            otherDirection.at(coord) -= 1;
-            auto received1 = util::receiveThenSend(otherDirection, own, other, *domain(), commUsedRanks());
-
-            // send + then receive +
-            otherDirection = {1,1,1};
-            otherDirection.at(coord) += 1;
-            std::vector<util::ParticlePOD> received2;
-            if (domain()->nDomainsPerAxis()[coord] == 2 and pbc[coord]) {
-                // skip because we have already communicated with that one
-            } else {
-                received2 = util::sendThenReceive(otherDirection, own, other, *domain(), commUsedRanks());
-            }
+    // Plimpton synchronization, the first coordinate only depends on `own` and can be sent right away
+    postSendsAlongAxis(0);
+    _synchronizationPending = true;
+}
 
-            other.insert(other.end(), received1.begin(), received1.end());
-            other.insert(other.end(), received2.begin(), received2.end());
-        }
+void MPIStateModel::completeSynchronizationWithNeighbors() {
+    if (_synchronizationPending) {
+        finishSynchronizationWithNeighbors();
+        _neighborList.update();
+    }
+}
+
+void MPIStateModel::finishSynchronizationWithNeighbors() {
+    if (not _synchronizationPending) {
+        return;
+    }
+    readdy::util::Timer timer("MPIStateModel::finishSynchronizationWithNeighbors");
+    auto &data = _data.get();
+    auto &other = _syncBuffers.other;
+
+    // Plimpton synchronization, continued
+    readdy::util::Timer t1("MPIStateModel::finishSynchronizationWithNeighbors.plimpton");
+    receiveAlongAxis(0);
+    for (unsigned int coord=1; coord<3; coord++) { // north-south, up-down
+        postSendsAlongAxis(coord);
+        receiveAlongAxis(coord);
     }
     t1.stop();
 
@@ -301,8 +300,140 @@ void MPIStateModel::synchronizeWithNeighbors() {
             // does not get added
         }
     }
-    auto update = std::make_pair(std::move(newEntries), std::move(removedEntries));
+    auto update = std::make_pair(std::move(newEntries), std::move(_syncBuffers.removedEntries));
     data.update(std::move(update));
+    _synchronizationPending = false;
+
+    _positionsAtSynchronization.resize(data.size());
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        _positionsAtSynchronization[i] = data.entry_at(i).pos;
+    }
+}
+
+bool MPIStateModel::movedBeyondOneCell() const {
+    if (domain()->isIdleRank()) {
+        return false;
+    }
+    int moved = 0;
+    if (domain()->isWorkerRank()) {
+        const auto &data = *getParticleData();
+        if (data.size() != _positionsAtSynchronization.size()) {
+            // entries were added or removed without synchronizing, their previous positions are unknown
+            moved = 1;
+        } else {
+            const auto &box = _context.get().boxSize();
+            const auto &pbc = _context.get().periodicBoundaryConditions();
+            const auto &nCells = domain()->nGridCellsPerAxis();
+            for (std::size_t i = 0; i < data.size() and moved == 0; ++i) {
+                const auto &entry = data.entry_at(i);
+                if (not entry.deactivated and entry.responsible) {
+                    const auto difference = bcs::shortestDifference(_positionsAtSynchronization[i], entry.pos,
+                                                                    box.data(), pbc.data());
+                    for (std::size_t axis = 0; axis < 3; ++axis) {
+                        if (std::abs(difference[axis]) >= box[axis] / static_cast<scalar>(nCells[axis])) {
+                            moved = 1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &moved, 1, MPI_INT, MPI_MAX, _commUsedRanks);
+    return moved != 0;
+}
+
+void MPIStateModel::postSendsAlongAxis(unsigned int coord) {
+    // only the particles in the halo slab facing a neighbor (or which left the core through that face)
+    // are sent to it, particles received along previous coordinates are forwarded the same way
+    const auto &pbc = _context.get().periodicBoundaryConditions();
+    const bool sameNeighborBothSides = domain()->nDomainsPerAxis()[coord] == 2 and pbc[coord];
+    auto &[sendMinus, sendPlus] = _syncBuffers.send;
+    sendMinus.clear();
+    sendPlus.clear();
+    for (const auto *particles : {&_syncBuffers.own, &_syncBuffers.other}) {
+        for (const auto &p : *particles) {
+            const auto [toMinus, toPlus] = domain()->haloSlabsOfPosition(p.position, coord);
+            if (sameNeighborBothSides) {
+                if (toMinus or toPlus) {
+                    sendPlus.push_back(p);
+                }
+            } else {
+                if (toMinus) {
+                    sendMinus.push_back(p);
+                }
+                if (toPlus) {
+                    sendPlus.push_back(p);
+                }
+            }
+        }
+    }
+
+    std::array<std::size_t, 3> plusDirection {1,1,1}; // (1,1,1) is self
+    plusDirection.at(coord) += 1;
+    std::array<std::size_t, 3> minusDirection {1,1,1};
+    minusDirection.at(coord) -= 1;
+    util::postSendToNeighbor(plusDirection, sendPlus, _syncBuffers.requests, *domain(), commUsedRanks());
+    if (not sameNeighborBothSides) {
+        // otherwise the neighbor in - direction is the one in + direction, for which the send list was prepared
+        util::postSendToNeighbor(minusDirection, sendMinus, _syncBuffers.requests, *domain(), commUsedRanks());
+    }
+}
+
+void MPIStateModel::receiveAlongAxis(unsigned int coord) {
+    const auto &pbc = _context.get().periodicBoundaryConditions();
+    const bool sameNeighborBothSides = domain()->nDomainsPerAxis()[coord] == 2 and pbc[coord];
+    auto &[received1, received2] = _syncBuffers.received;
+    auto &requests = _syncBuffers.requests;
+    received1.clear();
+    received2.clear();
+
+    std::array<std::size_t, 3> plusDirection {1,1,1};
+    plusDirection.at(coord) += 1;
+    std::array<std::size_t, 3> minusDirection {1,1,1};
+    minusDirection.at(coord) -= 1;
+    // the sends are non-blocking, so receiving in any order cannot dead-lock
+    util::receiveFromNeighbor(plusDirection, received1, *domain(), commUsedRanks());
+    if (not sameNeighborBothSides) {
+        util::receiveFromNeighbor(minusDirection, received2, *domain(), commUsedRanks());
+    }
+    // the send lists are reused for the next coordinate
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+    requests.clear();
+
+    // after data from both directions have been received we can merge them with `other`,
+    // so they will be communicated along other coordinates
+    auto &other = _syncBuffers.other;
+    other.insert(other.end(), received1.begin(), received1.end());
+    other.insert(other.end(), received2.begin(), received2.end());
+}
+
+std::array<std::vector<scalar>, 3> MPIStateModel::gatherLoad() const {
+    if (domain()->isIdleRank()) {
+        return {};
+    }
+    readdy::util::Timer timer("MPIStateModel::gatherLoad");
+    const auto &nCells = domain()->nGridCellsPerAxis();
+    // flat layout: cells along x, then y, then z
+    std::vector<scalar> counts(nCells[0] + nCells[1] + nCells[2], 0.);
+    if (domain()->isWorkerRank()) {
+        for (const auto &entry : *getParticleData()) {
+            if (not entry.deactivated and entry.responsible) {
+                const auto cell = domain()->gridCellOfPosition(entry.pos);
+                counts[cell[0]] += 1.;
+                counts[nCells[0] + cell[1]] += 1.;
+                counts[nCells[0] + nCells[1] + cell[2]] += 1.;
+            }
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, counts.data(), static_cast<int>(counts.size()), MPI_DOUBLE, MPI_SUM, _commUsedRanks);
+
+    std::array<std::vector<scalar>, 3> load;
+    auto it = counts.begin();
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        load[axis].assign(it, it + nCells[axis]);
+        it += nCells[axis];
+    }
+    return load;
 }
 
 }
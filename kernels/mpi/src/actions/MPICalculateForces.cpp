@@ -43,6 +43,7 @@
 
 #include <readdy/kernel/mpi/actions/MPIActions.h>
 #include <readdy/common/boundary_condition_operations.h>
+#include <readdy/common/thread/parallel_for.h>
 
 namespace readdy::kernel::mpi::actions {
 
@@ -63,8 +64,15 @@ template<bool COMPUTE_VIRIAL>
 void MPICalculateForces::performImpl() {
     const auto &context = kernel->context();
     auto &stateModel = kernel->getMPIKernelStateModel();
+    // If the synchronization with the neighbors is still in flight, the pairs of interior cells are evaluated
+    // first, they do not depend on the halo. Meanwhile the particle data and neighborlist still hold the state before
+    // the synchronization, see CellLinkedList::interiorCells()
+    const bool overlapSynchronization = stateModel.synchronizationPending();
     auto &data = *stateModel.getParticleData();
     auto &neighborList = stateModel.getNeighborList();
+    if (overlapSynchronization) {
+        neighborList.update();
+    }
 
     stateModel.energy() = 0;
     stateModel.virial() = Matrix33{{{0, 0, 0, 0, 0, 0, 0, 0, 0}}};
@@ -77,11 +85,23 @@ void MPICalculateForces::performImpl() {
         });
     }
 
-    auto order1eval = [&](MPIEntry &entry){
-        if (entry.responsible) {
-            for (const auto &po1 : potentials.potentialsOf(entry.type)) {
-                po1->calculateForceAndEnergy(entry.force, stateModel.energy(), entry.position());
+    auto &pool = kernel->pool();
+
+    // each range of particles accumulates its energy separately
+    auto evaluateOrder1 = [&]() {
+        std::vector<scalar> energies(readdy::util::thread::nRanges(pool, data.size()), 0);
+        readdy::util::thread::parallelFor(pool, data.size(), [&](std::size_t task, std::size_t begin, std::size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                auto &entry = data.entry_at(i);
+                if (!entry.deactivated and entry.responsible) {
+                    for (const auto &po1 : potentials.potentialsOf(entry.type)) {
+                        po1->calculateForceAndEnergy(entry.force, energies[task], entry.position());
+                    }
+                }
             }
+        });
+        for (const auto e : energies) {
+            stateModel.energy() += e;
         }
     };
 
@@ -89,7 +109,10 @@ void MPICalculateForces::performImpl() {
     const auto &box = context.boxSize().data();
     const auto &pbc = context.periodicBoundaryConditions().data();
 
-    auto order2eval = [&](MPIEntry &entry, MPIEntry &neighborEntry) {
+    auto order2eval = [&](std::size_t i, std::size_t j, readdy::util::IndexWindowBuffer<Vec3> &forces,
+                          scalar &energy, Matrix33 &virial) {
+        const auto &entry = data.entry_at(i);
+        const auto &neighborEntry = data.entry_at(j);
         const auto &pots = potentials.potentialsOrder2(entry.type);
         auto itPot = pots.find(neighborEntry.type);
         if (itPot != std::end(pots)) {
@@ -104,13 +127,13 @@ void MPICalculateForces::performImpl() {
             for (const auto &potential : itPot->second) {
                 potential->calculateForceAndEnergy(forceVec, energyUpdate, x_ij);
             }
-            entry.force += forceVec;
-            neighborEntry.force -= forceVec;
+            forces[i] += forceVec;
+            forces[j] -= forceVec;
 
             if (bothResponsible) {
-                stateModel.energy() += energyUpdate;
+                energy += energyUpdate;
             } else if (oneResponsible) {
-                stateModel.energy() += 0.5 * energyUpdate;
+                energy += 0.5 * energyUpdate;
             } else if (noResponsible) {
                 // noop
             } else {
@@ -122,9 +145,9 @@ void MPICalculateForces::performImpl() {
                 detail::computeVirial<COMPUTE_VIRIAL>(x_ij, forceVec, virialUpdate);
 
                 if (bothResponsible) {
-                    stateModel.virial() += virialUpdate;
+                    virial += virialUpdate;
                 } else if (oneResponsible) {
-                    stateModel.virial() += 0.5 * virialUpdate;
+                    virial += 0.5 * virialUpdate;
                 } else if (noResponsible) {
                     // noop
                 } else {
@@ -134,10 +157,65 @@ void MPICalculateForces::performImpl() {
         }
     };
 
-    auto noop = [](readdy::model::top::GraphTopology* topology){};
-    std::vector<readdy::model::top::GraphTopology*> empty;
+    // The cells are split among the threads. Since both particles of a pair receive a force, each range of cells
+    // accumulates into its own force buffer, the buffers are afterwards reduced over ranges of particles. A buffer
+    // only covers the window of particle indices its cells touch.
+    auto evaluateOrder2 = [&](const std::vector<std::size_t> &cells) {
+        if (potentials.potentialsOrder2().empty()) {
+            return;
+        }
+        const auto nParticles = data.size();
+        const auto nBuffers = readdy::util::thread::nRanges(pool, cells.size());
+        if (_forceBuffers.size() < nBuffers) {
+            _forceBuffers.resize(nBuffers);
+        }
+        std::vector<scalar> energies(nBuffers, 0);
+        std::vector<Matrix33> virials(nBuffers, Matrix33{{{0, 0, 0, 0, 0, 0, 0, 0, 0}}});
+        readdy::util::thread::parallelFor(pool, cells.size(), [&](std::size_t task, std::size_t begin,
+                                                                  std::size_t end) {
+            auto &forces = _forceBuffers[task];
+            {
+                // the window starts out covering the particles of the task's cells and grows to their neighbors
+                auto first = nParticles;
+                std::size_t last = 0;
+                for (auto cell = cells.begin() + begin; cell != cells.begin() + end; ++cell) {
+                    for (auto it = neighborList.particlesBegin(*cell); it != neighborList.particlesEnd(*cell); ++it) {
+                        first = std::min(first, *it);
+                        last = std::max(last, *it + 1);
+                    }
+                }
+                forces.reset(first, std::max(first, last), nParticles);
+            }
+            neighborList.forAllIndexPairsOfCells(cells.begin() + begin, cells.begin() + end,
+                                                 [&](std::size_t i, std::size_t j) {
+                order2eval(i, j, forces, energies[task], virials[task]);
+            });
+        });
+        readdy::util::thread::parallelFor(pool, nParticles, [&](std::size_t, std::size_t begin, std::size_t end) {
+            for (std::size_t buffer = 0; buffer < nBuffers; ++buffer) {
+                _forceBuffers[buffer].forEachIn(begin, end, [&data](std::size_t i, const Vec3 &force) {
+                    data.entry_at(i).force += force;
+                });
+            }
+        });
+        for (std::size_t buffer = 0; buffer < nBuffers; ++buffer) {
+            stateModel.energy() += energies[buffer];
+            stateModel.virial() += virials[buffer];
+        }
+    };
 
-    readdy::kernel::mpi::util::evaluateOnContainers(data, order1eval, neighborList, order2eval, empty, noop);
+    if (overlapSynchronization) {
+        evaluateOrder2(neighborList.interiorCells());
+
+        // entries in interior cells keep their index, and new entries come with zero force
+        stateModel.completeSynchronizationWithNeighbors();
+
+        evaluateOrder1();
+        evaluateOrder2(neighborList.boundaryCells());
+    } else {
+        evaluateOrder1();
+        evaluateOrder2(neighborList.cellsInCore());
+    }
 }
 
 template void MPICalculateForces::performImpl<true>();
@@ -41,6 +41,7 @@
 
 #include <readdy/kernel/mpi/actions/MPIActions.h>
 #include <readdy/common/boundary_condition_operations.h>
+#include <readdy/common/thread/parallel_for.h>
 
 namespace readdy::kernel::mpi::actions {
 
@@ -51,18 +52,24 @@ void MPIEulerBDIntegrator::perform() {
         const auto &kbt = context.kBT();
         const auto &box = context.boxSize().data();
         auto& stateModel = kernel->getMPIKernelStateModel();
+        stateModel.completeSynchronizationWithNeighbors();
         auto pd = stateModel.getParticleData();
-        for(auto& entry : *pd) {
-            if(!entry.is_deactivated() and entry.responsible) {
-                const scalar D = context.particleTypes().diffusionConstantOf(entry.type);
-                const auto randomDisplacement = std::sqrt(2. * D * _timeStep) *
-                                                (readdy::model::rnd::normal3<readdy::scalar>());
-                entry.pos += randomDisplacement;
-                const auto deterministicDisplacement = entry.force * _timeStep * D / kbt;
-                entry.pos += deterministicDisplacement;
-                bcs::fixPosition(entry.pos, box, pbc);
+        // the random numbers are drawn from thread local generators
+        readdy::util::thread::parallelFor(kernel->pool(), pd->size(), [&](std::size_t, std::size_t begin,
+                                                                          std::size_t end) {
+            for (auto i = begin; i < end; ++i) {
+                auto &entry = pd->entry_at(i);
+                if(!entry.is_deactivated() and entry.responsible) {
+                    const scalar D = context.particleTypes().diffusionConstantOf(entry.type);
+                    const auto randomDisplacement = std::sqrt(2. * D * _timeStep) *
+                                                    (readdy::model::rnd::normal3<readdy::scalar>());
+                    entry.pos += randomDisplacement;
+                    const auto deterministicDisplacement = entry.force * _timeStep * D / kbt;
+                    entry.pos += deterministicDisplacement;
+                    bcs::fixPosition(entry.pos, box, pbc);
+                }
             }
-        }
+        });
     } else {
         readdy::log::trace("MPIEulerBDIntegrator::perform is noop for non workers");
     }
@@ -43,11 +43,85 @@
  */
 
 #include <utility>
+#include <hdf5.h>
+#include <json.hpp>
 #include <readdy/kernel/mpi/observables/MPIObservables.h>
 #include <readdy/kernel/mpi/MPIKernel.h>
+#include <readdy/model/observables/io/Types.h>
 
 namespace readdy::kernel::mpi::observables {
 
+namespace {
+std::string filePath(File &file) {
+    const auto size = H5Fget_name(file.id(), nullptr, 0);
+    if (size < 0) {
+        throw std::runtime_error("could not determine the path of the output file");
+    }
+    std::string path(static_cast<std::size_t>(size) + 1, '\0');
+    H5Fget_name(file.id(), path.data(), path.size());
+    path.resize(static_cast<std::size_t>(size));
+    return path;
+}
+
+/** "dir/out.h5" becomes "dir/out.rank3.h5" */
+std::string shardPath(const std::string &path, int rank) {
+    const auto slash = path.find_last_of('/');
+    const auto dot = path.find_last_of('.');
+    const bool hasExtension = dot != std::string::npos and (slash == std::string::npos or dot > slash);
+    const auto stem = hasExtension ? path.substr(0, dot) : path;
+    const auto extension = hasExtension ? path.substr(dot) : std::string(".h5");
+    return fmt::format("{}.rank{}{}", stem, rank, extension);
+}
+
+std::string baseName(const std::string &path) {
+    const auto slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/** Sends the string of the master rank to all used ranks */
+std::string broadcastFromMaster(std::string value, const MPI_Comm &comm) {
+    auto size = static_cast<unsigned long>(value.size());
+    MPI_Bcast(&size, 1, MPI_UNSIGNED_LONG, 0, comm);
+    value.resize(size);
+    MPI_Bcast(value.data(), static_cast<int>(size), MPI_CHAR, 0, comm);
+    return value;
+}
+}
+
+DistributedOutput::DistributedOutput(MPIKernel *kernel)
+        : kernel(kernel), _enabled(kernel->context().kernelConfiguration().mpi.distributedOutput) {}
+
+bool DistributedOutput::writes() const {
+    return _enabled ? kernel->domain().isWorkerRank() : kernel->domain().isMasterRank();
+}
+
+File *DistributedOutput::initialize(File &file, const std::string &dataSetName) {
+    const auto &domain = kernel->domain();
+    if (not _enabled) {
+        return domain.isMasterRank() ? &file : nullptr;
+    }
+    if (domain.isIdleRank()) {
+        return nullptr;
+    }
+    // the shards are named after the master's output file, the files passed on the workers are not used
+    const auto path = broadcastFromMaster(domain.isMasterRank() ? filePath(file) : std::string(),
+                                          kernel->commUsedRanks());
+    if (domain.isWorkerRank()) {
+        _shard = kernel->outputShard(shardPath(path, domain.rank()));
+        return _shard.get();
+    }
+    if (domain.isMasterRank()) {
+        // the shards are referenced relative to the output file, so that the files can be moved together
+        std::vector<std::string> shards;
+        for (int rank = 1; rank < domain.nUsedRanks(); ++rank) {
+            shards.push_back(baseName(shardPath(path, rank)));
+        }
+        auto group = file.createGroup(std::string(rmou::OBSERVABLES_GROUP_PATH) + "/" + dataSetName);
+        group.write("shards", nlohmann::json(shards).dump());
+    }
+    return nullptr;
+}
+
 MPIVirial::MPIVirial(MPIKernel *kernel, Stride stride) : Virial(kernel, stride), kernel(kernel) {}
 
 void MPIVirial::evaluate() {
@@ -79,7 +153,7 @@ void MPIVirial::initializeDataSet(File &file, const std::string &dataSetName, St
 }
 
 MPIPositions::MPIPositions(MPIKernel *kernel, unsigned int stride, const std::vector<std::string> &typesToCount)
-        : Positions(kernel, stride, typesToCount), kernel(kernel) {}
+        : Positions(kernel, stride, typesToCount), kernel(kernel), output(kernel) {}
 
 void MPIPositions::evaluate() {
     result.clear();
@@ -102,22 +176,25 @@ void MPIPositions::evaluate() {
             }
         }
     }
-    result = util::gatherObjects(result, 0, kernel->domain(), kernel->commUsedRanks());
+    if (not output.enabled()) {
+        result = util::gatherObjects(result, 0, kernel->domain(), kernel->commUsedRanks());
+    }
 }
 
 void MPIPositions::append() {
-    if (kernel->domain().isMasterRank()) {
+    if (output.writes()) {
         Positions::append();
     }
 }
 
 void MPIPositions::initializeDataSet(File &file, const std::string &dataSetName, Stride flushStride) {
-    if (kernel->domain().isMasterRank()) {
-        Positions::initializeDataSet(file, dataSetName, flushStride);
+    if (auto *target = output.initialize(file, dataSetName)) {
+        Positions::initializeDataSet(*target, dataSetName, flushStride);
     }
 }
 
-MPIParticles::MPIParticles(MPIKernel *kernel, unsigned int stride) : Particles(kernel, stride), kernel(kernel) {}
+MPIParticles::MPIParticles(MPIKernel *kernel, unsigned int stride)
+        : Particles(kernel, stride), kernel(kernel), output(kernel) {}
 
 void MPIParticles::evaluate() {
     auto &resultTypes = std::get<0>(result);
@@ -126,6 +203,19 @@ void MPIParticles::evaluate() {
     resultTypes.clear();
     resultIds.clear();
     resultPositions.clear();
+    if (output.enabled()) {
+        if (kernel->domain().isWorkerRank()) {
+            const auto data = kernel->getMPIKernelStateModel().getParticleData();
+            for (const auto &entry : *data) {
+                if (not entry.deactivated and entry.responsible) {
+                    resultTypes.push_back(entry.type);
+                    resultIds.push_back(entry.id);
+                    resultPositions.push_back(entry.pos);
+                }
+            }
+        }
+        return;
+    }
     auto particles = kernel->getMPIKernelStateModel().gatherParticles();
     if (kernel->domain().isMasterRank()) {
         for (const auto &p : particles) {
@@ -137,14 +227,14 @@ void MPIParticles::evaluate() {
 }
 
 void MPIParticles::append() {
-    if (kernel->domain().isMasterRank()) {
+    if (output.writes()) {
         Particles::append();
     }
 }
 
 void MPIParticles::initializeDataSet(File &file, const std::string &dataSetName, Stride flushStride) {
-    if (kernel->domain().isMasterRank()) {
-        Particles::initializeDataSet(file, dataSetName, flushStride);
+    if (auto *target = output.initialize(file, dataSetName)) {
+        Particles::initializeDataSet(*target, dataSetName, flushStride);
     }
 }
 
@@ -244,7 +334,7 @@ void MPINParticles::initializeDataSet(File &file, const std::string &dataSetName
 }
 
 MPIForces::MPIForces(MPIKernel *kernel, unsigned int stride, std::vector<std::string> typesToCount)
-        : Forces(kernel, stride, std::move(typesToCount)), kernel(kernel) {}
+        : Forces(kernel, stride, std::move(typesToCount)), kernel(kernel), output(kernel) {}
 
 void MPIForces::evaluate() {
     result.clear();
@@ -268,18 +358,20 @@ void MPIForces::evaluate() {
             }
         }
     }
-    result = util::gatherObjects(result, 0, kernel->domain(), kernel->commUsedRanks());
+    if (not output.enabled()) {
+        result = util::gatherObjects(result, 0, kernel->domain(), kernel->commUsedRanks());
+    }
 }
 
 void MPIForces::append() {
-    if (kernel->domain().isMasterRank()) {
+    if (output.writes()) {
         Forces::append();
     }
 }
 
 void MPIForces::initializeDataSet(File &file, const std::string &dataSetName, Stride flushStride) {
-    if (kernel->domain().isMasterRank()) {
-        Forces::initializeDataSet(file, dataSetName, flushStride);
+    if (auto *target = output.initialize(file, dataSetName)) {
+        Forces::initializeDataSet(*target, dataSetName, flushStride);
     }
 }
 
@@ -215,6 +215,66 @@ TEST_CASE("Test domain decomposition", "[mpi]") {
         CHECK(nwDomain.isInDomainHalo(pos));
     }
 
+    SECTION("Halo slabs facing the neighbors") {
+        context.boxSize() = {20., 10., 1.};
+        context.periodicBoundaryConditions() = {true, true, false};
+        context.kernelConfiguration().mpi.dx = 4.6;
+        context.kernelConfiguration().mpi.dy = 4.6;
+        context.kernelConfiguration().mpi.dz = 0.9;
+        int worldSize = 1 + (4 * 2 * 1);
+        MPIMock::mpiCommWorld.worldSize = worldSize;
+        MPIMock::mpiCommWorld.rank = 0;
+        const auto rank = readdy::kernel::mpi::model::MPIDomain(context).rankOfPosition({-7.5, -2.5, 0.});
+        MPIMock::mpiCommWorld.rank = rank;
+        readdy::kernel::mpi::model::MPIDomain domain(context);
+        // core spans [-10, -5) in x and [-5, 0) in y, halo thickness is 2.3
+        CHECK(domain.haloSlabsOfPosition({-7.5, -2.5, 0.}, 0) == std::array<bool, 2>{false, false});
+        CHECK(domain.haloSlabsOfPosition({-9., -2.5, 0.}, 0) == std::array<bool, 2>{true, false});
+        CHECK(domain.haloSlabsOfPosition({-5.2, -2.5, 0.}, 0) == std::array<bool, 2>{false, true});
+        // left the core through the lower x face and was wrapped to the other side of the box
+        CHECK(domain.haloSlabsOfPosition({9.5, -2.5, 0.}, 0) == std::array<bool, 2>{true, false});
+        // left the core through the upper x face
+        CHECK(domain.haloSlabsOfPosition({-4., -2.5, 0.}, 0) == std::array<bool, 2>{false, true});
+        CHECK(domain.haloSlabsOfPosition({-7.5, -4., 0.}, 1) == std::array<bool, 2>{true, false});
+        CHECK(domain.haloSlabsOfPosition({-7.5, -0.1, 0.}, 1) == std::array<bool, 2>{false, true});
+    }
+
+    SECTION("Balance domain boundaries") {
+        context.boxSize() = {40., 1., 1.};
+        context.periodicBoundaryConditions() = {false, false, false};
+        context.kernelConfiguration().mpi.dx = 9.9;
+        context.kernelConfiguration().mpi.dy = 0.9;
+        context.kernelConfiguration().mpi.dz = 0.9;
+        MPIMock::mpiCommWorld.worldSize = 1 + 4;
+        MPIMock::mpiCommWorld.rank = 1;
+        readdy::kernel::mpi::model::MPIDomain domain(context);
+        REQUIRE(domain.nDomainsPerAxis() == std::array<std::size_t, 3>({4, 1, 1}));
+        // four grid cells of width 2.5 per domain
+        REQUIRE(domain.nGridCellsPerAxis()[0] == 16);
+        CHECK(domain.gridBoundaries()[0] == std::vector<std::size_t>{0, 4, 8, 12, 16});
+
+        // all the load is in the first domain, boundaries move at most up to the next boundary
+        // and keep domains at least twice as wide as the halo, i.e. two grid cells
+        std::array<std::vector<readdy::scalar>, 3> load{std::vector<readdy::scalar>(16, 0.), {1.}, {1.}};
+        std::fill_n(load[0].begin(), 4, 1.);
+        auto boundaries = domain.balancedGridBoundaries(load);
+        CHECK(boundaries[0] == std::vector<std::size_t>{0, 2, 4, 8, 16});
+        CHECK(boundaries[1] == domain.gridBoundaries()[1]);
+        CHECK(boundaries[2] == domain.gridBoundaries()[2]);
+
+        domain.setGridBoundaries(boundaries);
+        CHECK(domain.origin().x == Approx(-20.));
+        CHECK(domain.extent().x == Approx(5.));
+        CHECK(domain.isInDomainCore({-16., 0., 0.}));
+        CHECK(domain.isInDomainHalo({-14., 0., 0.}));
+        CHECK(domain.rankOfPosition({-14., 0., 0.}) == 2);
+        CHECK(domain.rankOfPosition({-9., 0., 0.}) == 3);
+        CHECK(domain.coreOfDomain(4).first.x == Approx(0.));
+
+        boundaries[0] = {0, 1, 4, 8, 16};
+        CHECK_THROWS(domain.setGridBoundaries(boundaries));
+    }
+
     SECTION("Periodic in a direction (here y) which has only one domain") {
         context.boxSize() = {10., 5., 1.};
         context.periodicBoundaryConditions() = {true, true, false};
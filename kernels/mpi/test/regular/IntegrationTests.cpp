@@ -39,11 +39,14 @@
  * @date 03.06.19
  */
 
+#include <cmath>
+
 #include <catch2/catch.hpp>
 #include <readdy/model/Kernel.h>
 #include <readdy/kernel/mpi/MPIKernel.h>
 #include <readdy/kernel/singlecpu/SCPUKernel.h>
 #include <readdy/model/RandomProvider.h>
+#include <readdy/common/boundary_condition_operations.h>
 
 namespace rnd = readdy::model::rnd;
 namespace rmo = readdy::model::observables;
@@ -186,7 +189,7 @@ readdy::model::Context getContext() {
     return ctx;
 }
 
-StaticResults observeState(const std::vector<readdy::model::Particle> &initParticles, readdy::model::Kernel *kernel) {
+StaticResults observeCurrentState(readdy::model::Kernel *kernel) {
     auto virial = kernel->observe().virial(1);
     auto energy = kernel->observe().energy(1);
     auto positions = kernel->observe().positions(1);
@@ -195,12 +198,6 @@ StaticResults observeState(const std::vector<readdy::model::Particle> &initParti
     auto nParticles = kernel->observe().nParticles(1);
     auto histogramAlongAxis = kernel->observe().histogramAlongAxis(1, {-1, 0.5, 0.5, 1}, {"B"}, 0);
 
-    kernel->actions().addParticles(initParticles)->perform();
-    kernel->actions().initializeKernel()->perform();
-    kernel->actions().createNeighborList(kernel->context().calculateMaxCutoff())->perform();
-    kernel->actions().updateNeighborList()->perform();
-    kernel->actions().calculateForces()->perform();
-
     virial->call(0);
     energy->call(0);
     positions->call(0);
@@ -220,6 +217,30 @@ StaticResults observeState(const std::vector<readdy::model::Particle> &initParti
     };
 }
 
+StaticResults observeState(const std::vector<readdy::model::Particle> &initParticles, readdy::model::Kernel *kernel) {
+    kernel->actions().addParticles(initParticles)->perform();
+    kernel->actions().initializeKernel()->perform();
+    kernel->actions().createNeighborList(kernel->context().calculateMaxCutoff())->perform();
+    kernel->actions().updateNeighborList()->perform();
+    kernel->actions().calculateForces()->perform();
+    return observeCurrentState(kernel);
+}
+
+/// Deterministic replacement for the integrator, the displacement only depends on the position of a particle
+void displaceParticles(readdy::kernel::mpi::MPIKernel &kernel, readdy::scalar scale = 0.3) {
+    if (not kernel.domain().isWorkerRank()) {
+        return;
+    }
+    const auto &box = kernel.context().boxSize().data();
+    const auto &pbc = kernel.context().periodicBoundaryConditions().data();
+    for (auto &entry : *kernel.getMPIKernelStateModel().getParticleData()) {
+        if (not entry.deactivated and entry.responsible) {
+            entry.pos += scale * readdy::Vec3(std::sin(entry.pos.y), std::sin(entry.pos.z), std::sin(entry.pos.x));
+            readdy::bcs::fixPosition(entry.pos, box, pbc);
+        }
+    }
+}
+
 TEST_CASE("Integration test state observables compared to SCPU", "[mpi]") {
     auto ctx = getContext();
     double volumeOccupation{0.7};
@@ -251,3 +272,107 @@ TEST_CASE("Integration test state observables compared to SCPU", "[mpi]") {
         }
     }
 }
+
+TEST_CASE("Forces with overlapped synchronization compared to full synchronization", "[mpi]") {
+    auto ctx = getContext();
+    // every second neighbor list update moves the domain boundaries
+    ctx.kernelConfiguration().mpi.loadBalanceStride = 2;
+    const auto &box = ctx.boxSize();
+    auto idB = ctx.particleTypes().idOf("B");
+    std::vector<readdy::model::Particle> initParticles;
+    for (std::size_t i = 0; i < 300; ++i) {
+        // most particles are in the lower half along x, such that balancing the load moves the boundaries
+        readdy::scalar x = (rnd::uniform_real() < 0.75 ? -0.5 : 0.) * box[0] + rnd::uniform_real() * 0.5 * box[0];
+        readdy::Vec3 p{x,
+                       rnd::uniform_real() * box[1] - 0.5 * box[1],
+                       rnd::uniform_real() * box[2] - 0.5 * box[2]};
+        initParticles.emplace_back(p, idB);
+    }
+
+    readdy::kernel::mpi::MPIKernel overlapped(ctx);
+    readdy::kernel::mpi::MPIKernel synchronized(ctx);
+    if (overlapped.domain().isIdleRank()) {
+        return;
+    }
+    for (auto *kernel : {&overlapped, &synchronized}) {
+        kernel->actions().addParticles(initParticles)->perform();
+        kernel->actions().initializeKernel()->perform();
+        kernel->actions().createNeighborList(kernel->context().calculateMaxCutoff())->perform();
+    }
+    auto updateNeighborList = overlapped.actions().updateNeighborList();
+    auto overlappedForces = overlapped.actions().calculateForces();
+    auto synchronizedForces = synchronized.actions().calculateForces();
+    for (std::size_t update = 1; update <= 4; ++update) {
+        displaceParticles(overlapped);
+        displaceParticles(synchronized);
+
+        // overlaps the synchronization with the interior cells, except for updates that balance the load
+        updateNeighborList->perform();
+        overlappedForces->perform();
+
+        if (update % 2 == 0) {
+            synchronized.balanceLoad();
+        }
+        if (synchronized.domain().isWorkerRank()) {
+            synchronized.getMPIKernelStateModel().synchronizeWithNeighbors();
+            synchronized.getMPIKernelStateModel().updateNeighborList();
+        }
+        synchronizedForces->perform();
+
+        auto overlappedResults = observeCurrentState(&overlapped);
+        auto synchronizedResults = observeCurrentState(&synchronized);
+        if (overlapped.domain().isMasterRank()) {
+            REQUIRE(overlappedResults == synchronizedResults);
+        }
+    }
+}
+
+TEST_CASE("Displacements beyond a cell fall back to full synchronization", "[mpi]") {
+    auto ctx = getContext();
+    const auto &box = ctx.boxSize();
+    auto idB = ctx.particleTypes().idOf("B");
+    std::vector<readdy::model::Particle> initParticles;
+    for (std::size_t i = 0; i < 300; ++i) {
+        readdy::Vec3 p{rnd::uniform_real() * box[0] - 0.5 * box[0],
+                       rnd::uniform_real() * box[1] - 0.5 * box[1],
+                       rnd::uniform_real() * box[2] - 0.5 * box[2]};
+        initParticles.emplace_back(p, idB);
+    }
+
+    readdy::kernel::mpi::MPIKernel overlapped(ctx);
+    readdy::kernel::mpi::MPIKernel synchronized(ctx);
+    if (overlapped.domain().isIdleRank()) {
+        return;
+    }
+    for (auto *kernel : {&overlapped, &synchronized}) {
+        kernel->actions().addParticles(initParticles)->perform();
+        kernel->actions().initializeKernel()->perform();
+        kernel->actions().createNeighborList(kernel->context().calculateMaxCutoff())->perform();
+    }
+    auto updateNeighborList = overlapped.actions().updateNeighborList();
+    auto overlappedForces = overlapped.actions().calculateForces();
+    auto synchronizedForces = synchronized.actions().calculateForces();
+    // small steps overlap the synchronization, the large ones move particles across more than one grid cell
+    for (readdy::scalar scale : {0.3, 3., 0.3, 5.}) {
+        displaceParticles(overlapped, scale);
+        displaceParticles(synchronized, scale);
+
+        updateNeighborList->perform();
+        if (overlapped.domain().isWorkerRank()) {
+            REQUIRE(overlapped.getMPIKernelStateModel().synchronizationPending() == (scale < 1.));
+        }
+        overlappedForces->perform();
+
+        if (synchronized.domain().isWorkerRank()) {
+            synchronized.getMPIKernelStateModel().synchronizeWithNeighbors();
+            synchronized.getMPIKernelStateModel().updateNeighborList();
+        }
+        synchronizedForces->perform();
+
+        auto overlappedResults = observeCurrentState(&overlapped);
+        auto synchronizedResults = observeCurrentState(&synchronized);
+        if (overlapped.domain().isMasterRank()) {
+            REQUIRE(overlappedResults == synchronizedResults);
+        }
+    }
+}
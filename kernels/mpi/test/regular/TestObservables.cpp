@@ -40,11 +40,16 @@
  * @date 22.04.20
  */
 
+#include <cstdio>
+
+#include <hdf5.h>
 #include <catch2/catch.hpp>
 #include <readdy/kernel/mpi/MPIKernel.h>
 #include <readdy/api/Simulation.h>
+#include <readdy/model/observables/io/Types.h>
 
 using Json = nlohmann::json;
+namespace rmou = readdy::model::observables::util;
 
 TEST_CASE("Test particles observable", "[mpi]") {
     readdy::model::Context ctx;
@@ -81,4 +86,119 @@ TEST_CASE("Test particles observable", "[mpi]") {
     simulation.run(3, 0.01);
 }
 
+namespace {
+/** Reads a string data set, regardless of whether it was stored with fixed or variable length */
+std::string readString(readdy::File &file, const std::string &path) {
+    const auto dataSet = H5Dopen2(file.id(), path.c_str(), H5P_DEFAULT);
+    REQUIRE(dataSet >= 0);
+    const auto type = H5Dget_type(dataSet);
+    std::string result;
+    if (H5Tis_variable_str(type) > 0) {
+        char *value {nullptr};
+        H5Dread(dataSet, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &value);
+        result = value;
+        H5free_memory(value);
+    } else {
+        result.resize(H5Tget_size(type));
+        H5Dread(dataSet, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, result.data());
+        result.resize(result.find('\0') == std::string::npos ? result.size() : result.find('\0'));
+    }
+    H5Tclose(type);
+    H5Dclose(dataSet);
+    return result;
+}
+}
+
+TEST_CASE("Test distributed output of the positions observable", "[mpi]") {
+    MPI_Barrier(MPI_COMM_WORLD);
+    readdy::model::Context ctx;
+    ctx.boxSize() = {10., 10., 10.};
+    ctx.particleTypes().add("A", 1.);
+    Json conf = {{"MPI", {{"dx", 4.9}, {"dy", 4.9}, {"dz", 4.9}, {"distributedOutput", true}}}};
+    ctx.kernelConfiguration() = conf.get<readdy::conf::Configuration>();
+
+    const std::string fileName = "test_mpi_distributed_output.h5";
+    const std::string groupPath = std::string(rmou::OBSERVABLES_GROUP_PATH) + "/positions";
+    const std::size_t nParticles = 50;
+    const std::size_t nSteps = 3;
+    const auto unusedFileName = [](int rank) {
+        return fmt::format("test_mpi_distributed_output_unused{}.h5", rank);
+    };
+    bool isIdle {true};
+    bool isMaster {false};
+    int rank {0};
+    int nUsedRanks {0};
+    std::vector<readdy::model::Particle> finalParticles;
+    {
+        readdy::plugin::KernelProvider::kernel_ptr kernelPtr(readdy::kernel::mpi::MPIKernel::create(ctx));
+        auto &kernel = dynamic_cast<readdy::kernel::mpi::MPIKernel &>(*kernelPtr);
+        isIdle = kernel.domain().isIdleRank();
+        isMaster = kernel.domain().isMasterRank();
+        rank = kernel.domain().rank();
+        nUsedRanks = kernel.domain().nUsedRanks();
+        if (not isIdle) {
+            readdy::Simulation simulation(std::move(kernelPtr));
+            for (std::size_t i = 0; i < nParticles; ++i) {
+                auto x = readdy::model::rnd::uniform_real() * 10. - 5.;
+                auto y = readdy::model::rnd::uniform_real() * 10. - 5.;
+                auto z = readdy::model::rnd::uniform_real() * 10. - 5.;
+                simulation.addParticle("A", x, y, z);
+            }
+            // the shards are named after the master's file, the workers' files stay empty
+            auto file = readdy::File::create(isMaster ? fileName : unusedFileName(rank),
+                                             readdy::File::Flag::OVERWRITE);
+            auto handle = simulation.registerObservable(simulation.observe().positions(1));
+            handle.enableWriteToFile(*file, "positions", 1);
+            simulation.run(nSteps, 0.01);
+            handle.flush();
+            finalParticles = kernel.getMPIKernelStateModel().gatherParticles();
+        }
+    }
+    // the files are closed, read them back the way the python Trajectory does
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (isMaster) {
+        std::vector<std::string> shards;
+        {
+            auto file = readdy::File::open(fileName, readdy::File::Flag::READ_ONLY);
+            shards = Json::parse(readString(*file, groupPath + "/shards")).get<std::vector<std::string>>();
+        }
+        REQUIRE(shards.size() == static_cast<std::size_t>(nUsedRanks - 1));
+
+        std::vector<std::vector<readdy::Vec3>> frames(nSteps + 1);
+        for (const auto &shard : shards) {
+            // shards are referenced relative to the directory of the output file
+            auto file = readdy::File::open(shard, readdy::File::Flag::READ_ONLY);
+            auto group = file->getSubgroup(groupPath);
+            std::vector<readdy::TimeStep> time;
+            group.read("time", time);
+            REQUIRE(time.size() == nSteps + 1);
+            auto types = rmou::getVec3Types(file->ref());
+            std::vector<std::vector<readdy::Vec3>> data;
+            group.readVLEN("data", data, &std::get<0>(types), &std::get<1>(types));
+            REQUIRE(data.size() == nSteps + 1);
+            for (std::size_t t = 0; t < data.size(); ++t) {
+                frames[t].insert(frames[t].end(), data[t].begin(), data[t].end());
+            }
+        }
+        for (const auto &frame : frames) {
+            REQUIRE(frame.size() == nParticles);
+        }
+        // the last frame holds the final positions
+        REQUIRE(finalParticles.size() == nParticles);
+        for (const auto &particle : finalParticles) {
+            auto found = std::find_if(frames.back().begin(), frames.back().end(), [&particle](const auto &pos) {
+                return (particle.pos() - pos).normSquared() < 1e-12;
+            });
+            CHECK(found != frames.back().end());
+        }
+        for (const auto &shard : shards) {
+            std::remove(shard.c_str());
+        }
+        std::remove(fileName.c_str());
+    } else if (not isIdle) {
+        std::remove(unusedFileName(rank).c_str());
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+}
+
 // todo more tests!
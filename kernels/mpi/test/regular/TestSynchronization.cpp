@@ -144,6 +144,19 @@ void check(readdy::kernel::mpi::MPIKernel &kernel,
                 // expected should be a subset of actual
                 REQUIRE(std::includes(actualVec.begin(), actualVec.end(), expectedVec.begin(), expectedVec.end(), ComparePODPair{}));
             }
+
+            //THEN("interior and boundary cells together yield all pairs exactly once")
+            {
+                auto &nl = kernel.getMPIKernelStateModel().getNeighborList();
+                std::size_t nPairs {0};
+                std::size_t nSplitPairs {0};
+                nl.forAllPairs([&nPairs](const rkm::MPIEntry &, const rkm::MPIEntry &) { ++nPairs; });
+                auto countSplitPairs = [&nSplitPairs](const rkm::MPIEntry &, const rkm::MPIEntry &) { ++nSplitPairs; };
+                nl.forAllPairsOfCells(nl.interiorCells(), countSplitPairs);
+                nl.forAllPairsOfCells(nl.boundaryCells(), countSplitPairs);
+                REQUIRE(nPairs == nSplitPairs);
+                REQUIRE(nl.interiorCells().size() + nl.boundaryCells().size() == nl.cellsInCore().size());
+            }
         }
     } else if (kernel.domain().isMasterRank()) {
         // master has no active entries
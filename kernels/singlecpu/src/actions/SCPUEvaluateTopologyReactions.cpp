@@ -107,6 +107,15 @@ void SCPUEvaluateTopologyReactions::perform() {
                 return eventsDependent(e1, e2);
             };
 
+            // topologies and particles involved in an event, any two dependent events share one of these
+            auto dependencyKeys = [](const TREvent &event, const auto &key) {
+                key(2 * event.topology_idx);
+                if (event.topology_idx2 >= 0) {
+                    key(2 * static_cast<std::size_t>(event.topology_idx2));
+                } else {
+                    key(2 * event.idx2 + 1);
+                }
+            };
             auto eval = [&](const TREvent &event) {
                 auto &topology = topologies.at(event.topology_idx);
                 if (topology->isDeactivated()) {
@@ -138,7 +147,8 @@ void SCPUEvaluateTopologyReactions::perform() {
                 }
             };
 
-            algo::performEvents(events, shouldEval, depending, eval);
+            algo::performEvents(events, shouldEval, depending, eval, algo::detail::noPostPerform<decltype(events)>,
+                                algo::detail::DrawUniform{}, dependencyKeys);
 
             if (!new_topologies.empty()) {
                 for (auto &&top : new_topologies) {
@@ -295,6 +295,13 @@ scpu_data::EntriesUpdate handleEventsGillespie(
                         || (e1.nEducts == 2 && (e1.idx2 == e2.idx1 || (e2.nEducts == 2 && e1.idx2 == e2.idx2))));
             };
 
+            auto dependencyKeys = [](const event_t &event, const auto &key) {
+                key(event.idx1);
+                if (event.nEducts == 2) {
+                    key(event.idx2);
+                }
+            };
+
             auto eval = [&](const event_t &event) {
                 auto entry1 = event.idx1;
                 if (event.nEducts == 1) {
@@ -328,7 +335,8 @@ scpu_data::EntriesUpdate handleEventsGillespie(
                 }
             };
 
-            algo::performEvents(events, shouldEval, depending, eval);
+            algo::performEvents(events, shouldEval, depending, eval, algo::detail::noPostPerform<std::vector<event_t>>,
+                                algo::detail::DrawUniform{}, dependencyKeys);
 
         }
     }
@@ -435,6 +443,13 @@ void SCPUDetailedBalance::perform() {
                     || (e1.nEducts == 2 && (e1.idx2 == e2.idx1 || (e2.nEducts == 2 && e1.idx2 == e2.idx2))));
         };
 
+        auto dependencyKeys = [](const event_t &event, const auto &key) {
+            key(event.idx1);
+            if (event.nEducts == 2) {
+                key(event.idx2);
+            }
+        };
+
         auto eval = [&](const event_t &event) {
             const readdy::model::reactions::Reaction *reaction;
             const readdy::model::actions::reactions::ReversibleReactionConfig *revReaction;
@@ -548,7 +563,8 @@ void SCPUDetailedBalance::perform() {
         };
 
         calculateEnergies();
-        algo::performEvents(events, shouldEval, depending, eval);
+        algo::performEvents(events, shouldEval, depending, eval, algo::detail::noPostPerform<decltype(events)>,
+                            algo::detail::DrawUniform{}, dependencyKeys);
 
     }
 }
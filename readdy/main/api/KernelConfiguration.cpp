@@ -46,11 +46,45 @@ namespace readdy::conf {
 
 namespace cpu {
 void to_json(json &j, const NeighborList &nl) {
-    j = json{{"cll_radius", nl.cll_radius}};
+    j = json{{"cll_radius", nl.cll_radius}, {"skin", nl.skin}, {"half_shell", nl.halfShell}};
 }
 
 void from_json(const json &j, NeighborList &nl) {
     nl.cll_radius = j.at("cll_radius").get<std::uint8_t>();
+    if (j.find("skin") != j.end()) {
+        nl.skin = j.at("skin").get<scalar>();
+    } else {
+        nl.skin = 0;
+    }
+    if (j.find("half_shell") != j.end()) {
+        nl.halfShell = j.at("half_shell").get<bool>();
+    } else {
+        nl.halfShell = false;
+    }
+}
+
+void to_json(json &j, const DataLayout &layout) {
+    j = json{{"reorder_interval", layout.reorderInterval},
+             {"space_filling_curve", layout.spaceFillingCurve},
+             {"flat_bonded_interactions", layout.flatBondedInteractions}};
+}
+
+void from_json(const json &j, DataLayout &layout) {
+    if (j.find("reorder_interval") != j.end()) {
+        layout.reorderInterval = j.at("reorder_interval").get<std::size_t>();
+    } else {
+        layout.reorderInterval = 0;
+    }
+    if (j.find("space_filling_curve") != j.end()) {
+        layout.spaceFillingCurve = j.at("space_filling_curve").get<SpaceFillingCurve>();
+    } else {
+        layout.spaceFillingCurve = SpaceFillingCurve::hilbert;
+    }
+    if (j.find("flat_bonded_interactions") != j.end()) {
+        layout.flatBondedInteractions = j.at("flat_bonded_interactions").get<bool>();
+    } else {
+        layout.flatBondedInteractions = false;
+    }
 }
 
 void to_json(json &j, const ThreadConfig &nl) {
@@ -65,9 +99,36 @@ void from_json(const json &j, ThreadConfig &nl) {
     }
 }
 
+void to_json(json &j, const Random &random) {
+    j = json{{"seed", random.seed}};
+}
+
+void from_json(const json &j, Random &random) {
+    if (j.find("seed") != j.end()) {
+        random.seed = j.at("seed").get<std::int64_t>();
+    } else {
+        random.seed = -1;
+    }
+}
+
+void to_json(json &j, const Reactions &reactions) {
+    j = json{{"parallel_gillespie", reactions.parallelGillespie}};
+}
+
+void from_json(const json &j, Reactions &reactions) {
+    if (j.find("parallel_gillespie") != j.end()) {
+        reactions.parallelGillespie = j.at("parallel_gillespie").get<bool>();
+    } else {
+        reactions.parallelGillespie = false;
+    }
+}
+
 void to_json(json &j, const Configuration &conf) {
     j = json {{"neighbor_list", conf.neighborList},
-              {"thread_config", conf.threadConfig}};
+              {"thread_config", conf.threadConfig},
+              {"data_layout", conf.dataLayout},
+              {"random", conf.random},
+              {"reactions", conf.reactions}};
 }
 
 void from_json(const json &j, Configuration &conf) {
@@ -81,6 +142,21 @@ void from_json(const json &j, Configuration &conf) {
     } else {
         conf.threadConfig = {};
     }
+    if (j.find("data_layout") != j.end()) {
+        conf.dataLayout = j.at("data_layout").get<DataLayout>();
+    } else {
+        conf.dataLayout = {};
+    }
+    if (j.find("random") != j.end()) {
+        conf.random = j.at("random").get<Random>();
+    } else {
+        conf.random = {};
+    }
+    if (j.find("reactions") != j.end()) {
+        conf.reactions = j.at("reactions").get<Reactions>();
+    } else {
+        conf.reactions = {};
+    }
 }
 }
 
@@ -102,7 +178,10 @@ void to_json(json &j, const Configuration &conf) {
     j = json{{"dx", conf.dx},
              {"dy", conf.dy},
              {"dz", conf.dz},
-             {"haloThickness"}, conf.haloThickness};
+             {"haloThickness", conf.haloThickness},
+             {"loadBalanceStride", conf.loadBalanceStride},
+             {"threadConfig", conf.threadConfig},
+             {"distributedOutput", conf.distributedOutput}};
 }
 
 void from_json(const json &j, Configuration &conf) {
@@ -126,6 +205,21 @@ void from_json(const json &j, Configuration &conf) {
     } else {
         conf.haloThickness = {};
     }
+    if (j.find("loadBalanceStride") != j.end()) {
+        conf.loadBalanceStride = j.at("loadBalanceStride").get<std::size_t>();
+    } else {
+        conf.loadBalanceStride = {};
+    }
+    if (j.find("threadConfig") != j.end()) {
+        conf.threadConfig = j.at("threadConfig").get<cpu::ThreadConfig>();
+    } else {
+        conf.threadConfig = cpu::ThreadConfig{1};
+    }
+    if (j.find("distributedOutput") != j.end()) {
+        conf.distributedOutput = j.at("distributedOutput").get<bool>();
+    } else {
+        conf.distributedOutput = {};
+    }
 }
 }
 
@@ -41,6 +41,9 @@
  * @date 20.06.16
  */
 
+#include <fstream>
+#include <sstream>
+
 #include <readdy/model/Kernel.h>
 #include <readdy/model/potentials/PotentialsOrder1.h>
 
@@ -77,6 +80,91 @@ std::string PotentialRegistry::describe() const {
     return description;
 }
 
+void PotentialRegistry::_rebuildO2Tables() {
+    _potentialsO2Table.rebuild(_potentialsO2, _types->nTypes());
+
+    util::particle_type_pair_unordered_map<std::vector<const HarmonicRepulsion *>> harmonicRepulsion;
+    util::particle_type_pair_unordered_map<std::vector<const WeakInteractionPiecewiseHarmonic *>> weakInteraction;
+    util::particle_type_pair_unordered_map<std::vector<const LennardJones *>> lennardJones;
+    util::particle_type_pair_unordered_map<std::vector<const ScreenedElectrostatics *>> screenedElectrostatics;
+    util::particle_type_pair_unordered_map<std::vector<const Tabulated *>> tabulated;
+    util::particle_type_pair_unordered_map<std::vector<const PotentialOrder2 *>> other;
+    for (const auto &[types, potentials] : _potentialsO2) {
+        for (const auto *potential : potentials) {
+            if (auto hr = dynamic_cast<const HarmonicRepulsion *>(potential)) {
+                harmonicRepulsion[types].push_back(hr);
+            } else if (auto wi = dynamic_cast<const WeakInteractionPiecewiseHarmonic *>(potential)) {
+                weakInteraction[types].push_back(wi);
+            } else if (auto lj = dynamic_cast<const LennardJones *>(potential)) {
+                lennardJones[types].push_back(lj);
+            } else if (auto se = dynamic_cast<const ScreenedElectrostatics *>(potential)) {
+                screenedElectrostatics[types].push_back(se);
+            } else if (auto tab = dynamic_cast<const Tabulated *>(potential)) {
+                tabulated[types].push_back(tab);
+            } else {
+                other[types].push_back(potential);
+            }
+        }
+    }
+    const auto nTypes = _potentialsO2Table.nTypes();
+    _potentialsO2ByClass.harmonicRepulsion.rebuild(harmonicRepulsion, nTypes);
+    _potentialsO2ByClass.weakInteractionPiecewiseHarmonic.rebuild(weakInteraction, nTypes);
+    _potentialsO2ByClass.lennardJones.rebuild(lennardJones, nTypes);
+    _potentialsO2ByClass.screenedElectrostatics.rebuild(screenedElectrostatics, nTypes);
+    _potentialsO2ByClass.tabulated.rebuild(tabulated, nTypes);
+    _potentialsO2ByClass.other.rebuild(other, nTypes);
+}
+
+void PotentialRegistry::addTabulatedFromFile(ParticleTypeId type1, ParticleTypeId type2, const std::string &filename,
+                                             scalar tolerance) {
+    std::ifstream file(filename);
+    if (!file) {
+        throw std::invalid_argument(fmt::format("could not open tabulated potential file \"{}\"", filename));
+    }
+    std::vector<scalar> distances, energies;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        std::istringstream ss(line);
+        scalar distance, energy;
+        if (!(ss >> distance >> energy)) {
+            throw std::invalid_argument(fmt::format("could not parse line {} of tabulated potential file \"{}\": {}",
+                                                    lineNumber, filename, line));
+        }
+        distances.push_back(distance);
+        energies.push_back(energy);
+    }
+    addTabulated(type1, type2, distances, energies, tolerance);
+}
+
+void PotentialRegistry::tabulate(scalar tolerance, scalar minDistance) {
+    std::unordered_map<const PotentialOrder2 *, PotentialOrder2 *> replacements;
+    for (auto &[types, potentials] : _potentialsO2) {
+        for (auto &potential : potentials) {
+            if (dynamic_cast<const Tabulated *>(potential) == nullptr) {
+                auto &pots = _ownPotentialsP2[types];
+                pots.emplace_back(std::make_shared<Tabulated>(*potential, tolerance, minDistance));
+                replacements[potential] = pots.back().get();
+                potential = pots.back().get();
+            }
+        }
+    }
+    for (auto &[type1, others] : _alternativeO2Registry) {
+        for (auto &[type2, potentials] : others) {
+            for (auto &potential : potentials) {
+                auto it = replacements.find(potential);
+                if (it != replacements.end()) {
+                    potential = it->second;
+                }
+            }
+        }
+    }
+    _rebuildO2Tables();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 // Potentials order 1
@@ -224,6 +312,7 @@ LennardJones::LennardJones(ParticleTypeId type1, ParticleTypeId type2,
     auto dn = static_cast<scalar >(n);
     scalar  r_min = sigma * std::pow(dn / dm, 1. / (dn - dm));
     k = -epsilon / (std::pow(sigma / r_min, dm) - std::pow(sigma / r_min, dn));
+    energyShift = shift ? energy(cutoffDistance) : 0;
 }
 
 std::string LennardJones::describe() const {
@@ -268,4 +357,144 @@ std::string ScreenedElectrostatics::type() const {
     return getPotentialName<ScreenedElectrostatics>();
 }
 
+
+/**
+ * Tabulated
+ */
+
+namespace {
+// upper bound for the number of intervals when refining the tabulation
+constexpr std::size_t maxTabulatedIntervals = 1u << 18u;
+}
+
+Tabulated::Tabulated(const PotentialOrder2 &potential, scalar tolerance, scalar minDistance)
+        : super(potential.particleType1(), potential.particleType2()), _origin(potential.describe()),
+          _minDistanceSquared(minDistance * minDistance), _cutoffSquared(potential.getCutoffRadiusSquared()) {
+    if (minDistance <= 0) {
+        throw std::invalid_argument("the minimal tabulated distance must be positive!");
+    }
+    if (_minDistanceSquared >= _cutoffSquared) {
+        throw std::invalid_argument(fmt::format("the minimal tabulated distance {} must be smaller than the cutoff {}",
+                                                minDistance, std::sqrt(_cutoffSquared)));
+    }
+    tabulate([&potential](scalar distanceSquared) {
+        const auto r = std::sqrt(distanceSquared);
+        const Vec3 x_ij{r, 0, 0};
+        Vec3 force;
+        potential.calculateForce(force, x_ij);
+        // force on particle i is 2 dV/d(r^2) x_ij
+        return std::make_tuple(potential.calculateEnergy(x_ij), force[0] / (2 * r));
+    }, tolerance);
+}
+
+Tabulated::Tabulated(ParticleTypeId type1, ParticleTypeId type2, const std::vector<scalar> &distances,
+                     const std::vector<scalar> &energies, scalar tolerance)
+        : super(type1, type2), _origin(fmt::format("{} tabulated values", distances.size())) {
+    if (distances.size() != energies.size()) {
+        throw std::invalid_argument(fmt::format("got {} distances but {} energies", distances.size(), energies.size()));
+    }
+    if (distances.size() < 3) {
+        throw std::invalid_argument("a tabulated potential requires at least three values");
+    }
+    if (distances.front() <= 0) {
+        throw std::invalid_argument("the tabulated distances must be positive!");
+    }
+    if (std::adjacent_find(distances.begin(), distances.end(), std::greater_equal<>()) != distances.end()) {
+        throw std::invalid_argument("the tabulated distances must be strictly increasing!");
+    }
+    _minDistanceSquared = distances.front() * distances.front();
+    _cutoffSquared = distances.back() * distances.back();
+
+    // second derivatives of the natural cubic spline through the values, tridiagonal system
+    const auto n = distances.size();
+    std::vector<scalar> secondDerivatives(n, 0), u(n, 0);
+    for (std::size_t i = 1; i < n - 1; ++i) {
+        const auto sig = (distances[i] - distances[i - 1]) / (distances[i + 1] - distances[i - 1]);
+        const auto p = sig * secondDerivatives[i - 1] + 2;
+        secondDerivatives[i] = (sig - 1) / p;
+        u[i] = (energies[i + 1] - energies[i]) / (distances[i + 1] - distances[i])
+               - (energies[i] - energies[i - 1]) / (distances[i] - distances[i - 1]);
+        u[i] = (6 * u[i] / (distances[i + 1] - distances[i - 1]) - sig * u[i - 1]) / p;
+    }
+    for (auto k = n - 1; k-- > 0;) {
+        secondDerivatives[k] = secondDerivatives[k] * secondDerivatives[k + 1] + u[k];
+    }
+
+    tabulate([&distances, &energies, &secondDerivatives, n](scalar distanceSquared) {
+        const auto r = std::sqrt(distanceSquared);
+        auto hi = static_cast<std::size_t>(std::upper_bound(distances.begin(), distances.end(), r) - distances.begin());
+        hi = std::clamp(hi, static_cast<std::size_t>(1), n - 1);
+        const auto lo = hi - 1;
+        const auto h = distances[hi] - distances[lo];
+        const auto a = (distances[hi] - r) / h;
+        const auto b = 1 - a;
+        const auto energy = a * energies[lo] + b * energies[hi]
+                            + ((a * a * a - a) * secondDerivatives[lo] + (b * b * b - b) * secondDerivatives[hi])
+                              * h * h / 6;
+        const auto dEdr = (energies[hi] - energies[lo]) / h - (3 * a * a - 1) / 6 * h * secondDerivatives[lo]
+                          + (3 * b * b - 1) / 6 * h * secondDerivatives[hi];
+        return std::make_tuple(energy, dEdr / (2 * r));
+    }, tolerance);
+}
+
+void Tabulated::tabulate(const sampler &energyAndDerivative, scalar tolerance) {
+    if (tolerance <= 0) {
+        throw std::invalid_argument("the tolerance of a tabulated potential must be positive!");
+    }
+    auto error = [](scalar approximation, scalar exact) {
+        return std::abs(approximation - exact) / std::max(static_cast<scalar>(1), std::abs(exact));
+    };
+    const auto range = _cutoffSquared - _minDistanceSquared;
+    std::size_t nIntervals = 16;
+    scalar maxError;
+    do {
+        const auto width = range / static_cast<scalar>(nIntervals);
+        _nIntervals = nIntervals;
+        _inverseWidth = 1 / width;
+        _coefficients.resize(4 * nIntervals);
+
+        // cubic Hermite interpolation of the sampled energies and derivatives
+        auto [e0, d0] = energyAndDerivative(_minDistanceSquared);
+        for (std::size_t i = 0; i < nIntervals; ++i) {
+            const auto s1 = i + 1 == nIntervals ? _cutoffSquared : _minDistanceSquared + (i + 1) * width;
+            const auto [e1, d1] = energyAndDerivative(s1);
+            const auto t0 = d0 * width;
+            const auto t1 = d1 * width;
+            auto *c = &_coefficients[4 * i];
+            c[0] = e0;
+            c[1] = t0;
+            c[2] = 3 * (e1 - e0) - 2 * t0 - t1;
+            c[3] = 2 * (e0 - e1) + t0 + t1;
+            e0 = e1;
+            d0 = d1;
+        }
+
+        maxError = 0;
+        for (std::size_t i = 0; i < nIntervals; ++i) {
+            const auto *c = &_coefficients[4 * i];
+            for (auto t : {.25, .5, .75}) {
+                const auto [energy, derivative] = energyAndDerivative(_minDistanceSquared + (i + t) * width);
+                const auto approxEnergy = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+                const auto approxDerivative = (c[1] + t * (2 * c[2] + t * 3 * c[3])) * _inverseWidth;
+                maxError = std::max({maxError, error(approxEnergy, energy), error(approxDerivative, derivative)});
+            }
+        }
+        nIntervals *= 2;
+    } while (maxError > tolerance && nIntervals <= maxTabulatedIntervals);
+
+    if (maxError > tolerance) {
+        log::warn("Tabulation of \"{}\" reached only an accuracy of {} instead of {} with {} intervals",
+                  _origin, maxError, tolerance, _nIntervals);
+    }
+}
+
+std::string Tabulated::describe() const {
+    return fmt::format("Tabulated potential with {} intervals and cutoff={} approximating: {}", _nIntervals,
+                       std::sqrt(_cutoffSquared), _origin);
+}
+
+std::string Tabulated::type() const {
+    return getPotentialName<Tabulated>();
+}
+
 }
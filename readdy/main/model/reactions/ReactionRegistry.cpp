@@ -53,6 +53,7 @@
 #include <readdy/model/reactions/Decay.h>
 #include <readdy/common/string.h>
 #include <readdy/model/Utils.h>
+#include <cmath>
 #include <regex>
 #include <utility>
 
@@ -74,11 +75,39 @@ ReactionId ReactionRegistry::emplaceReaction(const std::shared_ptr<Reaction> &re
         auto pp = std::make_tuple(reaction->educts()[0], reaction->educts()[1]);
         _ownO2Reactions[pp].push_back(reaction);
         _o2Reactions[pp].push_back(_ownO2Reactions[pp].back().get());
+        _o2ReactionsTable.rebuild(_o2Reactions, _types->nTypes());
         _n_order2 += 1;
     }
     return id;
 }
 
+void ReactionRegistry::cacheProbabilities(scalar timeStep, bool approximated) {
+    auto probability = [timeStep, approximated](scalar rate) {
+        return approximated ? rate * timeStep : 1 - std::exp(-rate * timeStep);
+    };
+    std::size_t nTypes = 0;
+    for (const auto &entry : _o1Reactions) {
+        nTypes = std::max(nTypes, static_cast<std::size_t>(entry.first) + 1);
+    }
+    _o1TotalRates.assign(nTypes, 0);
+    _o1Probabilities.assign(nTypes, 0);
+    for (const auto &entry : _o1Reactions) {
+        auto &totalRate = _o1TotalRates[entry.first];
+        for (auto *reaction : entry.second) {
+            reaction->_probability = probability(reaction->rate());
+            if (reaction->rate() > 0) {
+                totalRate += reaction->rate();
+            }
+        }
+        _o1Probabilities[entry.first] = probability(totalRate);
+    }
+    for (const auto &entry : _o2Reactions) {
+        for (auto *reaction : entry.second) {
+            reaction->_probability = probability(reaction->rate());
+        }
+    }
+}
+
 std::string ReactionRegistry::describe() const {
     namespace rus = readdy::util::str;
     std::string description;
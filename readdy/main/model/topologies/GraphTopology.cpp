@@ -43,7 +43,11 @@
  * @copyright BSD-3
  */
 
+#include <array>
 #include <sstream>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <readdy/model/Kernel.h>
 #include <readdy/model/topologies/GraphTopology.h>
@@ -51,10 +55,24 @@
 
 namespace readdy::model::top {
 
+std::atomic<std::size_t> Topology::potentialsRevisionCounter{0};
+
 GraphTopology::GraphTopology(TopologyTypeId type, Graph graph,
                              const model::Context& context, const model::StateModel *stateModel)
         : Topology(), _context(context), _topology_type(type), _stateModel(stateModel), _cumulativeRate(0),
-        _graph(std::move(graph)) {}
+        _graph(std::move(graph)) {
+    rebuildVertexIndex();
+}
+
+void GraphTopology::rebuildVertexIndex() {
+    _vertexIndex.clear();
+    _vertexIndex.reserve(_graph.nVertices());
+    for (auto it = _graph.vertices().begin_persistent(); it != _graph.vertices().end_persistent(); ++it) {
+        if (!it->deactivated()) {
+            _vertexIndex.emplace((*it)->particleIndex, _graph.vertices().persistentIndex(it));
+        }
+    }
+}
 
 void GraphTopology::configure() {
     validate();
@@ -62,6 +80,7 @@ void GraphTopology::configure() {
     bondedPotentials.clear();
     anglePotentials.clear();
     torsionPotentials.clear();
+    potentialsChanged();
 
     std::unordered_map<api::BondType, std::vector<pot::BondConfiguration>, readdy::util::hash::EnumClassHash> bonds;
     std::unordered_map<api::AngleType, std::vector<pot::AngleConfiguration>, readdy::util::hash::EnumClassHash> angles;
@@ -142,19 +161,139 @@ void GraphTopology::configure() {
     }
 }
 
+bool GraphTopology::isConnected() {
+    if (!_knownConnected) {
+        _knownConnected = _graph.isConnected();
+        _removedEdges.clear();
+        return _knownConnected;
+    }
+    const auto endpoints = removedEdgeEndpoints();
+    for (std::size_t i = 1; i < endpoints.size(); ++i) {
+        if (!cutOffSide({endpoints.front(), endpoints[i]}).empty()) {
+            return false;
+        }
+    }
+    _removedEdges.clear();
+    return true;
+}
+
+std::vector<Graph::PersistentVertexIndex> GraphTopology::removedEdgeEndpoints() const {
+    std::vector<Graph::PersistentVertexIndex> endpoints;
+    std::unordered_set<std::size_t> seen;
+    for (const auto &[v1, v2] : _removedEdges) {
+        for (const auto vertex : {v1, v2}) {
+            if (!_graph.vertices().at(vertex).deactivated() && seen.insert(vertex.value).second) {
+                endpoints.push_back(vertex);
+            }
+        }
+    }
+    return endpoints;
+}
+
+std::vector<Graph::PersistentVertexIndex> GraphTopology::cutOffSide(const Graph::Edge &edge) const {
+    struct Search {
+        std::vector<Graph::PersistentVertexIndex> visited;
+        std::unordered_set<std::size_t> seen;
+        std::size_t next {0};
+    };
+    const auto &vertices = _graph.vertices();
+    const auto &[v1, v2] = edge;
+    if (vertices.at(v1).deactivated() || vertices.at(v2).deactivated()) {
+        return {};
+    }
+    std::array<Search, 2> searches {};
+    searches[0].visited.push_back(v1);
+    searches[0].seen.insert(v1.value);
+    searches[1].visited.push_back(v2);
+    searches[1].seen.insert(v2.value);
+    while (true) {
+        for (std::size_t side = 0; side < 2; ++side) {
+            auto &search = searches[side];
+            const auto &otherSearch = searches[1 - side];
+            if (search.next == search.visited.size()) {
+                return std::move(search.visited);
+            }
+            const auto current = search.visited[search.next++];
+            for (const auto neighbor : vertices.at(current).neighbors()) {
+                if (otherSearch.seen.find(neighbor.value) != otherSearch.seen.end()) {
+                    return {};
+                }
+                if (search.seen.insert(neighbor.value).second) {
+                    search.visited.push_back(neighbor);
+                }
+            }
+        }
+    }
+}
+
 std::vector<GraphTopology> GraphTopology::connectedComponents() {
-    auto subGraphs = _graph.connectedComponents();
-    // create actual GraphTopology objects from graphs and particles
     std::vector<GraphTopology> components;
-    {
+    if (!_knownConnected) {
+        auto subGraphs = _graph.connectedComponents();
+        // create actual GraphTopology objects from graphs and particles
         components.reserve(subGraphs.size());
-        {
-            auto it_graphs = subGraphs.begin();
-            for(; it_graphs != subGraphs.end(); ++it_graphs) {
-                components.emplace_back(_topology_type, std::move(*it_graphs), _context, _stateModel);
+        for (auto &subGraph : subGraphs) {
+            components.emplace_back(_topology_type, std::move(subGraph), _context, _stateModel);
+            components.back()._knownConnected = true;
+        }
+        return std::move(components);
+    }
+
+    // every component contains an end point of a removed edge: compare the end points against an anchor that is
+    // connected to all end points visited so far and cut off the smaller side whenever they are disconnected, the
+    // remaining component stays in place
+    std::vector<Graph> cutOffGraphs;
+    std::optional<Graph::PersistentVertexIndex> anchor;
+    for (const auto endpoint : removedEdgeEndpoints()) {
+        if (_graph.vertices().at(endpoint).deactivated()) {
+            // cut off together with an earlier side
+            continue;
+        }
+        if (!anchor || _graph.vertices().at(*anchor).deactivated()) {
+            // the end points connected to a previous anchor were cut off with it
+            anchor = endpoint;
+            continue;
+        }
+        auto side = cutOffSide({*anchor, endpoint});
+        if (!side.empty()) {
+            Graph subGraph;
+            std::unordered_map<std::size_t, Graph::PersistentVertexIndex> mapping;
+            mapping.reserve(side.size());
+            for (const auto ix : side) {
+                mapping.emplace(ix.value, subGraph.addVertex(*_graph.vertices().at(ix)));
+            }
+            for (const auto ix : side) {
+                for (const auto neighbor : _graph.vertices().at(ix).neighbors()) {
+                    if (ix.value < neighbor.value) {
+                        subGraph.addEdge(mapping.at(ix.value), mapping.at(neighbor.value));
+                    }
+                }
             }
+            for (const auto ix : side) {
+                _vertexIndex.erase(_graph.vertices().at(ix)->particleIndex);
+                _graph.removeVertex(ix);
+            }
+            cutOffGraphs.push_back(std::move(subGraph));
         }
     }
+    _removedEdges.clear();
+
+    components.reserve(cutOffGraphs.size() + 1);
+    {
+        // hand over graph and vertex index of the largest component without rebuilding the index
+        components.emplace_back(_topology_type, Graph(), _context, _stateModel);
+        auto &component = components.back();
+        component._graph = std::move(_graph);
+        component._vertexIndex = std::move(_vertexIndex);
+        component._knownConnected = true;
+    }
+    for (auto &cutOffGraph : cutOffGraphs) {
+        // a search that ran out of vertices covered exactly one component
+        components.emplace_back(_topology_type, std::move(cutOffGraph), _context, _stateModel);
+        components.back()._knownConnected = true;
+    }
+    _graph = Graph();
+    _vertexIndex.clear();
     return std::move(components);
 }
 
@@ -178,6 +317,7 @@ typename Graph::PersistentVertexIndex GraphTopology::appendParticle(VertexData::
             .particleIndex = newParticle,
     });
     _graph.addEdge(counterPart, itNew);
+    _vertexIndex[newParticle] = itNew;
     return itNew;
 }
 
@@ -207,7 +347,14 @@ typename Graph::PersistentVertexIndex GraphTopology::appendTopology(const GraphT
         auto otherIx = otherGraph.vertices().persistentIndex(itOther);
 
         auto mapping = _graph.append(otherGraph, ix, otherIx);
+        for (const auto &[otherVertex, vertex] : mapping) {
+            _vertexIndex[_graph.vertices().at(vertex)->particleIndex] = vertex;
+        }
         _topology_type = newType;
+        if (!other._knownConnected || !other._removedEdges.empty()) {
+            _knownConnected = false;
+            _removedEdges.clear();
+        }
         return mapping.at(otherIx.value);
     } else {
         log::warn("encountered empty topology which was deactivated={}", other.isDeactivated());
@@ -223,15 +370,19 @@ std::vector<Particle> GraphTopology::fetchParticles() const {
 }
 
 typename Graph::VertexList::persistent_iterator GraphTopology::vertexIteratorForParticle(VertexData::ParticleIndex index) {
-    return std::find_if(_graph.vertices().begin_persistent(), _graph.vertices().end_persistent(), [index](const auto& v) {
-        return !v.deactivated() && v->particleIndex == index;
-    });
+    auto it = _vertexIndex.find(index);
+    if (it == _vertexIndex.end()) {
+        return _graph.vertices().end_persistent();
+    }
+    return std::next(_graph.vertices().begin_persistent(), it->second.value);
 }
 
 typename Graph::VertexList::const_persistent_iterator GraphTopology::vertexIteratorForParticle(VertexData::ParticleIndex index) const {
-    return std::find_if(_graph.vertices().begin_persistent(), _graph.vertices().end_persistent(), [index](const auto& v) {
-        return !v.deactivated() && v->particleIndex == index;
-    });
+    auto it = _vertexIndex.find(index);
+    if (it == _vertexIndex.end()) {
+        return _graph.vertices().end_persistent();
+    }
+    return std::next(_graph.vertices().begin_persistent(), it->second.value);
 }
 
 Particle GraphTopology::particleForVertex(const Vertex &vertex) const {
@@ -249,6 +400,26 @@ ParticleTypeId GraphTopology::typeOf(const Vertex &v) const {
     return particleForVertex(v).type();
 }
 
+void GraphTopology::remapParticleIndices(const std::vector<VertexData::ParticleIndex> &newIndices) {
+    for (auto it = _graph.vertices().begin_persistent(); it != _graph.vertices().end_persistent(); ++it) {
+        if (!it->deactivated()) {
+            (*it)->particleIndex = newIndices.at((*it)->particleIndex);
+        }
+    }
+    rebuildVertexIndex();
+    // the graph is unchanged, so the potentials only need to follow their particles
+    for (auto &potential : bondedPotentials) {
+        potential->remapParticleIndices(newIndices);
+    }
+    for (auto &potential : anglePotentials) {
+        potential->remapParticleIndices(newIndices);
+    }
+    for (auto &potential : torsionPotentials) {
+        potential->remapParticleIndices(newIndices);
+    }
+    potentialsChanged();
+}
+
 std::vector<VertexData::ParticleIndex> GraphTopology::particleIndices() const {
     std::vector<VertexData::ParticleIndex> result;
     result.reserve(_graph.vertices().size());
@@ -46,6 +46,7 @@
 #include <readdy/model/topologies/TopologyRegistry.h>
 #include <readdy/model/Utils.h>
 
+#include <cmath>
 #include <utility>
 
 namespace readdy::model::top {
@@ -214,6 +215,17 @@ void TopologyRegistry::addSpatialReaction(const std::string &descriptor,
     addSpatialReaction(parser.parse(descriptor, std::move(rate_function), radius));
 }
 
+void TopologyRegistry::cacheProbabilities(scalar timeStep, bool approximated) {
+    for (auto &[_, reactions] : _spatialReactions) {
+        for (auto &reaction : reactions) {
+            if (reaction._rate_is_const) {
+                reaction._probability = approximated ? reaction._rate * timeStep
+                                                     : 1 - std::exp(-reaction._rate * timeStep);
+            }
+        }
+    }
+}
+
 void TopologyRegistry::addSpatialReaction(reactions::SpatialTopologyReaction &&reaction) {
     validateSpatialReaction(reaction);
     auto key = std::make_tuple(reaction.type1(), reaction.top_type1(), reaction.type2(), reaction.top_type2());
@@ -88,7 +88,7 @@ std::vector<GraphTopology> StructuralTopologyReaction::execute(GraphTopology &to
         // post reaction
         if (expects_connected_after_reaction()) {
             bool valid = true;
-            if (!topology.graph().isConnected()) {
+            if (!topology.isConnected()) {
                 // we expected it to be connected after the reaction.. but it is not, raise or rollback.
                 log::warn("The topology was expected to still be connected after the reaction, but it was not.");
                 valid = false;
@@ -113,7 +113,7 @@ std::vector<GraphTopology> StructuralTopologyReaction::execute(GraphTopology &to
                 topology.updateReactionRates(topology_types.structuralReactionsOf(topology.type()));
             }
         } else {
-            if (!topology.graph().isConnected()) {
+            if (!topology.isConnected()) {
                 auto subTopologies = topology.connectedComponents();
                 assert(subTopologies.size() > 1 && "This should be at least 2 as the graph is not connected.");
                 return std::move(subTopologies);
@@ -22,11 +22,6 @@ TEMPLATE_TEST_CASE("Reaction handlers integration.", "[!hide][integration]", Sin
     auto &ctx = kernel->context();
     for (const auto &handler : REACTION_HANDLERS) {
         SECTION(handler) {
-            if (kernel->name() == "CPU" && std::string(handler) == "DetailedBalance") {
-                INFO("Skipping tests for the combination (CPU, DetailedBalance)");
-                continue;
-            }
-
             SECTION("Michaelis Menten") {
                 /**
                 * Since comparing the value of a stochastic process (number of particles over time) is not well
@@ -137,4 +137,86 @@ TEST_CASE("Check performEvents.", "[perform-events]") {
             REQUIRE(set.find(i) != set.end());
         }
     }
+
+    SECTION("Looking up dependent events through keys") {
+        for (auto i = 0U; i < n; ++i) {
+            events.at(i).i = i;
+            events.at(i).rate = 1 + i % 7;
+        }
+        // events depend on one another if they are in the same group of three
+        auto shouldEval = [](const Event &event) { return event.i % 5 != 0; };
+        auto depending = [](const Event &e1, const Event &e2) { return e1.i / 3 == e2.i / 3; };
+        auto keys = [](const Event &event, const auto &key) { key(static_cast<std::size_t>(event.i / 3)); };
+
+        std::vector<int> evaluatedPerGroup (n / 3 + 1, 0);
+        std::size_t nPerformed = 0;
+        auto eval = [&](const Event &event) {
+            ++evaluatedPerGroup.at(event.i / 3);
+        };
+        auto postPerform = [&](const Event &event, std::size_t nDeactivated) {
+            ++nPerformed;
+            // the deactivated events are at the end and no remaining event depends on the evaluated one
+            for (auto it = events.begin(); it != events.end() - nDeactivated; ++it) {
+                REQUIRE(!depending(*it, event));
+            }
+        };
+        algo::performEvents(events, shouldEval, depending, eval, postPerform, algo::detail::DrawUniform{}, keys);
+
+        // each group contains an event that is not discarded, so exactly one event per group is evaluated
+        REQUIRE(nPerformed == evaluatedPerGroup.size());
+        for (const auto count : evaluatedPerGroup) {
+            REQUIRE(count == 1);
+        }
+    }
+}
+
+TEST_CASE("Counter-based random numbers", "[random]") {
+    using philox = model::rnd::Philox4x32;
+    SECTION("Philox4x32-10 known answers") {
+        REQUIRE(philox::apply({0, 0, 0, 0}, {0, 0})
+                == philox::counter_type{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+        REQUIRE(philox::apply({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff})
+                == philox::counter_type{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+        REQUIRE(philox::apply({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0})
+                == philox::counter_type{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+    }
+    SECTION("Streams are determined by their key") {
+        model::rnd::CounterBasedRandom a(42, 7, 3, 1);
+        model::rnd::CounterBasedRandom b(42, 7, 3, 1);
+        model::rnd::CounterBasedRandom otherStep(42, 7, 4, 1);
+        for (int i = 0; i < 10; ++i) {
+            const auto x = a.normal<scalar>();
+            REQUIRE(x == b.normal<scalar>());
+            REQUIRE(x != otherStep.normal<scalar>());
+        }
+    }
+    SECTION("Moments") {
+        const std::size_t n = 100000;
+        scalar mean = 0, meanSquared = 0, uniformMean = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            model::rnd::CounterBasedRandom random(13, i, 0, 0);
+            const auto x = random.normal<scalar>();
+            mean += x / n;
+            meanSquared += x * x / n;
+            const auto u = random.uniform_real<scalar>();
+            REQUIRE(u > 0);
+            REQUIRE(u < 1);
+            uniformMean += u / n;
+        }
+        REQUIRE(mean == Approx(0.).margin(.02));
+        REQUIRE(meanSquared == Approx(1.).margin(.02));
+        REQUIRE(uniformMean == Approx(.5).margin(.01));
+    }
+}
+
+TEST_CASE("Blocks of normally distributed numbers", "[random]") {
+    std::vector<scalar> block(100000);
+    model::rnd::fillNormal<scalar>(block.begin(), block.end(), 1., 2.);
+    scalar mean = 0, meanSquared = 0;
+    for (const auto x : block) {
+        mean += x / block.size();
+        meanSquared += (x - 1.) * (x - 1.) / block.size();
+    }
+    REQUIRE(mean == Approx(1.).margin(.04));
+    REQUIRE(meanSquared == Approx(4.).margin(.08));
 }
@@ -340,6 +340,25 @@ TEST_CASE("Test context.", "[context]") {
             const auto &o2flat = context.reactions().order2Flat();
             REQUIRE(o1flat.size() + o2flat.size() == 5);
         }
+
+        SECTION("Dense table of second order reactions") {
+            context.reactions().add("fus: A +(1) B -> C", 1.);
+            context.reactions().add("enz: B +(1) A -> A + A", 1.);
+            context.reactions().add("fus2: A +(1) A -> C", 1.);
+            const auto &table = context.reactions().order2Table();
+            auto a = context.particleTypes().idOf("A");
+            auto b = context.particleTypes().idOf("B");
+            auto c = context.particleTypes().idOf("C");
+            for (const auto &[t1, t2] : {std::make_tuple(a, b), std::make_tuple(b, a), std::make_tuple(a, a)}) {
+                const auto range = table(t1, t2);
+                const auto &reactions = context.reactions().order2ByType(t1, t2);
+                REQUIRE(range.size() == reactions.size());
+                CHECK(std::equal(range.begin(), range.end(), reactions.begin()));
+            }
+            CHECK(table(a, b).size() == 2);
+            CHECK(table(c, c).empty());
+            CHECK(table(b, b).empty());
+        }
     }
 
     SECTION("Potentials") {
@@ -365,6 +384,29 @@ TEST_CASE("Test context.", "[context]") {
             CHECK(vector[0] == noop.get());
             CHECK(vector[1] == noop2.get());
         }
+        {
+            const auto &table = context.potentials().potentialsOrder2Table();
+            auto a = context.particleTypes()("a");
+            auto b = context.particleTypes()("b");
+            for (const auto &[t1, t2] : {std::make_tuple(a, b), std::make_tuple(b, a)}) {
+                const auto range = table(t1, t2);
+                const auto &vector = context.potentials().potentialsOf(t1, t2);
+                REQUIRE(range.size() == 3);
+                CHECK(std::equal(range.begin(), range.end(), vector.begin()));
+            }
+            CHECK(table(a, a).empty());
+            CHECK(table(b, b).empty());
+            CHECK(table(a, 42).empty());
+
+            const auto &byClass = context.potentials().potentialsOrder2ByClass();
+            REQUIRE(byClass.screenedElectrostatics(b, a).size() == 1);
+            CHECK(byClass.screenedElectrostatics(b, a)[0] == table(a, b)[2]);
+            REQUIRE(byClass.other(a, b).size() == 2);
+            CHECK(byClass.other(a, b)[0] == noop.get());
+            CHECK(byClass.harmonicRepulsion(a, b).empty());
+            CHECK(byClass.lennardJones(a, b).empty());
+            CHECK(byClass.weakInteractionPiecewiseHarmonic(a, b).empty());
+        }
     }
 
     SECTION("Copyability") {
@@ -491,5 +533,33 @@ TEST_CASE("Test context.", "[context]") {
                 REQUIRE(cfg.mpi.haloThickness == Approx(1.0));
             }
         }
+        WHEN("load balancing is configured") {
+            std::string valid = R"({"MPI":{"dx":4.9,"dy":5.9,"dz":6.9,"haloThickness":1.0,"loadBalanceStride":20}})";
+            THEN("the stride is set") {
+                ctx.setKernelConfiguration(valid);
+                REQUIRE(ctx.kernelConfiguration().mpi.loadBalanceStride == 20);
+            }
+        }
+        WHEN("load balancing is not configured") {
+            std::string valid = R"({"MPI":{"dx":4.9,"dy":5.9,"dz":6.9,"haloThickness":1.0}})";
+            THEN("balancing is disabled") {
+                ctx.setKernelConfiguration(valid);
+                REQUIRE(ctx.kernelConfiguration().mpi.loadBalanceStride == 0);
+            }
+        }
+        WHEN("threads per rank are configured") {
+            std::string valid = R"({"MPI":{"dx":4.9,"dy":5.9,"dz":6.9,"haloThickness":1.0,"threadConfig":{"n_threads":2}}})";
+            THEN("the thread config is set") {
+                ctx.setKernelConfiguration(valid);
+                REQUIRE(ctx.kernelConfiguration().mpi.threadConfig.getNThreads() == 2);
+            }
+        }
+        WHEN("distributed output is configured") {
+            std::string valid = R"({"MPI":{"dx":4.9,"dy":5.9,"dz":6.9,"haloThickness":1.0,"distributedOutput":true}})";
+            THEN("the output is distributed") {
+                ctx.setKernelConfiguration(valid);
+                REQUIRE(ctx.kernelConfiguration().mpi.distributedOutput);
+            }
+        }
     }
 }
@@ -44,6 +44,9 @@
  * @date 27.06.16
  */
 
+#include <filesystem>
+#include <fstream>
+
 #include <catch2/catch.hpp>
 
 #include <readdy/plugin/KernelProvider.h>
@@ -505,3 +508,141 @@ TEMPLATE_TEST_CASE("Test potentials", "[potentials]", SingleCPU, CPU) {
         }
     }
 }
+
+TEST_CASE("Tabulated pair potentials", "[potentials]") {
+    using namespace readdy;
+    namespace pot = readdy::model::potentials;
+    namespace rnd = readdy::model::rnd;
+
+    // energy and dV/d(r^2) along the x axis
+    auto evaluate = [](const pot::PotentialOrder2 &potential, scalar r) {
+        Vec3 x_ij{r, 0, 0};
+        Vec3 force;
+        potential.calculateForce(force, x_ij);
+        return std::make_tuple(potential.calculateEnergy(x_ij), force[0] / (2 * r));
+    };
+    auto withinTolerance = [](scalar approximation, scalar exact, scalar tolerance) {
+        return std::abs(approximation - exact) <= tolerance * std::max(static_cast<scalar>(1), std::abs(exact));
+    };
+
+    SECTION("Approximation of analytic potentials") {
+        const scalar tolerance = 1e-4;
+        std::vector<std::tuple<std::shared_ptr<pot::PotentialOrder2>, scalar>> potentials{
+                {std::make_shared<pot::LennardJones>(0, 0, 12, 6, 2.5, true, 1., 1.), .8},
+                {std::make_shared<pot::ScreenedElectrostatics>(0, 0, -1., 1., 1., 1., 6, 4.), .5},
+                {std::make_shared<pot::HarmonicRepulsion>(0, 0, 10., 1.5), .1},
+        };
+        for (const auto &[analytic, minDistance] : potentials) {
+            pot::Tabulated tabulated(*analytic, tolerance, minDistance);
+            INFO(tabulated.describe());
+            REQUIRE(tabulated.getCutoffRadiusSquared() == analytic->getCutoffRadiusSquared());
+            REQUIRE(tabulated.particleType1() == analytic->particleType1());
+            const auto cutoff = std::sqrt(analytic->getCutoffRadiusSquared());
+            for (int i = 0; i < 1000; ++i) {
+                const auto r = minDistance + rnd::uniform_real() * (cutoff - minDistance);
+                const auto [energy, derivative] = evaluate(*analytic, r);
+                const auto [approxEnergy, approxDerivative] = evaluate(tabulated, r);
+                REQUIRE(withinTolerance(approxEnergy, energy, 10 * tolerance));
+                REQUIRE(withinTolerance(approxDerivative, derivative, 10 * tolerance));
+            }
+            // beyond the cutoff the tabulated potential vanishes
+            const auto [energy, derivative] = evaluate(tabulated, cutoff + .1);
+            REQUIRE(energy == 0);
+            REQUIRE(derivative == 0);
+        }
+    }
+    SECTION("Interpolation of values") {
+        std::vector<scalar> distances, energies;
+        for (int i = 0; i <= 100; ++i) {
+            const auto r = 1 + static_cast<scalar>(i) / 50;
+            distances.push_back(r);
+            energies.push_back((r - 3) * (r - 3));
+        }
+        pot::Tabulated tabulated(0, 0, distances, energies, 1e-6);
+        REQUIRE(tabulated.getCutoffRadiusSquared() == Approx(9));
+        for (auto r : {1.1, 1.5, 2., 2.5, 2.9}) {
+            const auto [energy, derivative] = evaluate(tabulated, r);
+            REQUIRE(energy == Approx((r - 3) * (r - 3)).margin(1e-4));
+            // dV/d(r^2) = dV/dr / (2r)
+            REQUIRE(derivative == Approx((r - 3) / r).margin(1e-3));
+        }
+        REQUIRE_THROWS_AS(pot::Tabulated(0, 0, {1., 2.}, {1., 1.}, 1e-6), std::invalid_argument);
+        REQUIRE_THROWS_AS(pot::Tabulated(0, 0, {1., 3., 2.}, {1., 1., 1.}, 1e-6), std::invalid_argument);
+        REQUIRE_THROWS_AS(pot::Tabulated(0, 0, {0., 1., 2.}, {1., 1., 1.}, 1e-6), std::invalid_argument);
+    }
+    SECTION("Registry") {
+        model::Context context;
+        context.particleTypes().add("A", 1.);
+        context.particleTypes().add("B", 1.);
+        auto &potentials = context.potentials();
+        potentials.addLennardJones("A", "A", 12, 6, 2.5, true, 1., 1.);
+        potentials.addHarmonicRepulsion("A", "B", 10., 1.5);
+
+        const auto filename = (std::filesystem::temp_directory_path() / "readdy_test_tabulated.txt").string();
+        {
+            std::ofstream file(filename);
+            file << "# distance energy\n\n";
+            for (int i = 0; i <= 20; ++i) {
+                const auto r = 1 + static_cast<scalar>(i) / 10;
+                file << r << " " << (r - 3) * (r - 3) << "  # comment\n";
+            }
+        }
+        potentials.addTabulatedFromFile("B", "B", filename, 1e-6);
+        std::filesystem::remove(filename);
+        REQUIRE(potentials.potentialsOf("B", "B").size() == 1);
+        REQUIRE(potentials.potentialsOf("B", "B").front()->getCutoffRadiusSquared() == Approx(9));
+        REQUIRE_THROWS_AS(potentials.addTabulatedFromFile("B", "B", filename, 1e-6), std::invalid_argument);
+
+        const auto typeA = context.particleTypes().idOf("A");
+        const auto typeB = context.particleTypes().idOf("B");
+        const auto lj = evaluate(*potentials.potentialsOf("A", "A").front(), 1.2);
+        potentials.tabulate(1e-6, .8);
+        const auto &byClass = potentials.potentialsOrder2ByClass();
+        REQUIRE(byClass.tabulated(typeA, typeA).size() == 1);
+        REQUIRE(byClass.tabulated(typeA, typeB).size() == 1);
+        REQUIRE(byClass.tabulated(typeB, typeA).size() == 1);
+        REQUIRE(byClass.tabulated(typeB, typeB).size() == 1);
+        REQUIRE(byClass.lennardJones(typeA, typeA).empty());
+        REQUIRE(byClass.harmonicRepulsion(typeA, typeB).empty());
+        for (const auto &[type, others] : std::vector{std::make_tuple(typeA, potentials.potentialsOrder2(typeA)),
+                                                      std::make_tuple(typeB, potentials.potentialsOrder2(typeB))}) {
+            for (const auto &[otherType, pots] : others) {
+                for (const auto *p : pots) {
+                    REQUIRE(p->type() == "Tabulated");
+                }
+            }
+        }
+        const auto tabulatedLJ = evaluate(*potentials.potentialsOf("A", "A").front(), 1.2);
+        REQUIRE(withinTolerance(std::get<0>(tabulatedLJ), std::get<0>(lj), 1e-5));
+        REQUIRE(withinTolerance(std::get<1>(tabulatedLJ), std::get<1>(lj), 1e-5));
+    }
+}
+
+TEST_CASE("Combined force and energy evaluation of pair potentials", "[potentials]") {
+    using namespace readdy;
+    namespace pot = readdy::model::potentials;
+    namespace rnd = readdy::model::rnd;
+
+    // the built-in potentials evaluate force and energy together, this has to agree with the separate evaluation
+    auto check = [](const auto &potential, scalar minDistance) {
+        INFO(potential.describe());
+        const auto cutoff = std::sqrt(potential.getCutoffRadiusSquared());
+        for (int i = 0; i < 1000; ++i) {
+            const auto r = minDistance + rnd::uniform_real() * (cutoff - minDistance);
+            const auto direction = rnd::normal3<scalar>();
+            const auto x_ij = (r / direction.norm()) * direction;
+            Vec3 force, combinedForce;
+            scalar combinedEnergy = 0;
+            potential.calculateForce(force, x_ij);
+            potential.calculateForceAndEnergy(combinedForce, combinedEnergy, x_ij);
+            REQUIRE(combinedEnergy == Approx(potential.calculateEnergy(x_ij)).margin(1e-10));
+            REQUIRE(readdy::testing::vec3eq(combinedForce, force, 1e-8));
+        }
+    };
+    check(pot::HarmonicRepulsion(0, 0, 10., 1.5), 0.);
+    check(pot::WeakInteractionPiecewiseHarmonic(0, 0, 10., {1., 2., 3.}), 0.);
+    check(pot::LennardJones(0, 0, 12, 6, 2.5, true, 1., 1.), .8);
+    check(pot::LennardJones(0, 0, 9, 3, 2.5, false, 1., 1.), .8);
+    check(pot::ScreenedElectrostatics(0, 0, -1., 1., 1., 1., 6, 4.), .5);
+    check(pot::Tabulated(pot::LennardJones(0, 0, 12, 6, 2.5, true, 1., 1.), 1e-4, .8), .8);
+}
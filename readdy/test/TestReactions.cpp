@@ -68,10 +68,6 @@ TEMPLATE_TEST_CASE("Test reaction handlers", "[reactions]", SingleCPU, CPU) {
     auto &ctx = kernel->context();
     for (const auto &handler : REACTION_HANDLERS) {
         SECTION(handler) {
-            if (kernel->name() == "CPU" && std::string(handler) == "DetailedBalance") {
-                INFO("Skipping tests for the combination (CPU, DetailedBalance)");
-                continue;
-            }
             SECTION("Constant number of particles") {
                 // scenario: two particle types A and B, which can form a complex AB which after a time is going
                 // to dissolve back into A and B. Therefore,
@@ -42,6 +42,8 @@
  * @todo check force calculation through periodic boundary
  */
 
+#include <set>
+
 #include <catch2/catch.hpp>
 
 #include <readdy/testing/Utils.h>
@@ -211,4 +213,39 @@ TEMPLATE_TEST_CASE("Test state model", "[state-model]", SingleCPU, CPU) {
             readdy::testing::vec3eq(force, readdy::Vec3(0, 0, 0));
         }
     }
+
+    SECTION("Remove particles by id") {
+        m::Context &ctx = kernel->context();
+        auto &stateModel = kernel->stateModel();
+        ctx.particleTypes().add("A", 1.0);
+        ctx.boxSize() = {{4., 4., 4.}};
+        auto typeIdA = ctx.particleTypes().idOf("A");
+
+        std::vector<m::Particle> particles;
+        for (int i = 0; i < 100; ++i) {
+            particles.emplace_back(-1.9 + .038 * i, 0, 0, typeIdA);
+        }
+        stateModel.addParticles(particles);
+        std::set<readdy::ParticleId> expected;
+        for (std::size_t i = 0; i < particles.size(); ++i) {
+            if (i % 2 == 0) {
+                stateModel.removeParticle(particles[i]);
+            } else {
+                expected.insert(particles[i].id());
+            }
+        }
+        // refill some of the blanks and remove again
+        std::vector<m::Particle> moreParticles {m::Particle(0, 1, 0, typeIdA), m::Particle(0, -1, 0, typeIdA)};
+        stateModel.addParticles(moreParticles);
+        stateModel.removeParticle(moreParticles[0]);
+        stateModel.removeParticle(particles[1]);
+        expected.erase(particles[1].id());
+        expected.insert(moreParticles[1].id());
+
+        std::set<readdy::ParticleId> actual;
+        for (const auto &p : stateModel.getParticles()) {
+            actual.insert(p.id());
+        }
+        REQUIRE(actual == expected);
+    }
 }
@@ -124,6 +124,13 @@ TEMPLATE_TEST_CASE("Test topologies.", "[topologies]", SingleCPU, CPU) {
         readdy::Vec3 f2{-40., 0, 0};
         REQUIRE(collectedForces.at(1) == f2);
         REQUIRE(kernel->stateModel().energy() == 40);
+
+        // the evaluation action is created once and then reused
+        const auto &bondedPotential = top->getBondedPotentials().front();
+        const auto *action = bondedPotential->forceAndEnergyAction(kernel->getTopologyActionFactory());
+        calculateForces->perform();
+        REQUIRE(bondedPotential->forceAndEnergyAction(kernel->getTopologyActionFactory()) == action);
+        REQUIRE(kernel->stateModel().energy() == 40);
     }
 
     SECTION("Angle potential") {
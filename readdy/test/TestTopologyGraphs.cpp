@@ -273,6 +273,50 @@ TEST_CASE("Test topology graphs") {
         REQUIRE(it != gt.graph().vertices().end());
         auto v2 = std::next(gt.graph().vertices().begin());
         REQUIRE(gt.containsEdge(it.persistent_index(), v2.persistent_index()));
+        REQUIRE(gt.vertexIndexForParticle(13) == it.persistent_index());
+        REQUIRE(gt.vertexIteratorForParticle(14) == gt.graph().vertices().end_persistent());
+    }
+
+
+    SECTION("Splitting after edge removal") {
+        using namespace readdy;
+        model::Context context;
+        kernel::scpu::SCPUKernel kernel;
+        kernel.context() = context;
+        model::top::Graph graph;
+        std::vector<model::top::Graph::PersistentVertexIndex> ixs;
+        for (std::size_t i = 0; i < 10; ++i) {
+            ixs.push_back(graph.addVertex({{i}}));
+            if (i > 0) {
+                graph.addEdge(ixs[i - 1], ixs[i]);
+            }
+        }
+        graph.addEdge(ixs.front(), ixs.back());
+        model::top::GraphTopology gt{0, std::move(graph), context, &kernel.stateModel()};
+        REQUIRE(gt.isConnected());
+
+        // cutting the ring once keeps it connected
+        gt.removeEdge(ixs[0], ixs[9]);
+        REQUIRE(gt.isConnected());
+
+        // cutting the chain twice yields three components, the largest keeps its vertices in place
+        gt.removeEdge(ixs[1], ixs[2]);
+        gt.removeEdge(ixs[6], ixs[7]);
+        REQUIRE_FALSE(gt.isConnected());
+        auto components = gt.connectedComponents();
+        REQUIRE(components.size() == 3);
+        std::vector<std::size_t> sizes;
+        for (auto &component : components) {
+            REQUIRE(component.isConnected());
+            sizes.push_back(component.graph().nVertices());
+        }
+        REQUIRE(sizes == std::vector<std::size_t>{5, 2, 3});
+        auto particles = components[0].particleIndices();
+        std::sort(particles.begin(), particles.end());
+        REQUIRE(particles == std::vector<std::size_t>{2, 3, 4, 5, 6});
+        REQUIRE(components[0].vertexIndexForParticle(4) == ixs[4]);
+        REQUIRE_THROWS(components[0].vertexIndexForParticle(0));
+        REQUIRE(components[1].vertexIteratorForParticle(0)->data().particleIndex == 0);
     }
 
 }
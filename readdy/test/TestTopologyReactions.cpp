@@ -43,6 +43,9 @@
  * @copyright BSD-3
  */
 
+#include <atomic>
+#include <thread>
+
 #include <catch2/catch.hpp>
 
 #include <readdy/model/topologies/GraphTopology.h>
@@ -244,6 +247,30 @@ TEMPLATE_TEST_CASE("Test topology reactions.", "[topologies]", SingleCPU, CPU) {
         REQUIRE(top2.fetchParticles().at(1) == particles.at(2));
     }
 
+    SECTION("Separate the middle vertex of a chain") {
+        kernel->context().topologyRegistry().addType("TA");
+        auto topology = setUpSmallTopology(kernel.get(), kernel->context().topologyRegistry().idOf("TA"));
+
+        {
+            auto reactionFunction = [&](model::top::GraphTopology &top) {
+                model::top::reactions::Recipe recipe(top);
+                recipe.separateVertex((++top.graph().vertices().begin()).persistent_index());
+                return recipe;
+            };
+            model::top::reactions::StructuralTopologyReaction reaction{"r", reactionFunction, 5};
+            reaction.create_child_topologies_after_reaction();
+            kernel->context().topologyRegistry().addStructuralReaction("TA", reaction);
+        }
+        const auto &reactions = kernel->context().topologyRegistry().structuralReactionsOf("TA");
+        topology->updateReactionRates(reactions);
+        auto result = reactions.back().execute(*topology, kernel.get());
+        REQUIRE(result.size() == 3);
+        for (const auto &top : result) {
+            REQUIRE(top.nParticles() == 1);
+            REQUIRE(top.graph().vertices().begin()->neighbors().empty());
+        }
+    }
+
     SECTION("Chain split up") {
         std::size_t n_chain_elements = 50;
         auto &toptypes = ctx.topologyRegistry();
@@ -431,6 +458,7 @@ TEMPLATE_TEST_CASE("Test topology reactions.", "[topologies]", SingleCPU, CPU) {
             ctx.topologyRegistry().addType("T2");
 
             ctx.topologyRegistry().configureBondPotential("Y", "Z", {0., .1});
+            std::atomic<bool> rateFunctionOnOtherThread{false};
             SECTION("Scalar Constant Rate") {
                 ctx.topologyRegistry().addSpatialReaction("connect: T(X1) + T(X2) -> T2(Y--Z)", 1e10, 1.);
             }
@@ -439,6 +467,20 @@ TEMPLATE_TEST_CASE("Test topology reactions.", "[topologies]", SingleCPU, CPU) {
                                                           std::move(constant_rate_function),
                                                           1.);
             }
+            SECTION("Rate function is called on the thread running the simulation") {
+                // rate functions implemented in python need the GIL, which the simulating thread may hold
+                ctx.kernelConfiguration().cpu.threadConfig.nThreads = 4;
+                const auto simulatingThread = std::this_thread::get_id();
+                ctx.topologyRegistry().addSpatialReaction(
+                        "connect: T(X1) + T(X2) -> T2(Y--Z)",
+                        [&rateFunctionOnOtherThread, simulatingThread](const readdy::model::top::GraphTopology &,
+                                                                       const readdy::model::top::GraphTopology &) {
+                            if (std::this_thread::get_id() != simulatingThread) {
+                                rateFunctionOnOtherThread = true;
+                            }
+                            return static_cast<readdy::scalar>(1e10);
+                        }, 1.);
+            }
 
             Simulation sim(std::move(kernel), ctx);
 
@@ -462,6 +504,7 @@ TEMPLATE_TEST_CASE("Test topology reactions.", "[topologies]", SingleCPU, CPU) {
             topologies = sim.currentTopologies();
 
             REQUIRE(topologies.size() == 1);
+            REQUIRE_FALSE(rateFunctionOnOtherThread);
             auto top = topologies.at(0);
             REQUIRE(top->type() == sim.context().topologyRegistry().idOf("T2"));
             REQUIRE(top->nParticles() == 2);
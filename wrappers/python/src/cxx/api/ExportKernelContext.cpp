@@ -124,6 +124,17 @@ void exportKernelContext(py::module &module) {
                      return self.addScreenedElectrostatics(type1, type2, electrostaticStrength, inverseScreeningDepth,
                                                            repulsionStrength, repulsionDistance, exponent, cutoff);
                  })
+            .def("add_tabulated",
+                 [](PotentialRegistry &self, const std::string &type1, const std::string &type2,
+                    const std::vector<scalar> &distances, const std::vector<scalar> &energies, scalar tolerance) {
+                     return self.addTabulated(type1, type2, distances, energies, tolerance);
+                 })
+            .def("add_tabulated_from_file",
+                 [](PotentialRegistry &self, const std::string &type1, const std::string &type2,
+                    const std::string &filename, scalar tolerance) {
+                     return self.addTabulatedFromFile(type1, type2, filename, tolerance);
+                 })
+            .def("tabulate", &PotentialRegistry::tabulate, "tolerance"_a, "min_distance"_a)
             .def("add_sphere",
                  [](PotentialRegistry &self, const std::string &particleType, scalar forceConstant, const Vec3 &origin,
                     scalar radius, bool inclusion) {
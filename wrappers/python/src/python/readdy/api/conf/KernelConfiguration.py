@@ -48,6 +48,13 @@ class CPUKernelConfiguration(object):
     def __init__(self):
         self._n_threads = -1
         self._cll_radius = 1
+        self._skin = 0.
+        self._half_shell = False
+        self._reorder_interval = 0
+        self._space_filling_curve = "hilbert"
+        self._flat_bonded_interactions = False
+        self._seed = None
+        self._parallel_gillespie = False
 
     @property
     def n_threads(self):
@@ -67,14 +74,119 @@ class CPUKernelConfiguration(object):
             raise ValueError("Only strictly positive cell linked list radii permitted!")
         self._cll_radius = value
 
+    @property
+    def neighbor_list_skin(self):
+        """
+        Verlet skin of the neighbor list. If positive, per-particle neighbor lists are kept and only rebuilt
+        once a particle moved farther than half the skin.
+        """
+        return self._skin
+
+    @neighbor_list_skin.setter
+    def neighbor_list_skin(self, value):
+        if value < 0:
+            raise ValueError("Only non-negative neighbor list skins permitted!")
+        self._skin = float(value)
+
+    @property
+    def half_shell(self):
+        """
+        Whether pair potentials are evaluated only once per particle pair, applying equal and opposite forces.
+        """
+        return self._half_shell
+
+    @half_shell.setter
+    def half_shell(self, value):
+        self._half_shell = bool(value)
+
+    @property
+    def reorder_interval(self):
+        """
+        Number of neighbor list updates after which the particle data is sorted along a space-filling curve, so that
+        particles which are close in space are also close in memory. Zero disables the reordering.
+        """
+        return self._reorder_interval
+
+    @reorder_interval.setter
+    def reorder_interval(self, value):
+        if value < 0:
+            raise ValueError("Only non-negative reorder intervals permitted!")
+        self._reorder_interval = int(value)
+
+    @property
+    def space_filling_curve(self):
+        """
+        The space-filling curve along which the particle data is sorted, one of "hilbert" and "morton".
+        """
+        return self._space_filling_curve
+
+    @space_filling_curve.setter
+    def space_filling_curve(self, value):
+        if value not in ("hilbert", "morton"):
+            raise ValueError("The space-filling curve must be one of \"hilbert\" and \"morton\"!")
+        self._space_filling_curve = value
+
+    @property
+    def flat_bonded_interactions(self):
+        """
+        Whether the bonds, angles and dihedrals of all topologies are packed into flat arrays that are split evenly
+        among the threads, which balances the work when topologies differ a lot in size.
+        """
+        return self._flat_bonded_interactions
+
+    @flat_bonded_interactions.setter
+    def flat_bonded_interactions(self, value):
+        self._flat_bonded_interactions = bool(value)
+
+    @property
+    def seed(self):
+        """
+        Seed of the counter-based random numbers used by the integrator and the reactions. If set, trajectories are
+        reproducible regardless of the number of threads, if None, randomly seeded generators are used.
+        """
+        return self._seed
+
+    @seed.setter
+    def seed(self, value):
+        if value is not None and value < 0:
+            raise ValueError("Only non-negative seeds permitted!")
+        self._seed = None if value is None else int(value)
+
+    @property
+    def parallel_gillespie(self):
+        """
+        Whether the Gillespie reaction handler processes the events of one slab of the box per thread concurrently.
+        Events between particles in different slabs are handled afterwards and always lose conflicts with events
+        inside the slabs, which biases against reactions of pairs across the slab faces. The option is ignored for
+        seeded runs.
+        """
+        return self._parallel_gillespie
+
+    @parallel_gillespie.setter
+    def parallel_gillespie(self, value):
+        self._parallel_gillespie = bool(value)
+
     def to_json(self):
         import json
         return json.dumps({"CPU": {
             "neighbor_list": {
                 "cll_radius": self.cell_linked_list_radius,
+                "skin": self.neighbor_list_skin,
+                "half_shell": self.half_shell,
             },
             "thread_config": {
                 "n_threads": self.n_threads,
+            },
+            "data_layout": {
+                "reorder_interval": self.reorder_interval,
+                "space_filling_curve": self.space_filling_curve,
+                "flat_bonded_interactions": self.flat_bonded_interactions,
+            },
+            "random": {
+                "seed": -1 if self.seed is None else self.seed,
+            },
+            "reactions": {
+                "parallel_gillespie": self.parallel_gillespie,
             }
         }
         })
@@ -147,6 +147,47 @@ class PotentialRegistry(object):
                                                    inverse_screening_depth, repulsion_strength, repulsion_distance,
                                                    exponent, cutoff)
 
+    def add_tabulated(self, particle_type1, particle_type2, distances, energies, tolerance=1e-6):
+        """
+        Adds a pair potential that is given by energies at distances. The values are interpolated by a natural cubic
+        spline, the largest distance is the cutoff.
+
+        :param particle_type1: first particle type
+        :param particle_type2: second particle type
+        :param distances: strictly increasing, positive distances [length]
+        :param energies: the energies at the distances [energy]
+        :param tolerance: accuracy of the tabulation with respect to the interpolant, default=1e-6
+        """
+        distances = [self._units.convert(d, self._units.length_unit) for d in distances]
+        energies = [self._units.convert(e, self._units.energy_unit) for e in energies]
+        self._registry.add_tabulated(particle_type1, particle_type2, distances, energies, tolerance)
+
+    def add_tabulated_from_file(self, particle_type1, particle_type2, filename, tolerance=1e-6):
+        """
+        Adds a tabulated pair potential, see `add_tabulated`, whose values are read from a text file with two
+        whitespace separated columns, distance and energy, in the internal units of the simulation. Empty lines and
+        everything after a '#' are ignored.
+
+        :param particle_type1: first particle type
+        :param particle_type2: second particle type
+        :param filename: path to the file
+        :param tolerance: accuracy of the tabulation with respect to the interpolant, default=1e-6
+        """
+        self._registry.add_tabulated_from_file(particle_type1, particle_type2, filename, tolerance)
+
+    def tabulate(self, min_distance, tolerance=1e-6):
+        """
+        Replaces all pair potentials registered so far by tabulated cubic spline approximations over the squared
+        distance, which avoids square roots and transcendental functions in the force evaluation. Below
+        `min_distance` the values at `min_distance` are used.
+
+        :param min_distance: the smallest tabulated distance [length]
+        :param tolerance: accuracy of the tabulation, absolute for values smaller than one and relative otherwise,
+                          default=1e-6
+        """
+        min_distance = self._units.convert(min_distance, self._units.length_unit)
+        self._registry.tabulate(tolerance, min_distance)
+
     def add_sphere(self, particle_type, force_constant, origin, radius, inclusion: bool):
         """
         Adds a spherical potential that keeps particles of a certain type restrained to the inside or outside of the
@@ -364,11 +364,16 @@ class Trajectory(object):
         :return: a tuple of lists, where the first element contains a list of simulation times and the second element
                  contains a list of (N, 3)-shaped arrays, where N is the number of particles in that time step
         """
+        group_path = "readdy/observables/particle_positions/" + data_set_name
         with _h5py.File(self._filename, "r") as f:
-            if not "readdy/observables/particle_positions/" + data_set_name in f:
+            if not group_path in f:
                 raise ValueError("The particle positions observable was not recorded in the file or recorded under a "
                                  "different name!")
-            group = f["readdy/observables/particle_positions/" + data_set_name]
+        shards = _io_utils.get_observable_shards(self._filename, group_path)
+        if shards is not None:
+            return _io_utils.read_sharded_observable(shards, group_path, ["data"])
+        with _h5py.File(self._filename, "r") as f:
+            group = f[group_path]
             time = group["time"][:]
             data = group["data"][:]
             return time, data
@@ -384,11 +389,15 @@ class Trajectory(object):
                     * the third element contains  a list of lists of unique ids for each particle
                     * the fourth element contains a list of lists of particle positions
         """
+        group_path = "readdy/observables/particles/" + data_set_name
         with _h5py.File(self._filename, "r") as f:
-            group_path = "readdy/observables/particles/" + data_set_name
             if not group_path in f:
                 raise ValueError("The particles observable was not recorded in the file or recorded under a different "
                                  "name!")
+        shards = _io_utils.get_observable_shards(self._filename, group_path)
+        if shards is not None:
+            return _io_utils.read_sharded_observable(shards, group_path, ["types", "ids", "positions"])
+        with _h5py.File(self._filename, "r") as f:
             group = f[group_path]
             types = group["types"][:]
             ids = group["ids"][:]
@@ -515,6 +524,10 @@ class Trajectory(object):
             if not group_path in f:
                 raise ValueError("The forces observable was not recorded in the file or recorded under a "
                                  "different name!")
+        shards = _io_utils.get_observable_shards(self._filename, group_path)
+        if shards is not None:
+            return _io_utils.read_sharded_observable(shards, group_path, ["data"])
+        with _h5py.File(self._filename, "r") as f:
             time = f[group_path]["time"][:]
             forces = f[group_path]["data"][:]
             return time, forces
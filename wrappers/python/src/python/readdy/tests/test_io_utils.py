@@ -125,5 +125,31 @@ class TestIOUtils(ReaDDyTestCase):
         self.assertTrue(correct_educts)
         self.assertEqual(fusion["product_types"][0], p_types["A"]["type_id"])
 
+    def test_sharded_observable(self):
+        import h5py
+        import json
+        group_path = "readdy/observables/forces"
+        fname = os.path.join(self.dir, "test_sharded.h5")
+        with h5py.File(fname, "w") as f:
+            f.create_group(group_path).create_dataset("shards", data=json.dumps(["test_sharded.rank1.h5",
+                                                                                 "test_sharded.rank2.h5"]))
+        shard_values = {1: [[1., 2.], [3.]], 2: [[4.], [5., 6.]]}
+        for rank, frames in shard_values.items():
+            with h5py.File(os.path.join(self.dir, "test_sharded.rank{}.h5".format(rank)), "w") as f:
+                group = f.create_group(group_path)
+                group.create_dataset("time", data=np.array([0, 10]))
+                data = group.create_dataset("data", (len(frames),), dtype=h5py.special_dtype(vlen=np.float64))
+                for t, frame in enumerate(frames):
+                    data[t] = np.array(frame)
+
+        shards = ioutils.get_observable_shards(fname, group_path)
+        self.assertEqual([os.path.basename(s) for s in shards], ["test_sharded.rank1.h5", "test_sharded.rank2.h5"])
+        self.assertIsNone(ioutils.get_observable_shards(self.fname, group_path))
+
+        time, data = ioutils.read_sharded_observable(shards, group_path, ["data"])
+        np.testing.assert_equal(time, [0, 10])
+        np.testing.assert_equal(data[0], [1., 2., 4.])
+        np.testing.assert_equal(data[1], [3., 5., 6.])
+
 if __name__ == '__main__':
     unittest.main()
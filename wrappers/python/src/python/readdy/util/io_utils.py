@@ -167,3 +167,51 @@ def get_structural_topology_reactions(filename, dset_path="readdy/config/structu
             for r in structural_reactions:
                 result[r["id"]] = r["name"]
     return result
+
+
+def get_observable_shards(filename, group_path):
+    """
+    Paths of the shard files that hold the data of an observable, which was written in the distributed output mode
+    of the MPI kernel, i.e. each worker wrote the particles it was responsible for into its own file.
+
+    :param filename: the readdy h5 file
+    :param group_path: path to the group of the observable
+    :return: list of paths to the shard files, None if the observable was written into the file itself
+    """
+    import json
+    import os
+    with h5py.File(filename, "r") as f:
+        if group_path not in f or "shards" not in f[group_path]:
+            return None
+        shards = json.loads(f[group_path]["shards"][()])
+    directory = os.path.dirname(os.path.abspath(filename))
+    return [os.path.join(directory, shard) for shard in shards]
+
+
+def read_sharded_observable(shard_files, group_path, dset_names):
+    """
+    Reassemble the frames of an observable from its shard files, see get_observable_shards. The per-frame data of
+    all shards is concatenated, the order of particles within a frame follows the order of the shards.
+
+    :param shard_files: paths to the shard files
+    :param group_path: path to the group of the observable, which is the same within each shard
+    :param dset_names: names of the per-frame data sets in that group
+    :return: tuple of the time and, for each data set name, an array with the concatenated data of each frame
+    """
+    time = None
+    shard_data = []
+    for shard_file in shard_files:
+        with h5py.File(shard_file, "r") as f:
+            group = f[group_path]
+            if time is None:
+                time = group["time"][:]
+            shard_data.append([group[name][:] for name in dset_names])
+    if time is None:
+        raise ValueError("The observable has no shards!")
+    result = []
+    for i in range(len(dset_names)):
+        frames = np.empty(len(time), dtype=object)
+        for t in range(len(time)):
+            frames[t] = np.concatenate([data[i][t] for data in shard_data])
+        result.append(frames)
+    return (time, *result)